@@ -9,24 +9,170 @@
  ******************************************************************************/
 
 #include "CJsonObject.hpp" 
+#include <algorithm>
+#include <cstring>
 
 namespace neb
 {
 
+struct CJsonLazyDoc
+{
+    std::string strJson;
+    std::vector<uint32> vecOpen;      // offsets of every '{' and '[' in document order
+    std::vector<uint32> vecClose;     // offset of the matching '}' or ']'
+};
+
+static size_t LazySkipSpace(const char* szJson, size_t uiPos)
+{
+    while (szJson[uiPos] && (unsigned char)szJson[uiPos] <= 32)
+    {
+        ++uiPos;
+    }
+    return(uiPos);
+}
+
+// offset just past the closing quote of the string starting at uiPos, or npos if it is not terminated
+static size_t LazySkipString(const std::string& strJson, size_t uiPos)
+{
+    const char* szJson = strJson.c_str();
+    size_t uiSize = strJson.size();
+    for (size_t i = uiPos + 1; i < uiSize; ++i)
+    {
+        const char* pQuote = (const char*)memchr(szJson + i, '"', uiSize - i);
+        if (pQuote == NULL)
+        {
+            break;
+        }
+        size_t uiSlashes = 0;
+        for (const char* p = pQuote - 1; p > szJson + uiPos && *p == '\\'; --p)
+        {
+            ++uiSlashes;
+        }
+        i = pQuote - szJson;
+        if ((uiSlashes & 1) == 0)
+        {
+            return(i + 1);
+        }
+    }
+    return(std::string::npos);
+}
+
+static size_t LazySkipValue(const CJsonLazyDoc* pDoc, size_t uiPos)
+{
+    const char* szJson = pDoc->strJson.c_str();
+    if (szJson[uiPos] == '{' || szJson[uiPos] == '[')
+    {
+        std::vector<uint32>::const_iterator iter = std::lower_bound(pDoc->vecOpen.begin(), pDoc->vecOpen.end(), (uint32)uiPos);
+        return(pDoc->vecClose[iter - pDoc->vecOpen.begin()] + 1);
+    }
+    if (szJson[uiPos] == '"')
+    {
+        size_t uiEnd = LazySkipString(pDoc->strJson, uiPos);
+        return(uiEnd == std::string::npos ? pDoc->strJson.size() : uiEnd);
+    }
+    while (szJson[uiPos] && !strchr(",}] \t\r\n", szJson[uiPos]))
+    {
+        ++uiPos;
+    }
+    return(uiPos);
+}
+
+// one pass over the text pairing every bracket with its partner, so unread subtrees can be skipped in O(log n)
+static bool LazyIndex(CJsonLazyDoc* pDoc)
+{
+    const char* szJson = pDoc->strJson.c_str();
+    size_t uiSize = pDoc->strJson.size();
+    std::vector<size_t> vecStack;
+    if (uiSize > 0xFFFFFFFF)
+    {
+        return(false);
+    }
+    for (size_t i = 0; i < uiSize; ++i)
+    {
+        switch (szJson[i])
+        {
+        case '"':
+            i = LazySkipString(pDoc->strJson, i);
+            if (i == std::string::npos)
+            {
+                return(false);
+            }
+            --i;
+            break;
+        case '{':
+        case '[':
+            vecStack.push_back(pDoc->vecOpen.size());
+            pDoc->vecOpen.push_back((uint32)i);
+            pDoc->vecClose.push_back(0);
+            break;
+        case '}':
+        case ']':
+            if (vecStack.empty() || szJson[pDoc->vecOpen[vecStack.back()]] != (szJson[i] == '}' ? '{' : '['))
+            {
+                return(false);
+            }
+            pDoc->vecClose[vecStack.back()] = (uint32)i;
+            vecStack.pop_back();
+            break;
+        default:
+            break;
+        }
+    }
+    return(vecStack.empty());
+}
+
+static bool LazyKeyEqual(const std::string& strJson, size_t uiBegin, size_t uiEnd, const std::string& strKey, bool bCaseSensitive)
+{
+    const char* szKey = strJson.c_str() + uiBegin + 1;
+    size_t uiLength = uiEnd - uiBegin - 2;
+    std::string strUnescaped;
+    if (memchr(szKey, '\\', uiLength) != NULL)
+    {
+        cJSON* pJsonKey = cJSON_Parse(strJson.substr(uiBegin, uiEnd - uiBegin).c_str());
+        if (pJsonKey == NULL)
+        {
+            return(false);
+        }
+        strUnescaped = pJsonKey->valuestring;
+        cJSON_Delete(pJsonKey);
+        szKey = strUnescaped.c_str();
+        uiLength = strUnescaped.size();
+    }
+    if (uiLength != strKey.size())
+    {
+        return(false);
+    }
+    if (bCaseSensitive)
+    {
+        return(memcmp(szKey, strKey.c_str(), uiLength) == 0);
+    }
+    for (size_t i = 0; i < uiLength; ++i)
+    {
+        if (tolower((unsigned char)szKey[i]) != tolower((unsigned char)strKey[i]))
+        {
+            return(false);
+        }
+    }
+    return(true);
+}
+
 CJsonObject::CJsonObject()
-    : m_pJsonData(NULL), m_pExternJsonDataRef(NULL), m_pKeyTravers(NULL)
+    : m_pJsonData(NULL), m_pExternJsonDataRef(NULL), m_pKeyTravers(NULL), m_bCaseSensitive(false),
+      m_pLazyDoc(NULL), m_pLazyRoot(NULL), m_uiLazyBegin(0), m_bLazyPartial(false)
 {
     // m_pJsonData = cJSON_CreateObject();  
 }
 
 CJsonObject::CJsonObject(const std::string& strJson)
-    : m_pJsonData(NULL), m_pExternJsonDataRef(NULL), m_pKeyTravers(NULL)
+    : m_pJsonData(NULL), m_pExternJsonDataRef(NULL), m_pKeyTravers(NULL), m_bCaseSensitive(false),
+      m_pLazyDoc(NULL), m_pLazyRoot(NULL), m_uiLazyBegin(0), m_bLazyPartial(false)
 {
     Parse(strJson);
 }
 
 CJsonObject::CJsonObject(const CJsonObject* pJsonObject)
-    : m_pJsonData(NULL), m_pExternJsonDataRef(NULL), m_pKeyTravers(NULL)
+    : m_pJsonData(NULL), m_pExternJsonDataRef(NULL), m_pKeyTravers(NULL), m_bCaseSensitive(false),
+      m_pLazyDoc(NULL), m_pLazyRoot(NULL), m_uiLazyBegin(0), m_bLazyPartial(false)
 {
     if (pJsonObject)
     {
@@ -35,11 +181,19 @@ CJsonObject::CJsonObject(const CJsonObject* pJsonObject)
 }
 
 CJsonObject::CJsonObject(const CJsonObject& oJsonObject)
-    : m_pJsonData(NULL), m_pExternJsonDataRef(NULL), m_pKeyTravers(NULL)
+    : m_pJsonData(NULL), m_pExternJsonDataRef(NULL), m_pKeyTravers(NULL), m_bCaseSensitive(oJsonObject.m_bCaseSensitive),
+      m_pLazyDoc(NULL), m_pLazyRoot(NULL), m_uiLazyBegin(0), m_bLazyPartial(false)
 {
     Parse(oJsonObject.ToString());
 }
 
+CJsonObject::CJsonObject(CJsonObject&& oJsonObject)
+    : m_pJsonData(NULL), m_pExternJsonDataRef(NULL), m_pKeyTravers(NULL), m_bCaseSensitive(oJsonObject.m_bCaseSensitive),
+      m_pLazyDoc(NULL), m_pLazyRoot(NULL), m_uiLazyBegin(0), m_bLazyPartial(false)
+{
+    Move(oJsonObject);
+}
+
 CJsonObject::~CJsonObject()
 {
     Clear();
@@ -47,10 +201,21 @@ CJsonObject::~CJsonObject()
 
 CJsonObject& CJsonObject::operator=(const CJsonObject& oJsonObject)
 {
+    m_bCaseSensitive = oJsonObject.m_bCaseSensitive;
     Parse(oJsonObject.ToString().c_str());
     return(*this);
 }
 
+CJsonObject& CJsonObject::operator=(CJsonObject&& oJsonObject)
+{
+    if (&oJsonObject != this)
+    {
+        m_bCaseSensitive = oJsonObject.m_bCaseSensitive;
+        Move(oJsonObject);
+    }
+    return(*this);
+}
+
 bool CJsonObject::operator==(const CJsonObject& oJsonObject) const
 {
     return(this->ToString() == oJsonObject.ToString());
@@ -58,6 +223,7 @@ bool CJsonObject::operator==(const CJsonObject& oJsonObject) const
 
 bool CJsonObject::AddEmptySubObject(const std::string& strKey)
 {
+    LazyMaterialize();
     cJSON* pFocusData = NULL;
     if (m_pJsonData != NULL)
     {
@@ -84,7 +250,7 @@ bool CJsonObject::AddEmptySubObject(const std::string& strKey)
         m_strErrMsg = "not a json object! json array?";
         return(false);
     }
-    if (cJSON_GetObjectItem(pFocusData, strKey.c_str()) != NULL)
+    if (GetObjectItem(pFocusData, strKey.c_str()) != NULL)
     {
         m_strErrMsg = "key exists!";
         return(false);
@@ -102,6 +268,7 @@ bool CJsonObject::AddEmptySubObject(const std::string& strKey)
 
 bool CJsonObject::AddEmptySubArray(const std::string& strKey)
 {
+    LazyMaterialize();
     cJSON* pFocusData = NULL;
     if (m_pJsonData != NULL)
     {
@@ -128,7 +295,7 @@ bool CJsonObject::AddEmptySubArray(const std::string& strKey)
         m_strErrMsg = "not a json object! json array?";
         return(false);
     }
-    if (cJSON_GetObjectItem(pFocusData, strKey.c_str()) != NULL)
+    if (GetObjectItem(pFocusData, strKey.c_str()) != NULL)
     {
         m_strErrMsg = "key exists!";
         return(false);
@@ -146,6 +313,7 @@ bool CJsonObject::AddEmptySubArray(const std::string& strKey)
 
 bool CJsonObject::GetKey(std::string& strKey)
 {
+    LazyLoad();
     if (IsArray())
     {
         return(false);
@@ -186,6 +354,7 @@ bool CJsonObject::GetKey(std::string& strKey)
 
 void CJsonObject::ResetTraversing()
 {
+    LazyLoad();
     if (m_pJsonData != NULL)
     {
         m_pKeyTravers = m_pJsonData;
@@ -200,21 +369,29 @@ CJsonObject& CJsonObject::operator[](const std::string& strKey)
 {
     std::map<std::string, CJsonObject*>::iterator iter;
     iter = m_mapJsonObjectRef.find(strKey);
-    if (iter == m_mapJsonObjectRef.end())
+    if (iter == m_mapJsonObjectRef.end() && m_bLazyPartial)
+    {
+        size_t uiBegin = 0;
+        size_t uiEnd = 0;
+        CJsonObject* pJsonObject = LazyFind(strKey, uiBegin, uiEnd) ? LazyChild(uiBegin, uiEnd) : new CJsonObject();
+        m_mapJsonObjectRef.insert(std::pair<std::string, CJsonObject*>(strKey, pJsonObject));
+        return(*pJsonObject);
+    }
+    else if (iter == m_mapJsonObjectRef.end())
     {
         cJSON* pJsonStruct = NULL;
         if (m_pJsonData != NULL)
         {
             if (m_pJsonData->type == cJSON_Object)
             {
-                pJsonStruct = cJSON_GetObjectItem(m_pJsonData, strKey.c_str());
+                pJsonStruct = GetObjectItem(m_pJsonData, strKey.c_str());
             }
         }
         else if (m_pExternJsonDataRef != NULL)
         {
             if (m_pExternJsonDataRef->type == cJSON_Object)
             {
-                pJsonStruct = cJSON_GetObjectItem(m_pExternJsonDataRef, strKey.c_str());
+                pJsonStruct = GetObjectItem(m_pExternJsonDataRef, strKey.c_str());
             }
         }
         if (pJsonStruct == NULL)
@@ -226,6 +403,8 @@ CJsonObject& CJsonObject::operator[](const std::string& strKey)
         else
         {
             CJsonObject* pJsonObject = new CJsonObject(pJsonStruct);
+            pJsonObject->m_bCaseSensitive = m_bCaseSensitive;
+            pJsonObject->m_pLazyRoot = m_pLazyRoot;
             m_mapJsonObjectRef.insert(std::pair<std::string, CJsonObject*>(strKey, pJsonObject));
             return(*pJsonObject);
         }
@@ -240,7 +419,15 @@ CJsonObject& CJsonObject::operator[](unsigned int uiWhich)
 {
     std::map<unsigned int, CJsonObject*>::iterator iter;
     iter = m_mapJsonArrayRef.find(uiWhich);
-    if (iter == m_mapJsonArrayRef.end())
+    if (iter == m_mapJsonArrayRef.end() && m_bLazyPartial)
+    {
+        size_t uiBegin = 0;
+        size_t uiEnd = 0;
+        CJsonObject* pJsonObject = LazyFind(uiWhich, uiBegin, uiEnd) ? LazyChild(uiBegin, uiEnd) : new CJsonObject();
+        m_mapJsonArrayRef.insert(std::pair<unsigned int, CJsonObject*>(uiWhich, pJsonObject));
+        return(*pJsonObject);
+    }
+    else if (iter == m_mapJsonArrayRef.end())
     {
         cJSON* pJsonStruct = NULL;
         if (m_pJsonData != NULL)
@@ -266,6 +453,8 @@ CJsonObject& CJsonObject::operator[](unsigned int uiWhich)
         else
         {
             CJsonObject* pJsonObject = new CJsonObject(pJsonStruct);
+            pJsonObject->m_bCaseSensitive = m_bCaseSensitive;
+            pJsonObject->m_pLazyRoot = m_pLazyRoot;
             m_mapJsonArrayRef.insert(std::pair<unsigned int, CJsonObject*>(uiWhich, pJsonObject));
             return(*pJsonObject);
         }
@@ -278,19 +467,20 @@ CJsonObject& CJsonObject::operator[](unsigned int uiWhich)
 
 std::string CJsonObject::operator()(const std::string& strKey) const
 {
+    LazyTouch(strKey);
     cJSON* pJsonStruct = NULL;
     if (m_pJsonData != NULL)
     {
         if (m_pJsonData->type == cJSON_Object)
         {
-            pJsonStruct = cJSON_GetObjectItem(m_pJsonData, strKey.c_str());
+            pJsonStruct = GetObjectItem(m_pJsonData, strKey.c_str());
         }
     }
     else if (m_pExternJsonDataRef != NULL)
     {
         if(m_pExternJsonDataRef->type == cJSON_Object)
         {
-            pJsonStruct = cJSON_GetObjectItem(m_pExternJsonDataRef, strKey.c_str());
+            pJsonStruct = GetObjectItem(m_pExternJsonDataRef, strKey.c_str());
         }
     }
     if (pJsonStruct == NULL)
@@ -353,6 +543,7 @@ std::string CJsonObject::operator()(const std::string& strKey) const
 
 std::string CJsonObject::operator()(unsigned int uiWhich) const
 {
+    LazyLoad();
     cJSON* pJsonStruct = NULL;
     if (m_pJsonData != NULL)
     {
@@ -439,6 +630,34 @@ bool CJsonObject::Parse(const std::string& strJson)
     return(true);
 }
 
+bool CJsonObject::ParseLazy(const std::string& strJson)
+{
+    Clear();
+    size_t uiBegin = LazySkipSpace(strJson.c_str(), 0);
+    if (uiBegin >= strJson.size() || (strJson[uiBegin] != '{' && strJson[uiBegin] != '['))
+    {
+        return(Parse(strJson));
+    }
+    CJsonLazyDoc* pDoc = new CJsonLazyDoc();
+    pDoc->strJson = strJson;
+    if (!LazyIndex(pDoc))
+    {
+        delete pDoc;
+        m_strErrMsg = std::string("prase json string error: unbalanced brackets or quotes");
+        return(false);
+    }
+    m_pLazyDoc = pDoc;
+    m_pLazyRoot = this;
+    m_uiLazyBegin = uiBegin;
+    m_bLazyPartial = true;
+    if (strJson[uiBegin] == '{')
+    {
+        m_pJsonData = cJSON_CreateObject();
+    }
+    m_pKeyTravers = m_pJsonData;
+    return(true);
+}
+
 void CJsonObject::Clear()
 {
     m_pExternJsonDataRef = NULL;
@@ -468,11 +687,23 @@ void CJsonObject::Clear()
         }
     }
     m_mapJsonObjectRef.clear();
+    if (m_pLazyDoc != NULL)
+    {
+        delete m_pLazyDoc;
+        m_pLazyDoc = NULL;
+    }
+    m_pLazyRoot = NULL;
+    m_uiLazyBegin = 0;
+    m_bLazyPartial = false;
 }
 
 bool CJsonObject::IsEmpty() const
 {
-    if (m_pJsonData != NULL)
+    if (m_bLazyPartial)
+    {
+        return(false);
+    }
+    else if (m_pJsonData != NULL)
     {
         return(false);
     }
@@ -486,7 +717,11 @@ bool CJsonObject::IsEmpty() const
 bool CJsonObject::IsArray() const
 {
     cJSON* pFocusData = NULL;
-    if (m_pJsonData != NULL)
+    if (m_bLazyPartial)
+    {
+        return(m_pLazyRoot->m_pLazyDoc->strJson[m_uiLazyBegin] == '[');
+    }
+    else if (m_pJsonData != NULL)
     {
         pFocusData = m_pJsonData;
     }
@@ -512,60 +747,150 @@ bool CJsonObject::IsArray() const
 
 std::string CJsonObject::ToString() const
 {
-    char* pJsonString = NULL;
-    std::string strJsonData = "";
+    std::string strJsonData;
+    ToString(strJsonData);
+    return(strJsonData);
+}
+
+std::string CJsonObject::ToFormattedString() const
+{
+    std::string strJsonData;
+    ToFormattedString(strJsonData);
+    return(strJsonData);
+}
+
+bool CJsonObject::ToString(std::string& strJson) const
+{
+    cJSON_PrintBuffer oPrintBuffer = {};
+    oPrintBuffer.grow_fn = &CJsonObject::GrowString;
+    oPrintBuffer.user = &strJson;
+    strJson.resize(strJson.capacity());
+    oPrintBuffer.buffer = strJson.empty() ? NULL : &strJson[0];
+    oPrintBuffer.size = strJson.size();
+    bool bResult = Print(&oPrintBuffer, false);
+    strJson.resize(oPrintBuffer.length);
+    return(bResult);
+}
+
+bool CJsonObject::ToFormattedString(std::string& strJson) const
+{
+    cJSON_PrintBuffer oPrintBuffer = {};
+    oPrintBuffer.grow_fn = &CJsonObject::GrowString;
+    oPrintBuffer.user = &strJson;
+    strJson.resize(strJson.capacity());
+    oPrintBuffer.buffer = strJson.empty() ? NULL : &strJson[0];
+    oPrintBuffer.size = strJson.size();
+    bool bResult = Print(&oPrintBuffer, true);
+    strJson.resize(oPrintBuffer.length);
+    return(bResult);
+}
+
+bool CJsonObject::Print(cJSON_PrintBuffer* pBuffer, bool bFormatted) const
+{
+    LazyLoad();
+    cJSON* pJsonStruct = NULL;
     if (m_pJsonData != NULL)
     {
-        pJsonString = cJSON_PrintUnformatted(m_pJsonData);
+        pJsonStruct = m_pJsonData;
     }
     else if (m_pExternJsonDataRef != NULL)
     {
-        pJsonString = cJSON_PrintUnformatted(m_pExternJsonDataRef);
+        pJsonStruct = m_pExternJsonDataRef;
     }
-    if (pJsonString != NULL)
+    if (pJsonStruct == NULL)
     {
-        strJsonData = pJsonString;
-        free(pJsonString);
+        return(false);
     }
-    return(strJsonData);
+    return(cJSON_PrintBuffered(pJsonStruct, bFormatted ? 1 : 0, pBuffer) != 0);
 }
 
-std::string CJsonObject::ToFormattedString() const
+bool CJsonObject::ToMsgPack(std::string& strMsgPack) const
 {
-    char* pJsonString = NULL;
-    std::string strJsonData = "";
-    if (m_pJsonData != NULL)
+    cJSON_PrintBuffer oPrintBuffer = {};
+    oPrintBuffer.grow_fn = &CJsonObject::GrowString;
+    oPrintBuffer.user = &strMsgPack;
+    strMsgPack.resize(strMsgPack.capacity());
+    oPrintBuffer.buffer = strMsgPack.empty() ? NULL : &strMsgPack[0];
+    oPrintBuffer.size = strMsgPack.size();
+    bool bResult = PrintMsgPack(&oPrintBuffer);
+    strMsgPack.resize(oPrintBuffer.length);
+    return(bResult);
+}
+
+bool CJsonObject::FromMsgPack(const void* pData, size_t uiSize)
+{
+    Clear();
+    size_t uiConsumed = 0;
+    m_pJsonData = cJSON_ParseMsgPack(pData, uiSize, &uiConsumed);
+    m_pKeyTravers = m_pJsonData;
+    if (m_pJsonData == NULL)
+    {
+        m_strErrMsg = std::string("decode msgpack error");
+        return(false);
+    }
+    if (uiConsumed != uiSize)
     {
-        pJsonString = cJSON_Print(m_pJsonData);
+        Clear();
+        m_strErrMsg = std::string("decode msgpack error: trailing bytes");
+        return(false);
     }
-    else if (m_pExternJsonDataRef != NULL)
+    return(true);
+}
+
+bool CJsonObject::PrintMsgPack(cJSON_PrintBuffer* pBuffer) const
+{
+    LazyLoad();
+    cJSON* pJsonStruct = (m_pJsonData != NULL) ? m_pJsonData : m_pExternJsonDataRef;
+    if (pJsonStruct == NULL)
+    {
+        return(false);
+    }
+    return(cJSON_PrintMsgPack(pJsonStruct, pBuffer) != 0);
+}
+
+int CJsonObject::GrowString(cJSON_PrintBuffer* pBuffer, size_t uiSize)
+{
+    std::string* pOutput = (std::string*)pBuffer->user;
+    if (uiSize < pOutput->size() * 2)
     {
-        pJsonString = cJSON_Print(m_pExternJsonDataRef);
+        uiSize = pOutput->size() * 2;
     }
-    if (pJsonString != NULL)
+    try
     {
-        strJsonData = pJsonString;
-        free(pJsonString);
+        pOutput->resize(uiSize);
     }
-    return(strJsonData);
+    catch (...)
+    {
+        return(0);
+    }
+    pBuffer->buffer = &(*pOutput)[0];
+    pBuffer->size = pOutput->size();
+    return(1);
 }
 
 
 bool CJsonObject::Get(const std::string& strKey, CJsonObject& oJsonObject) const
 {
+    size_t uiBegin = 0;
+    size_t uiEnd = 0;
+    if (m_bLazyPartial && (m_pJsonData == NULL || GetObjectItem(m_pJsonData, strKey.c_str()) == NULL))
+    {
+        return(LazyFind(strKey, uiBegin, uiEnd)
+            && oJsonObject.Parse(m_pLazyRoot->m_pLazyDoc->strJson.substr(uiBegin, uiEnd - uiBegin)));
+    }
     cJSON* pJsonStruct = NULL;
     if (m_pJsonData != NULL)
     {
         if (m_pJsonData->type == cJSON_Object)
         {
-            pJsonStruct = cJSON_GetObjectItem(m_pJsonData, strKey.c_str());
+            pJsonStruct = GetObjectItem(m_pJsonData, strKey.c_str());
         }
     }
     else if (m_pExternJsonDataRef != NULL)
     {
         if(m_pExternJsonDataRef->type == cJSON_Object)
         {
-            pJsonStruct = cJSON_GetObjectItem(m_pExternJsonDataRef, strKey.c_str());
+            pJsonStruct = GetObjectItem(m_pExternJsonDataRef, strKey.c_str());
         }
     }
     if (pJsonStruct == NULL)
@@ -587,19 +912,20 @@ bool CJsonObject::Get(const std::string& strKey, CJsonObject& oJsonObject) const
 
 bool CJsonObject::Get(const std::string& strKey, std::string& strValue) const
 {
+    LazyTouch(strKey);
     cJSON* pJsonStruct = NULL;
     if (m_pJsonData != NULL)
     {
         if (m_pJsonData->type == cJSON_Object)
         {
-            pJsonStruct = cJSON_GetObjectItem(m_pJsonData, strKey.c_str());
+            pJsonStruct = GetObjectItem(m_pJsonData, strKey.c_str());
         }
     }
     else if (m_pExternJsonDataRef != NULL)
     {
         if(m_pExternJsonDataRef->type == cJSON_Object)
         {
-            pJsonStruct = cJSON_GetObjectItem(m_pExternJsonDataRef, strKey.c_str());
+            pJsonStruct = GetObjectItem(m_pExternJsonDataRef, strKey.c_str());
         }
     }
     if (pJsonStruct == NULL)
@@ -616,19 +942,20 @@ bool CJsonObject::Get(const std::string& strKey, std::string& strValue) const
 
 bool CJsonObject::Get(const std::string& strKey, int32& iValue) const
 {
+    LazyTouch(strKey);
     cJSON* pJsonStruct = NULL;
     if (m_pJsonData != NULL)
     {
         if (m_pJsonData->type == cJSON_Object)
         {
-            pJsonStruct = cJSON_GetObjectItem(m_pJsonData, strKey.c_str());
+            pJsonStruct = GetObjectItem(m_pJsonData, strKey.c_str());
         }
     }
     else if (m_pExternJsonDataRef != NULL)
     {
         if(m_pExternJsonDataRef->type == cJSON_Object)
         {
-            pJsonStruct = cJSON_GetObjectItem(m_pExternJsonDataRef, strKey.c_str());
+            pJsonStruct = GetObjectItem(m_pExternJsonDataRef, strKey.c_str());
         }
     }
     if (pJsonStruct == NULL)
@@ -650,19 +977,20 @@ bool CJsonObject::Get(const std::string& strKey, int32& iValue) const
 
 bool CJsonObject::Get(const std::string& strKey, uint32& uiValue) const
 {
+    LazyTouch(strKey);
     cJSON* pJsonStruct = NULL;
     if (m_pJsonData != NULL)
     {
         if (m_pJsonData->type == cJSON_Object)
         {
-            pJsonStruct = cJSON_GetObjectItem(m_pJsonData, strKey.c_str());
+            pJsonStruct = GetObjectItem(m_pJsonData, strKey.c_str());
         }
     }
     else if (m_pExternJsonDataRef != NULL)
     {
         if(m_pExternJsonDataRef->type == cJSON_Object)
         {
-            pJsonStruct = cJSON_GetObjectItem(m_pExternJsonDataRef, strKey.c_str());
+            pJsonStruct = GetObjectItem(m_pExternJsonDataRef, strKey.c_str());
         }
     }
     if (pJsonStruct == NULL)
@@ -684,19 +1012,20 @@ bool CJsonObject::Get(const std::string& strKey, uint32& uiValue) const
 
 bool CJsonObject::Get(const std::string& strKey, int64& llValue) const
 {
+    LazyTouch(strKey);
     cJSON* pJsonStruct = NULL;
     if (m_pJsonData != NULL)
     {
         if (m_pJsonData->type == cJSON_Object)
         {
-            pJsonStruct = cJSON_GetObjectItem(m_pJsonData, strKey.c_str());
+            pJsonStruct = GetObjectItem(m_pJsonData, strKey.c_str());
         }
     }
     else if (m_pExternJsonDataRef != NULL)
     {
         if(m_pExternJsonDataRef->type == cJSON_Object)
         {
-            pJsonStruct = cJSON_GetObjectItem(m_pExternJsonDataRef, strKey.c_str());
+            pJsonStruct = GetObjectItem(m_pExternJsonDataRef, strKey.c_str());
         }
     }
     if (pJsonStruct == NULL)
@@ -718,19 +1047,20 @@ bool CJsonObject::Get(const std::string& strKey, int64& llValue) const
 
 bool CJsonObject::Get(const std::string& strKey, uint64& ullValue) const
 {
+    LazyTouch(strKey);
     cJSON* pJsonStruct = NULL;
     if (m_pJsonData != NULL)
     {
         if (m_pJsonData->type == cJSON_Object)
         {
-            pJsonStruct = cJSON_GetObjectItem(m_pJsonData, strKey.c_str());
+            pJsonStruct = GetObjectItem(m_pJsonData, strKey.c_str());
         }
     }
     else if (m_pExternJsonDataRef != NULL)
     {
         if(m_pExternJsonDataRef->type == cJSON_Object)
         {
-            pJsonStruct = cJSON_GetObjectItem(m_pExternJsonDataRef, strKey.c_str());
+            pJsonStruct = GetObjectItem(m_pExternJsonDataRef, strKey.c_str());
         }
     }
     if (pJsonStruct == NULL)
@@ -752,19 +1082,20 @@ bool CJsonObject::Get(const std::string& strKey, uint64& ullValue) const
 
 bool CJsonObject::Get(const std::string& strKey, bool& bValue) const
 {
+    LazyTouch(strKey);
     cJSON* pJsonStruct = NULL;
     if (m_pJsonData != NULL)
     {
         if (m_pJsonData->type == cJSON_Object)
         {
-            pJsonStruct = cJSON_GetObjectItem(m_pJsonData, strKey.c_str());
+            pJsonStruct = GetObjectItem(m_pJsonData, strKey.c_str());
         }
     }
     else if (m_pExternJsonDataRef != NULL)
     {
         if(m_pExternJsonDataRef->type == cJSON_Object)
         {
-            pJsonStruct = cJSON_GetObjectItem(m_pExternJsonDataRef, strKey.c_str());
+            pJsonStruct = GetObjectItem(m_pExternJsonDataRef, strKey.c_str());
         }
     }
     if (pJsonStruct == NULL)
@@ -781,19 +1112,20 @@ bool CJsonObject::Get(const std::string& strKey, bool& bValue) const
 
 bool CJsonObject::Get(const std::string& strKey, float& fValue) const
 {
+    LazyTouch(strKey);
     cJSON* pJsonStruct = NULL;
     if (m_pJsonData != NULL)
     {
         if (m_pJsonData->type == cJSON_Object)
         {
-            pJsonStruct = cJSON_GetObjectItem(m_pJsonData, strKey.c_str());
+            pJsonStruct = GetObjectItem(m_pJsonData, strKey.c_str());
         }
     }
     else if (m_pExternJsonDataRef != NULL)
     {
         if(m_pExternJsonDataRef->type == cJSON_Object)
         {
-            pJsonStruct = cJSON_GetObjectItem(m_pExternJsonDataRef, strKey.c_str());
+            pJsonStruct = GetObjectItem(m_pExternJsonDataRef, strKey.c_str());
         }
     }
     if (pJsonStruct == NULL)
@@ -815,19 +1147,20 @@ bool CJsonObject::Get(const std::string& strKey, float& fValue) const
 
 bool CJsonObject::Get(const std::string& strKey, double& dValue) const
 {
+    LazyTouch(strKey);
     cJSON* pJsonStruct = NULL;
     if (m_pJsonData != NULL)
     {
         if (m_pJsonData->type == cJSON_Object)
         {
-            pJsonStruct = cJSON_GetObjectItem(m_pJsonData, strKey.c_str());
+            pJsonStruct = GetObjectItem(m_pJsonData, strKey.c_str());
         }
     }
     else if (m_pExternJsonDataRef != NULL)
     {
         if(m_pExternJsonDataRef->type == cJSON_Object)
         {
-            pJsonStruct = cJSON_GetObjectItem(m_pExternJsonDataRef, strKey.c_str());
+            pJsonStruct = GetObjectItem(m_pExternJsonDataRef, strKey.c_str());
         }
     }
     if (pJsonStruct == NULL)
@@ -850,6 +1183,7 @@ bool CJsonObject::Get(const std::string& strKey, double& dValue) const
 
 bool CJsonObject::Get(const std::string& strKey, char* strValue, int inSize) const
 {
+    LazyTouch(strKey);
 	if (strValue == nullptr)
 	{
 		return false;
@@ -860,14 +1194,14 @@ bool CJsonObject::Get(const std::string& strKey, char* strValue, int inSize) con
 	{
 		if (m_pJsonData->type == cJSON_Object)
 		{
-			pJsonStruct = cJSON_GetObjectItem(m_pJsonData, strKey.c_str());
+			pJsonStruct = GetObjectItem(m_pJsonData, strKey.c_str());
 		}
 	}
 	else if (m_pExternJsonDataRef != NULL)
 	{
 		if (m_pExternJsonDataRef->type == cJSON_Object)
 		{
-			pJsonStruct = cJSON_GetObjectItem(m_pExternJsonDataRef, strKey.c_str());
+			pJsonStruct = GetObjectItem(m_pExternJsonDataRef, strKey.c_str());
 		}
 	}
 	if (pJsonStruct == NULL)
@@ -886,19 +1220,20 @@ bool CJsonObject::Get(const std::string& strKey, char* strValue, int inSize) con
 
 bool CJsonObject::IsNull(const std::string& strKey) const
 {
+    LazyTouch(strKey);
     cJSON* pJsonStruct = NULL;
     if (m_pJsonData != NULL)
     {
         if (m_pJsonData->type == cJSON_Object)
         {
-            pJsonStruct = cJSON_GetObjectItem(m_pJsonData, strKey.c_str());
+            pJsonStruct = GetObjectItem(m_pJsonData, strKey.c_str());
         }
     }
     else if (m_pExternJsonDataRef != NULL)
     {
         if(m_pExternJsonDataRef->type == cJSON_Object)
         {
-            pJsonStruct = cJSON_GetObjectItem(m_pExternJsonDataRef, strKey.c_str());
+            pJsonStruct = GetObjectItem(m_pExternJsonDataRef, strKey.c_str());
         }
     }
     if (pJsonStruct == NULL)
@@ -914,6 +1249,7 @@ bool CJsonObject::IsNull(const std::string& strKey) const
 
 bool CJsonObject::Add(const std::string& strKey, const CJsonObject& oJsonObject)
 {
+    LazyMaterialize();
     cJSON* pFocusData = NULL;
     if (m_pJsonData != NULL)
     {
@@ -940,7 +1276,7 @@ bool CJsonObject::Add(const std::string& strKey, const CJsonObject& oJsonObject)
         m_strErrMsg = "not a json object! json array?";
         return(false);
     }
-    if (cJSON_GetObjectItem(pFocusData, strKey.c_str()) != NULL)
+    if (GetObjectItem(pFocusData, strKey.c_str()) != NULL)
     {
         m_strErrMsg = "key exists!";
         return(false);
@@ -952,7 +1288,7 @@ bool CJsonObject::Add(const std::string& strKey, const CJsonObject& oJsonObject)
         return(false);
     }
     cJSON_AddItemToObject(pFocusData, strKey.c_str(), pJsonStruct);
-    if (cJSON_GetObjectItem(pFocusData, strKey.c_str()) == NULL)
+    if (GetObjectItem(pFocusData, strKey.c_str()) == NULL)
     {
         return(false);
     }
@@ -972,6 +1308,7 @@ bool CJsonObject::Add(const std::string& strKey, const CJsonObject& oJsonObject)
 
 bool CJsonObject::Add(const std::string& strKey, const std::string& strValue)
 {
+    LazyMaterialize();
     cJSON* pFocusData = NULL;
     if (m_pJsonData != NULL)
     {
@@ -998,7 +1335,7 @@ bool CJsonObject::Add(const std::string& strKey, const std::string& strValue)
         m_strErrMsg = "not a json object! json array?";
         return(false);
     }
-    if (cJSON_GetObjectItem(pFocusData, strKey.c_str()) != NULL)
+    if (GetObjectItem(pFocusData, strKey.c_str()) != NULL)
     {
         m_strErrMsg = "key exists!";
         return(false);
@@ -1009,7 +1346,7 @@ bool CJsonObject::Add(const std::string& strKey, const std::string& strValue)
         return(false);
     }
     cJSON_AddItemToObject(pFocusData, strKey.c_str(), pJsonStruct);
-    if (cJSON_GetObjectItem(pFocusData, strKey.c_str()) == NULL)
+    if (GetObjectItem(pFocusData, strKey.c_str()) == NULL)
     {
         return(false);
     }
@@ -1019,6 +1356,7 @@ bool CJsonObject::Add(const std::string& strKey, const std::string& strValue)
 
 bool CJsonObject::Add(const std::string& strKey, int32 iValue)
 {
+    LazyMaterialize();
     cJSON* pFocusData = NULL;
     if (m_pJsonData != NULL)
     {
@@ -1045,7 +1383,7 @@ bool CJsonObject::Add(const std::string& strKey, int32 iValue)
         m_strErrMsg = "not a json object! json array?";
         return(false);
     }
-    if (cJSON_GetObjectItem(pFocusData, strKey.c_str()) != NULL)
+    if (GetObjectItem(pFocusData, strKey.c_str()) != NULL)
     {
         m_strErrMsg = "key exists!";
         return(false);
@@ -1056,7 +1394,7 @@ bool CJsonObject::Add(const std::string& strKey, int32 iValue)
         return(false);
     }
     cJSON_AddItemToObject(pFocusData, strKey.c_str(), pJsonStruct);
-    if (cJSON_GetObjectItem(pFocusData, strKey.c_str()) == NULL)
+    if (GetObjectItem(pFocusData, strKey.c_str()) == NULL)
     {
         return(false);
     }
@@ -1066,6 +1404,7 @@ bool CJsonObject::Add(const std::string& strKey, int32 iValue)
 
 bool CJsonObject::Add(const std::string& strKey, uint32 uiValue)
 {
+    LazyMaterialize();
     cJSON* pFocusData = NULL;
     if (m_pJsonData != NULL)
     {
@@ -1092,7 +1431,7 @@ bool CJsonObject::Add(const std::string& strKey, uint32 uiValue)
         m_strErrMsg = "not a json object! json array?";
         return(false);
     }
-    if (cJSON_GetObjectItem(pFocusData, strKey.c_str()) != NULL)
+    if (GetObjectItem(pFocusData, strKey.c_str()) != NULL)
     {
         m_strErrMsg = "key exists!";
         return(false);
@@ -1103,7 +1442,7 @@ bool CJsonObject::Add(const std::string& strKey, uint32 uiValue)
         return(false);
     }
     cJSON_AddItemToObject(pFocusData, strKey.c_str(), pJsonStruct);
-    if (cJSON_GetObjectItem(pFocusData, strKey.c_str()) == NULL)
+    if (GetObjectItem(pFocusData, strKey.c_str()) == NULL)
     {
         return(false);
     }
@@ -1113,6 +1452,7 @@ bool CJsonObject::Add(const std::string& strKey, uint32 uiValue)
 
 bool CJsonObject::Add(const std::string& strKey, int64 llValue)
 {
+    LazyMaterialize();
     cJSON* pFocusData = NULL;
     if (m_pJsonData != NULL)
     {
@@ -1139,7 +1479,7 @@ bool CJsonObject::Add(const std::string& strKey, int64 llValue)
         m_strErrMsg = "not a json object! json array?";
         return(false);
     }
-    if (cJSON_GetObjectItem(pFocusData, strKey.c_str()) != NULL)
+    if (GetObjectItem(pFocusData, strKey.c_str()) != NULL)
     {
         m_strErrMsg = "key exists!";
         return(false);
@@ -1150,7 +1490,7 @@ bool CJsonObject::Add(const std::string& strKey, int64 llValue)
         return(false);
     }
     cJSON_AddItemToObject(pFocusData, strKey.c_str(), pJsonStruct);
-    if (cJSON_GetObjectItem(pFocusData, strKey.c_str()) == NULL)
+    if (GetObjectItem(pFocusData, strKey.c_str()) == NULL)
     {
         return(false);
     }
@@ -1160,6 +1500,7 @@ bool CJsonObject::Add(const std::string& strKey, int64 llValue)
 
 bool CJsonObject::Add(const std::string& strKey, uint64 ullValue)
 {
+    LazyMaterialize();
     cJSON* pFocusData = NULL;
     if (m_pJsonData != NULL)
     {
@@ -1186,7 +1527,7 @@ bool CJsonObject::Add(const std::string& strKey, uint64 ullValue)
         m_strErrMsg = "not a json object! json array?";
         return(false);
     }
-    if (cJSON_GetObjectItem(pFocusData, strKey.c_str()) != NULL)
+    if (GetObjectItem(pFocusData, strKey.c_str()) != NULL)
     {
         m_strErrMsg = "key exists!";
         return(false);
@@ -1197,7 +1538,7 @@ bool CJsonObject::Add(const std::string& strKey, uint64 ullValue)
         return(false);
     }
     cJSON_AddItemToObject(pFocusData, strKey.c_str(), pJsonStruct);
-    if (cJSON_GetObjectItem(pFocusData, strKey.c_str()) == NULL)
+    if (GetObjectItem(pFocusData, strKey.c_str()) == NULL)
     {
         return(false);
     }
@@ -1207,6 +1548,7 @@ bool CJsonObject::Add(const std::string& strKey, uint64 ullValue)
 
 bool CJsonObject::Add(const std::string& strKey, bool bValue, bool bValueAgain)
 {
+    LazyMaterialize();
     cJSON* pFocusData = NULL;
     if (m_pJsonData != NULL)
     {
@@ -1233,7 +1575,7 @@ bool CJsonObject::Add(const std::string& strKey, bool bValue, bool bValueAgain)
         m_strErrMsg = "not a json object! json array?";
         return(false);
     }
-    if (cJSON_GetObjectItem(pFocusData, strKey.c_str()) != NULL)
+    if (GetObjectItem(pFocusData, strKey.c_str()) != NULL)
     {
         m_strErrMsg = "key exists!";
         return(false);
@@ -1244,7 +1586,7 @@ bool CJsonObject::Add(const std::string& strKey, bool bValue, bool bValueAgain)
         return(false);
     }
     cJSON_AddItemToObject(pFocusData, strKey.c_str(), pJsonStruct);
-    if (cJSON_GetObjectItem(pFocusData, strKey.c_str()) == NULL)
+    if (GetObjectItem(pFocusData, strKey.c_str()) == NULL)
     {
         return(false);
     }
@@ -1254,6 +1596,7 @@ bool CJsonObject::Add(const std::string& strKey, bool bValue, bool bValueAgain)
 
 bool CJsonObject::Add(const std::string& strKey, float fValue)
 {
+    LazyMaterialize();
     cJSON* pFocusData = NULL;
     if (m_pJsonData != NULL)
     {
@@ -1280,7 +1623,7 @@ bool CJsonObject::Add(const std::string& strKey, float fValue)
         m_strErrMsg = "not a json object! json array?";
         return(false);
     }
-    if (cJSON_GetObjectItem(pFocusData, strKey.c_str()) != NULL)
+    if (GetObjectItem(pFocusData, strKey.c_str()) != NULL)
     {
         m_strErrMsg = "key exists!";
         return(false);
@@ -1291,7 +1634,7 @@ bool CJsonObject::Add(const std::string& strKey, float fValue)
         return(false);
     }
     cJSON_AddItemToObject(pFocusData, strKey.c_str(), pJsonStruct);
-    if (cJSON_GetObjectItem(pFocusData, strKey.c_str()) == NULL)
+    if (GetObjectItem(pFocusData, strKey.c_str()) == NULL)
     {
         return(false);
     }
@@ -1301,6 +1644,7 @@ bool CJsonObject::Add(const std::string& strKey, float fValue)
 
 bool CJsonObject::Add(const std::string& strKey, double dValue)
 {
+    LazyMaterialize();
     cJSON* pFocusData = NULL;
     if (m_pJsonData != NULL)
     {
@@ -1327,7 +1671,7 @@ bool CJsonObject::Add(const std::string& strKey, double dValue)
         m_strErrMsg = "not a json object! json array?";
         return(false);
     }
-    if (cJSON_GetObjectItem(pFocusData, strKey.c_str()) != NULL)
+    if (GetObjectItem(pFocusData, strKey.c_str()) != NULL)
     {
         m_strErrMsg = "key exists!";
         return(false);
@@ -1338,7 +1682,7 @@ bool CJsonObject::Add(const std::string& strKey, double dValue)
         return(false);
     }
     cJSON_AddItemToObject(pFocusData, strKey.c_str(), pJsonStruct);
-    if (cJSON_GetObjectItem(pFocusData, strKey.c_str()) == NULL)
+    if (GetObjectItem(pFocusData, strKey.c_str()) == NULL)
     {
         return(false);
     }
@@ -1348,6 +1692,7 @@ bool CJsonObject::Add(const std::string& strKey, double dValue)
 
 bool CJsonObject::AddNull(const std::string& strKey)
 {
+    LazyMaterialize();
     cJSON* pFocusData = NULL;
     if (m_pJsonData != NULL)
     {
@@ -1374,7 +1719,7 @@ bool CJsonObject::AddNull(const std::string& strKey)
         m_strErrMsg = "not a json object! json array?";
         return(false);
     }
-    if (cJSON_GetObjectItem(pFocusData, strKey.c_str()) != NULL)
+    if (GetObjectItem(pFocusData, strKey.c_str()) != NULL)
     {
         m_strErrMsg = "key exists!";
         return(false);
@@ -1385,7 +1730,7 @@ bool CJsonObject::AddNull(const std::string& strKey)
         return(false);
     }
     cJSON_AddItemToObject(pFocusData, strKey.c_str(), pJsonStruct);
-    if (cJSON_GetObjectItem(pFocusData, strKey.c_str()) == NULL)
+    if (GetObjectItem(pFocusData, strKey.c_str()) == NULL)
     {
         return(false);
     }
@@ -1395,6 +1740,7 @@ bool CJsonObject::AddNull(const std::string& strKey)
 
 bool CJsonObject::Delete(const std::string& strKey)
 {
+    LazyMaterialize();
     cJSON* pFocusData = NULL;
     if (m_pJsonData == NULL)
     {
@@ -1414,7 +1760,7 @@ bool CJsonObject::Delete(const std::string& strKey)
         m_strErrMsg = "not a json object! json array?";
         return(false);
     }
-    cJSON_DeleteItemFromObject(pFocusData, strKey.c_str());
+    DeleteObjectItem(pFocusData, strKey.c_str());
     std::map<std::string, CJsonObject*>::iterator iter = m_mapJsonObjectRef.find(strKey);
     if (iter != m_mapJsonObjectRef.end())
     {
@@ -1431,6 +1777,7 @@ bool CJsonObject::Delete(const std::string& strKey)
 
 bool CJsonObject::Replace(const std::string& strKey, const CJsonObject& oJsonObject)
 {
+    LazyMaterialize();
     cJSON* pFocusData = NULL;
     if (m_pJsonData == NULL)
     {
@@ -1456,8 +1803,8 @@ bool CJsonObject::Replace(const std::string& strKey, const CJsonObject& oJsonObj
         m_strErrMsg = std::string("prase json string error at ") + cJSON_GetErrorPtr();
         return(false);
     }
-    cJSON_ReplaceItemInObject(pFocusData, strKey.c_str(), pJsonStruct);
-    if (cJSON_GetObjectItem(pFocusData, strKey.c_str()) == NULL)
+    ReplaceObjectItem(pFocusData, strKey.c_str(), pJsonStruct);
+    if (GetObjectItem(pFocusData, strKey.c_str()) == NULL)
     {
         return(false);
     }
@@ -1476,6 +1823,7 @@ bool CJsonObject::Replace(const std::string& strKey, const CJsonObject& oJsonObj
 
 bool CJsonObject::Replace(const std::string& strKey, const std::string& strValue)
 {
+    LazyMaterialize();
     cJSON* pFocusData = NULL;
     if (m_pJsonData == NULL)
     {
@@ -1510,8 +1858,8 @@ bool CJsonObject::Replace(const std::string& strKey, const std::string& strValue
         }
         m_mapJsonObjectRef.erase(iter);
     }
-    cJSON_ReplaceItemInObject(pFocusData, strKey.c_str(), pJsonStruct);
-    if (cJSON_GetObjectItem(pFocusData, strKey.c_str()) == NULL)
+    ReplaceObjectItem(pFocusData, strKey.c_str(), pJsonStruct);
+    if (GetObjectItem(pFocusData, strKey.c_str()) == NULL)
     {
         return(false);
     }
@@ -1520,6 +1868,7 @@ bool CJsonObject::Replace(const std::string& strKey, const std::string& strValue
 
 bool CJsonObject::Replace(const std::string& strKey, int32 iValue)
 {
+    LazyMaterialize();
     cJSON* pFocusData = NULL;
     if (m_pJsonData == NULL)
     {
@@ -1554,8 +1903,8 @@ bool CJsonObject::Replace(const std::string& strKey, int32 iValue)
         }
         m_mapJsonObjectRef.erase(iter);
     }
-    cJSON_ReplaceItemInObject(pFocusData, strKey.c_str(), pJsonStruct);
-    if (cJSON_GetObjectItem(pFocusData, strKey.c_str()) == NULL)
+    ReplaceObjectItem(pFocusData, strKey.c_str(), pJsonStruct);
+    if (GetObjectItem(pFocusData, strKey.c_str()) == NULL)
     {
         return(false);
     }
@@ -1564,6 +1913,7 @@ bool CJsonObject::Replace(const std::string& strKey, int32 iValue)
 
 bool CJsonObject::Replace(const std::string& strKey, uint32 uiValue)
 {
+    LazyMaterialize();
     cJSON* pFocusData = NULL;
     if (m_pJsonData == NULL)
     {
@@ -1598,8 +1948,8 @@ bool CJsonObject::Replace(const std::string& strKey, uint32 uiValue)
         }
         m_mapJsonObjectRef.erase(iter);
     }
-    cJSON_ReplaceItemInObject(pFocusData, strKey.c_str(), pJsonStruct);
-    if (cJSON_GetObjectItem(pFocusData, strKey.c_str()) == NULL)
+    ReplaceObjectItem(pFocusData, strKey.c_str(), pJsonStruct);
+    if (GetObjectItem(pFocusData, strKey.c_str()) == NULL)
     {
         return(false);
     }
@@ -1608,6 +1958,7 @@ bool CJsonObject::Replace(const std::string& strKey, uint32 uiValue)
 
 bool CJsonObject::Replace(const std::string& strKey, int64 llValue)
 {
+    LazyMaterialize();
     cJSON* pFocusData = NULL;
     if (m_pJsonData == NULL)
     {
@@ -1642,8 +1993,8 @@ bool CJsonObject::Replace(const std::string& strKey, int64 llValue)
         }
         m_mapJsonObjectRef.erase(iter);
     }
-    cJSON_ReplaceItemInObject(pFocusData, strKey.c_str(), pJsonStruct);
-    if (cJSON_GetObjectItem(pFocusData, strKey.c_str()) == NULL)
+    ReplaceObjectItem(pFocusData, strKey.c_str(), pJsonStruct);
+    if (GetObjectItem(pFocusData, strKey.c_str()) == NULL)
     {
         return(false);
     }
@@ -1652,6 +2003,7 @@ bool CJsonObject::Replace(const std::string& strKey, int64 llValue)
 
 bool CJsonObject::Replace(const std::string& strKey, uint64 ullValue)
 {
+    LazyMaterialize();
     cJSON* pFocusData = NULL;
     if (m_pJsonData == NULL)
     {
@@ -1686,8 +2038,8 @@ bool CJsonObject::Replace(const std::string& strKey, uint64 ullValue)
         }
         m_mapJsonObjectRef.erase(iter);
     }
-    cJSON_ReplaceItemInObject(pFocusData, strKey.c_str(), pJsonStruct);
-    if (cJSON_GetObjectItem(pFocusData, strKey.c_str()) == NULL)
+    ReplaceObjectItem(pFocusData, strKey.c_str(), pJsonStruct);
+    if (GetObjectItem(pFocusData, strKey.c_str()) == NULL)
     {
         return(false);
     }
@@ -1696,6 +2048,7 @@ bool CJsonObject::Replace(const std::string& strKey, uint64 ullValue)
 
 bool CJsonObject::Replace(const std::string& strKey, bool bValue, bool bValueAgain)
 {
+    LazyMaterialize();
     cJSON* pFocusData = NULL;
     if (m_pJsonData == NULL)
     {
@@ -1730,8 +2083,8 @@ bool CJsonObject::Replace(const std::string& strKey, bool bValue, bool bValueAga
         }
         m_mapJsonObjectRef.erase(iter);
     }
-    cJSON_ReplaceItemInObject(pFocusData, strKey.c_str(), pJsonStruct);
-    if (cJSON_GetObjectItem(pFocusData, strKey.c_str()) == NULL)
+    ReplaceObjectItem(pFocusData, strKey.c_str(), pJsonStruct);
+    if (GetObjectItem(pFocusData, strKey.c_str()) == NULL)
     {
         return(false);
     }
@@ -1740,6 +2093,7 @@ bool CJsonObject::Replace(const std::string& strKey, bool bValue, bool bValueAga
 
 bool CJsonObject::Replace(const std::string& strKey, float fValue)
 {
+    LazyMaterialize();
     cJSON* pFocusData = NULL;
     if (m_pJsonData == NULL)
     {
@@ -1774,8 +2128,8 @@ bool CJsonObject::Replace(const std::string& strKey, float fValue)
         }
         m_mapJsonObjectRef.erase(iter);
     }
-    cJSON_ReplaceItemInObject(pFocusData, strKey.c_str(), pJsonStruct);
-    if (cJSON_GetObjectItem(pFocusData, strKey.c_str()) == NULL)
+    ReplaceObjectItem(pFocusData, strKey.c_str(), pJsonStruct);
+    if (GetObjectItem(pFocusData, strKey.c_str()) == NULL)
     {
         return(false);
     }
@@ -1784,6 +2138,7 @@ bool CJsonObject::Replace(const std::string& strKey, float fValue)
 
 bool CJsonObject::Replace(const std::string& strKey, double dValue)
 {
+    LazyMaterialize();
     cJSON* pFocusData = NULL;
     if (m_pJsonData == NULL)
     {
@@ -1818,8 +2173,8 @@ bool CJsonObject::Replace(const std::string& strKey, double dValue)
         }
         m_mapJsonObjectRef.erase(iter);
     }
-    cJSON_ReplaceItemInObject(pFocusData, strKey.c_str(), pJsonStruct);
-    if (cJSON_GetObjectItem(pFocusData, strKey.c_str()) == NULL)
+    ReplaceObjectItem(pFocusData, strKey.c_str(), pJsonStruct);
+    if (GetObjectItem(pFocusData, strKey.c_str()) == NULL)
     {
         return(false);
     }
@@ -1828,6 +2183,7 @@ bool CJsonObject::Replace(const std::string& strKey, double dValue)
 
 bool CJsonObject::ReplaceWithNull(const std::string& strKey)
 {
+    LazyMaterialize();
     cJSON* pFocusData = NULL;
     if (m_pJsonData == NULL)
     {
@@ -1862,8 +2218,8 @@ bool CJsonObject::ReplaceWithNull(const std::string& strKey)
         }
         m_mapJsonObjectRef.erase(iter);
     }
-    cJSON_ReplaceItemInObject(pFocusData, strKey.c_str(), pJsonStruct);
-    if (cJSON_GetObjectItem(pFocusData, strKey.c_str()) == NULL)
+    ReplaceObjectItem(pFocusData, strKey.c_str(), pJsonStruct);
+    if (GetObjectItem(pFocusData, strKey.c_str()) == NULL)
     {
         return(false);
     }
@@ -1872,7 +2228,28 @@ bool CJsonObject::ReplaceWithNull(const std::string& strKey)
 
 int CJsonObject::GetArraySize()
 {
-    if (m_pJsonData != NULL)
+    if (m_bLazyPartial)
+    {
+        const CJsonLazyDoc* pDoc = m_pLazyRoot->m_pLazyDoc;
+        const char* szJson = pDoc->strJson.c_str();
+        if (szJson[m_uiLazyBegin] != '[')
+        {
+            return(0);
+        }
+        int iSize = 0;
+        size_t uiPos = LazySkipSpace(szJson, m_uiLazyBegin + 1);
+        while (szJson[uiPos] && szJson[uiPos] != ']')
+        {
+            ++iSize;
+            uiPos = LazySkipSpace(szJson, LazySkipValue(pDoc, uiPos));
+            if (szJson[uiPos] == ',')
+            {
+                uiPos = LazySkipSpace(szJson, uiPos + 1);
+            }
+        }
+        return(iSize);
+    }
+    else if (m_pJsonData != NULL)
     {
         if (m_pJsonData->type == cJSON_Array)
         {
@@ -1891,6 +2268,7 @@ int CJsonObject::GetArraySize()
 
 bool CJsonObject::Get(int iWhich, CJsonObject& oJsonObject) const
 {
+    LazyLoad();
     cJSON* pJsonStruct = NULL;
     if (m_pJsonData != NULL)
     {
@@ -1925,6 +2303,7 @@ bool CJsonObject::Get(int iWhich, CJsonObject& oJsonObject) const
 
 bool CJsonObject::Get(int iWhich, std::string& strValue) const
 {
+    LazyLoad();
     cJSON* pJsonStruct = NULL;
     if (m_pJsonData != NULL)
     {
@@ -1954,6 +2333,7 @@ bool CJsonObject::Get(int iWhich, std::string& strValue) const
 
 bool CJsonObject::Get(int iWhich, int32& iValue) const
 {
+    LazyLoad();
     cJSON* pJsonStruct = NULL;
     if (m_pJsonData != NULL)
     {
@@ -1988,6 +2368,7 @@ bool CJsonObject::Get(int iWhich, int32& iValue) const
 
 bool CJsonObject::Get(int iWhich, uint32& uiValue) const
 {
+    LazyLoad();
     cJSON* pJsonStruct = NULL;
     if (m_pJsonData != NULL)
     {
@@ -2022,6 +2403,7 @@ bool CJsonObject::Get(int iWhich, uint32& uiValue) const
 
 bool CJsonObject::Get(int iWhich, int64& llValue) const
 {
+    LazyLoad();
     cJSON* pJsonStruct = NULL;
     if (m_pJsonData != NULL)
     {
@@ -2056,6 +2438,7 @@ bool CJsonObject::Get(int iWhich, int64& llValue) const
 
 bool CJsonObject::Get(int iWhich, uint64& ullValue) const
 {
+    LazyLoad();
     cJSON* pJsonStruct = NULL;
     if (m_pJsonData != NULL)
     {
@@ -2090,6 +2473,7 @@ bool CJsonObject::Get(int iWhich, uint64& ullValue) const
 
 bool CJsonObject::Get(int iWhich, bool& bValue) const
 {
+    LazyLoad();
     cJSON* pJsonStruct = NULL;
     if (m_pJsonData != NULL)
     {
@@ -2119,6 +2503,7 @@ bool CJsonObject::Get(int iWhich, bool& bValue) const
 
 bool CJsonObject::Get(int iWhich, float& fValue) const
 {
+    LazyLoad();
     cJSON* pJsonStruct = NULL;
     if (m_pJsonData != NULL)
     {
@@ -2153,6 +2538,7 @@ bool CJsonObject::Get(int iWhich, float& fValue) const
 
 bool CJsonObject::Get(int iWhich, double& dValue) const
 {
+    LazyLoad();
     cJSON* pJsonStruct = NULL;
     if (m_pJsonData != NULL)
     {
@@ -2187,6 +2573,7 @@ bool CJsonObject::Get(int iWhich, double& dValue) const
 
 bool CJsonObject::IsNull(int iWhich) const
 {
+    LazyLoad();
     cJSON* pJsonStruct = NULL;
     if (m_pJsonData != NULL)
     {
@@ -2215,6 +2602,7 @@ bool CJsonObject::IsNull(int iWhich) const
 
 bool CJsonObject::Add(const CJsonObject& oJsonObject)
 {
+    LazyMaterialize();
     cJSON* pFocusData = NULL;
     if (m_pJsonData != NULL)
     {
@@ -2276,6 +2664,7 @@ bool CJsonObject::Add(const CJsonObject& oJsonObject)
 
 bool CJsonObject::Add(const std::string& strValue)
 {
+    LazyMaterialize();
     cJSON* pFocusData = NULL;
     if (m_pJsonData != NULL)
     {
@@ -2318,6 +2707,7 @@ bool CJsonObject::Add(const std::string& strValue)
 
 bool CJsonObject::Add(int32 iValue)
 {
+    LazyMaterialize();
     cJSON* pFocusData = NULL;
     if (m_pJsonData != NULL)
     {
@@ -2360,6 +2750,7 @@ bool CJsonObject::Add(int32 iValue)
 
 bool CJsonObject::Add(uint32 uiValue)
 {
+    LazyMaterialize();
     cJSON* pFocusData = NULL;
     if (m_pJsonData != NULL)
     {
@@ -2402,6 +2793,7 @@ bool CJsonObject::Add(uint32 uiValue)
 
 bool CJsonObject::Add(int64 llValue)
 {
+    LazyMaterialize();
     cJSON* pFocusData = NULL;
     if (m_pJsonData != NULL)
     {
@@ -2444,6 +2836,7 @@ bool CJsonObject::Add(int64 llValue)
 
 bool CJsonObject::Add(uint64 ullValue)
 {
+    LazyMaterialize();
     cJSON* pFocusData = NULL;
     if (m_pJsonData != NULL)
     {
@@ -2486,6 +2879,7 @@ bool CJsonObject::Add(uint64 ullValue)
 
 bool CJsonObject::Add(int iAnywhere, bool bValue)
 {
+    LazyMaterialize();
     cJSON* pFocusData = NULL;
     if (m_pJsonData != NULL)
     {
@@ -2528,6 +2922,7 @@ bool CJsonObject::Add(int iAnywhere, bool bValue)
 
 bool CJsonObject::Add(float fValue)
 {
+    LazyMaterialize();
     cJSON* pFocusData = NULL;
     if (m_pJsonData != NULL)
     {
@@ -2570,6 +2965,7 @@ bool CJsonObject::Add(float fValue)
 
 bool CJsonObject::Add(double dValue)
 {
+    LazyMaterialize();
     cJSON* pFocusData = NULL;
     if (m_pJsonData != NULL)
     {
@@ -2612,6 +3008,7 @@ bool CJsonObject::Add(double dValue)
 
 bool CJsonObject::AddNull()
 {
+    LazyMaterialize();
     cJSON* pFocusData = NULL;
     if (m_pJsonData != NULL)
     {
@@ -2654,6 +3051,7 @@ bool CJsonObject::AddNull()
 
 bool CJsonObject::AddAsFirst(const CJsonObject& oJsonObject)
 {
+    LazyMaterialize();
     cJSON* pFocusData = NULL;
     if (m_pJsonData != NULL)
     {
@@ -2707,6 +3105,7 @@ bool CJsonObject::AddAsFirst(const CJsonObject& oJsonObject)
 
 bool CJsonObject::AddAsFirst(const std::string& strValue)
 {
+    LazyMaterialize();
     cJSON* pFocusData = NULL;
     if (m_pJsonData != NULL)
     {
@@ -2749,6 +3148,7 @@ bool CJsonObject::AddAsFirst(const std::string& strValue)
 
 bool CJsonObject::AddAsFirst(int32 iValue)
 {
+    LazyMaterialize();
     cJSON* pFocusData = NULL;
     if (m_pJsonData != NULL)
     {
@@ -2791,6 +3191,7 @@ bool CJsonObject::AddAsFirst(int32 iValue)
 
 bool CJsonObject::AddAsFirst(uint32 uiValue)
 {
+    LazyMaterialize();
     cJSON* pFocusData = NULL;
     if (m_pJsonData != NULL)
     {
@@ -2833,6 +3234,7 @@ bool CJsonObject::AddAsFirst(uint32 uiValue)
 
 bool CJsonObject::AddAsFirst(int64 llValue)
 {
+    LazyMaterialize();
     cJSON* pFocusData = NULL;
     if (m_pJsonData != NULL)
     {
@@ -2875,6 +3277,7 @@ bool CJsonObject::AddAsFirst(int64 llValue)
 
 bool CJsonObject::AddAsFirst(uint64 ullValue)
 {
+    LazyMaterialize();
     cJSON* pFocusData = NULL;
     if (m_pJsonData != NULL)
     {
@@ -2917,6 +3320,7 @@ bool CJsonObject::AddAsFirst(uint64 ullValue)
 
 bool CJsonObject::AddAsFirst(int iAnywhere, bool bValue)
 {
+    LazyMaterialize();
     cJSON* pFocusData = NULL;
     if (m_pJsonData != NULL)
     {
@@ -2959,6 +3363,7 @@ bool CJsonObject::AddAsFirst(int iAnywhere, bool bValue)
 
 bool CJsonObject::AddAsFirst(float fValue)
 {
+    LazyMaterialize();
     cJSON* pFocusData = NULL;
     if (m_pJsonData != NULL)
     {
@@ -3001,6 +3406,7 @@ bool CJsonObject::AddAsFirst(float fValue)
 
 bool CJsonObject::AddAsFirst(double dValue)
 {
+    LazyMaterialize();
     cJSON* pFocusData = NULL;
     if (m_pJsonData != NULL)
     {
@@ -3043,6 +3449,7 @@ bool CJsonObject::AddAsFirst(double dValue)
 
 bool CJsonObject::AddNullAsFirst()
 {
+    LazyMaterialize();
     cJSON* pFocusData = NULL;
     if (m_pJsonData != NULL)
     {
@@ -3085,6 +3492,7 @@ bool CJsonObject::AddNullAsFirst()
 
 bool CJsonObject::Delete(int iWhich)
 {
+    LazyMaterialize();
     cJSON* pFocusData = NULL;
     if (m_pJsonData == NULL)
     {
@@ -3127,6 +3535,7 @@ bool CJsonObject::Delete(int iWhich)
 
 bool CJsonObject::Replace(int iWhich, const CJsonObject& oJsonObject)
 {
+    LazyMaterialize();
     cJSON* pFocusData = NULL;
     if (m_pJsonData == NULL)
     {
@@ -3172,6 +3581,7 @@ bool CJsonObject::Replace(int iWhich, const CJsonObject& oJsonObject)
 
 bool CJsonObject::Replace(int iWhich, const std::string& strValue)
 {
+    LazyMaterialize();
     cJSON* pFocusData = NULL;
     if (m_pJsonData == NULL)
     {
@@ -3216,6 +3626,7 @@ bool CJsonObject::Replace(int iWhich, const std::string& strValue)
 
 bool CJsonObject::Replace(int iWhich, int32 iValue)
 {
+    LazyMaterialize();
     cJSON* pFocusData = NULL;
     if (m_pJsonData == NULL)
     {
@@ -3260,6 +3671,7 @@ bool CJsonObject::Replace(int iWhich, int32 iValue)
 
 bool CJsonObject::Replace(int iWhich, uint32 uiValue)
 {
+    LazyMaterialize();
     cJSON* pFocusData = NULL;
     if (m_pJsonData == NULL)
     {
@@ -3304,6 +3716,7 @@ bool CJsonObject::Replace(int iWhich, uint32 uiValue)
 
 bool CJsonObject::Replace(int iWhich, int64 llValue)
 {
+    LazyMaterialize();
     cJSON* pFocusData = NULL;
     if (m_pJsonData == NULL)
     {
@@ -3348,6 +3761,7 @@ bool CJsonObject::Replace(int iWhich, int64 llValue)
 
 bool CJsonObject::Replace(int iWhich, uint64 ullValue)
 {
+    LazyMaterialize();
     cJSON* pFocusData = NULL;
     if (m_pJsonData == NULL)
     {
@@ -3392,6 +3806,7 @@ bool CJsonObject::Replace(int iWhich, uint64 ullValue)
 
 bool CJsonObject::Replace(int iWhich, bool bValue, bool bValueAgain)
 {
+    LazyMaterialize();
     cJSON* pFocusData = NULL;
     if (m_pJsonData == NULL)
     {
@@ -3436,6 +3851,7 @@ bool CJsonObject::Replace(int iWhich, bool bValue, bool bValueAgain)
 
 bool CJsonObject::Replace(int iWhich, float fValue)
 {
+    LazyMaterialize();
     cJSON* pFocusData = NULL;
     if (m_pJsonData == NULL)
     {
@@ -3480,6 +3896,7 @@ bool CJsonObject::Replace(int iWhich, float fValue)
 
 bool CJsonObject::Replace(int iWhich, double dValue)
 {
+    LazyMaterialize();
     cJSON* pFocusData = NULL;
     if (m_pJsonData == NULL)
     {
@@ -3524,6 +3941,7 @@ bool CJsonObject::Replace(int iWhich, double dValue)
 
 bool CJsonObject::ReplaceWithNull(int iWhich)
 {
+    LazyMaterialize();
     cJSON* pFocusData = NULL;
     if (m_pJsonData == NULL)
     {
@@ -3566,8 +3984,772 @@ bool CJsonObject::ReplaceWithNull(int iWhich)
     return(true);
 }
 
+void CJsonObject::SetCaseSensitive(bool bCaseSensitive)
+{
+    m_bCaseSensitive = bCaseSensitive;
+}
+
+cJSON* CJsonObject::GetObjectItem(cJSON* pJsonData, const char* szKey) const
+{
+    if (m_bCaseSensitive)
+    {
+        return(cJSON_GetObjectItemCaseSensitive(pJsonData, szKey));
+    }
+    return(cJSON_GetObjectItem(pJsonData, szKey));
+}
+
+void CJsonObject::DeleteObjectItem(cJSON* pJsonData, const char* szKey) const
+{
+    if (m_bCaseSensitive)
+    {
+        cJSON_DeleteItemFromObjectCaseSensitive(pJsonData, szKey);
+    }
+    else
+    {
+        cJSON_DeleteItemFromObject(pJsonData, szKey);
+    }
+}
+
+void CJsonObject::ReplaceObjectItem(cJSON* pJsonData, const char* szKey, cJSON* pNewItem) const
+{
+    if (m_bCaseSensitive)
+    {
+        cJSON_ReplaceItemInObjectCaseSensitive(pJsonData, szKey, pNewItem);
+    }
+    else
+    {
+        cJSON_ReplaceItemInObject(pJsonData, szKey, pNewItem);
+    }
+}
+
+bool CJsonObject::LazyFind(const std::string& strKey, size_t& uiBegin, size_t& uiEnd) const
+{
+    const CJsonLazyDoc* pDoc = m_pLazyRoot->m_pLazyDoc;
+    const char* szJson = pDoc->strJson.c_str();
+    if (szJson[m_uiLazyBegin] != '{')
+    {
+        return(false);
+    }
+    size_t uiPos = LazySkipSpace(szJson, m_uiLazyBegin + 1);
+    while (szJson[uiPos] == '"')
+    {
+        size_t uiKeyEnd = LazySkipString(pDoc->strJson, uiPos);
+        if (uiKeyEnd == std::string::npos)
+        {
+            return(false);
+        }
+        bool bMatch = LazyKeyEqual(pDoc->strJson, uiPos, uiKeyEnd, strKey, m_bCaseSensitive);
+        uiPos = LazySkipSpace(szJson, uiKeyEnd);
+        if (szJson[uiPos] != ':')
+        {
+            return(false);
+        }
+        uiBegin = LazySkipSpace(szJson, uiPos + 1);
+        uiEnd = LazySkipValue(pDoc, uiBegin);
+        if (bMatch)
+        {
+            return(uiEnd > uiBegin);
+        }
+        uiPos = LazySkipSpace(szJson, uiEnd);
+        if (szJson[uiPos] != ',')
+        {
+            return(false);
+        }
+        uiPos = LazySkipSpace(szJson, uiPos + 1);
+    }
+    return(false);
+}
+
+bool CJsonObject::LazyFind(unsigned int uiWhich, size_t& uiBegin, size_t& uiEnd) const
+{
+    const CJsonLazyDoc* pDoc = m_pLazyRoot->m_pLazyDoc;
+    const char* szJson = pDoc->strJson.c_str();
+    if (szJson[m_uiLazyBegin] != '[')
+    {
+        return(false);
+    }
+    size_t uiPos = LazySkipSpace(szJson, m_uiLazyBegin + 1);
+    for (unsigned int i = 0; szJson[uiPos] && szJson[uiPos] != ']'; ++i)
+    {
+        uiBegin = uiPos;
+        uiEnd = LazySkipValue(pDoc, uiBegin);
+        if (uiEnd == uiBegin)
+        {
+            return(false);
+        }
+        if (i == uiWhich)
+        {
+            return(true);
+        }
+        uiPos = LazySkipSpace(szJson, uiEnd);
+        if (szJson[uiPos] != ',')
+        {
+            return(false);
+        }
+        uiPos = LazySkipSpace(szJson, uiPos + 1);
+    }
+    return(false);
+}
+
+CJsonObject* CJsonObject::LazyChild(size_t uiBegin, size_t uiEnd)
+{
+    const char* szJson = m_pLazyRoot->m_pLazyDoc->strJson.c_str();
+    CJsonObject* pJsonObject = new CJsonObject();
+    pJsonObject->m_bCaseSensitive = m_bCaseSensitive;
+    pJsonObject->m_pLazyRoot = m_pLazyRoot;
+    pJsonObject->m_uiLazyBegin = uiBegin;
+    if (szJson[uiBegin] == '{')
+    {
+        pJsonObject->m_pJsonData = cJSON_CreateObject();
+        pJsonObject->m_bLazyPartial = true;
+    }
+    else if (szJson[uiBegin] == '[')
+    {
+        pJsonObject->m_bLazyPartial = true;
+    }
+    else
+    {
+        pJsonObject->m_pJsonData = cJSON_Parse(std::string(szJson + uiBegin, uiEnd - uiBegin).c_str());
+    }
+    pJsonObject->m_pKeyTravers = pJsonObject->m_pJsonData;
+    return(pJsonObject);
+}
+
+void CJsonObject::LazyTouch(const std::string& strKey) const
+{
+    size_t uiBegin = 0;
+    size_t uiEnd = 0;
+    if (!m_bLazyPartial || m_pJsonData == NULL || GetObjectItem(m_pJsonData, strKey.c_str()) != NULL)
+    {
+        return;
+    }
+    if (LazyFind(strKey, uiBegin, uiEnd))
+    {
+        cJSON* pJsonStruct = cJSON_Parse(m_pLazyRoot->m_pLazyDoc->strJson.c_str() + uiBegin);
+        if (pJsonStruct != NULL)
+        {
+            cJSON_AddItemToObject(m_pJsonData, strKey.c_str(), pJsonStruct);
+        }
+    }
+}
+
+void CJsonObject::LazyLoad() const
+{
+    if (!m_bLazyPartial)
+    {
+        return;
+    }
+    CJsonObject* pThis = const_cast<CJsonObject*>(this);
+    cJSON* pJsonData = cJSON_Parse(m_pLazyRoot->m_pLazyDoc->strJson.c_str() + m_uiLazyBegin);
+    if (pJsonData == NULL)
+    {
+        pThis->m_strErrMsg = std::string("prase json string error at ") + cJSON_GetErrorPtr();
+    }
+    // children handed out so far stay lazy while any ancestor still reads from the text
+    bool bRoot = (m_pLazyRoot == this);
+    pThis->LazyRebindChildren(pJsonData, bRoot ? NULL : m_pLazyRoot);
+    if (m_pJsonData != NULL)
+    {
+        cJSON_Delete(m_pJsonData);
+    }
+    pThis->m_pJsonData = pJsonData;
+    pThis->m_pKeyTravers = pJsonData;
+    pThis->m_bLazyPartial = false;
+    if (bRoot)
+    {
+        delete m_pLazyDoc;
+        pThis->m_pLazyDoc = NULL;
+        pThis->m_pLazyRoot = NULL;
+    }
+}
+
+void CJsonObject::LazyMaterialize()
+{
+    // writes must land in the root's tree, so the whole document is parsed once and every child re-pointed into it
+    if (m_pLazyRoot != NULL)
+    {
+        m_pLazyRoot->LazyLoad();
+    }
+}
+
+void CJsonObject::LazyRebind(cJSON* pJsonData, CJsonObject* pLazyRoot)
+{
+    LazyRebindChildren(pJsonData, pLazyRoot);
+    if (m_pJsonData != NULL)
+    {
+        cJSON_Delete(m_pJsonData);
+        m_pJsonData = NULL;
+    }
+    m_pExternJsonDataRef = pJsonData;
+    m_pKeyTravers = pJsonData;
+    m_pLazyRoot = pLazyRoot;
+    m_bLazyPartial = false;
+}
+
+void CJsonObject::LazyRebindChildren(cJSON* pJsonData, CJsonObject* pLazyRoot)
+{
+    for (std::map<std::string, CJsonObject*>::iterator iter = m_mapJsonObjectRef.begin();
+                    iter != m_mapJsonObjectRef.end(); ++iter)
+    {
+        if (iter->second != NULL && iter->second->m_pLazyRoot != NULL)
+        {
+            cJSON* pJsonStruct = NULL;
+            if (pJsonData != NULL && pJsonData->type == cJSON_Object)
+            {
+                pJsonStruct = GetObjectItem(pJsonData, iter->first.c_str());
+            }
+            iter->second->LazyRebind(pJsonStruct, pLazyRoot);
+        }
+    }
+    for (std::map<unsigned int, CJsonObject*>::iterator iter = m_mapJsonArrayRef.begin();
+                    iter != m_mapJsonArrayRef.end(); ++iter)
+    {
+        if (iter->second != NULL && iter->second->m_pLazyRoot != NULL)
+        {
+            cJSON* pJsonStruct = NULL;
+            if (pJsonData != NULL && pJsonData->type == cJSON_Array)
+            {
+                pJsonStruct = cJSON_GetArrayItem(pJsonData, iter->first);
+            }
+            iter->second->LazyRebind(pJsonStruct, pLazyRoot);
+        }
+    }
+}
+
+void CJsonObject::Move(CJsonObject& oJsonObject)
+{
+    // only a tree the object owns outright can change hands; views into a parent are still copied
+    if (oJsonObject.m_pLazyRoot == &oJsonObject)
+    {
+        oJsonObject.LazyLoad();
+    }
+    if (oJsonObject.m_pJsonData == NULL || oJsonObject.m_pLazyRoot != NULL)
+    {
+        Parse(oJsonObject.ToString());
+        return;
+    }
+    Clear();
+    m_pJsonData = oJsonObject.m_pJsonData;
+    m_pKeyTravers = oJsonObject.m_pKeyTravers;
+    m_strErrMsg.swap(oJsonObject.m_strErrMsg);
+    m_mapJsonArrayRef.swap(oJsonObject.m_mapJsonArrayRef);
+    m_mapJsonObjectRef.swap(oJsonObject.m_mapJsonObjectRef);
+    oJsonObject.m_pJsonData = NULL;
+    oJsonObject.m_pKeyTravers = NULL;
+}
+
+CJsonView CJsonObject::View() const
+{
+    LazyLoad();
+    return(CJsonView(m_pJsonData != NULL ? m_pJsonData : m_pExternJsonDataRef, m_bCaseSensitive));
+}
+
+bool CJsonView::IsArray() const
+{
+    return(m_pJsonData != NULL && m_pJsonData->type == cJSON_Array);
+}
+
+bool CJsonView::IsObject() const
+{
+    return(m_pJsonData != NULL && m_pJsonData->type == cJSON_Object);
+}
+
+int CJsonView::GetArraySize() const
+{
+    if (IsArray())
+    {
+        return(cJSON_GetArraySize(m_pJsonData));
+    }
+    return(0);
+}
+
+const char* CJsonView::GetKey() const
+{
+    return(m_pJsonData != NULL ? m_pJsonData->string : NULL);
+}
+
+CJsonView CJsonView::First() const
+{
+    if (IsArray() || IsObject())
+    {
+        return(CJsonView(m_pJsonData->child, m_bCaseSensitive));
+    }
+    return(CJsonView());
+}
+
+CJsonView CJsonView::Next() const
+{
+    return(CJsonView(m_pJsonData != NULL ? m_pJsonData->next : NULL, m_bCaseSensitive));
+}
+
+CJsonView CJsonView::operator[](const std::string& strKey) const
+{
+    if (!IsObject())
+    {
+        return(CJsonView());
+    }
+    if (m_bCaseSensitive)
+    {
+        return(CJsonView(cJSON_GetObjectItemCaseSensitive(m_pJsonData, strKey.c_str()), m_bCaseSensitive));
+    }
+    return(CJsonView(cJSON_GetObjectItem(m_pJsonData, strKey.c_str()), m_bCaseSensitive));
+}
+
+CJsonView CJsonView::operator[](unsigned int uiWhich) const
+{
+    if (!IsArray())
+    {
+        return(CJsonView());
+    }
+    return(CJsonView(cJSON_GetArrayItem(m_pJsonData, uiWhich), m_bCaseSensitive));
+}
+
+std::string CJsonView::operator()(const std::string& strKey) const
+{
+    std::string strValue;
+    (*this)[strKey].ToValueString(strValue);
+    return(strValue);
+}
+
+std::string CJsonView::operator()(unsigned int uiWhich) const
+{
+    std::string strValue;
+    (*this)[uiWhich].ToValueString(strValue);
+    return(strValue);
+}
+
+std::string CJsonView::ToString() const
+{
+    std::string strJsonData;
+    ToString(strJsonData);
+    return(strJsonData);
+}
+
+std::string CJsonView::ToFormattedString() const
+{
+    std::string strJsonData;
+    cJSON_PrintBuffer oPrintBuffer = {};
+    oPrintBuffer.grow_fn = &CJsonObject::GrowString;
+    oPrintBuffer.user = &strJsonData;
+    if (m_pJsonData != NULL)
+    {
+        cJSON_PrintBuffered(m_pJsonData, 1, &oPrintBuffer);
+    }
+    strJsonData.resize(oPrintBuffer.length);
+    return(strJsonData);
+}
+
+bool CJsonView::ToString(std::string& strJson) const
+{
+    cJSON_PrintBuffer oPrintBuffer = {};
+    oPrintBuffer.grow_fn = &CJsonObject::GrowString;
+    oPrintBuffer.user = &strJson;
+    strJson.resize(strJson.capacity());
+    oPrintBuffer.buffer = strJson.empty() ? NULL : &strJson[0];
+    oPrintBuffer.size = strJson.size();
+    bool bResult = (m_pJsonData != NULL && cJSON_PrintBuffered(m_pJsonData, 0, &oPrintBuffer) != 0);
+    strJson.resize(oPrintBuffer.length);
+    return(bResult);
+}
+
+bool CJsonView::Get(std::string& strValue) const
+{
+    if (m_pJsonData == NULL || m_pJsonData->type != cJSON_String)
+    {
+        return(false);
+    }
+    strValue = m_pJsonData->valuestring;
+    return(true);
+}
+
+bool CJsonView::Get(int32& iValue) const
+{
+    if (m_pJsonData != NULL && m_pJsonData->type == cJSON_Int)
+    {
+        iValue = (int32)(m_pJsonData->valueint);
+        return(true);
+    }
+    else if (m_pJsonData != NULL && m_pJsonData->type == cJSON_Double)
+    {
+        iValue = (int32)(m_pJsonData->valuedouble);
+        return(true);
+    }
+    return(false);
+}
+
+bool CJsonView::Get(uint32& uiValue) const
+{
+    if (m_pJsonData != NULL && m_pJsonData->type == cJSON_Int)
+    {
+        uiValue = (uint32)(m_pJsonData->valueint);
+        return(true);
+    }
+    else if (m_pJsonData != NULL && m_pJsonData->type == cJSON_Double)
+    {
+        uiValue = (uint32)(m_pJsonData->valuedouble);
+        return(true);
+    }
+    return(false);
+}
+
+bool CJsonView::Get(int64& llValue) const
+{
+    if (m_pJsonData != NULL && m_pJsonData->type == cJSON_Int)
+    {
+        llValue = (int64)(m_pJsonData->valueint);
+        return(true);
+    }
+    else if (m_pJsonData != NULL && m_pJsonData->type == cJSON_Double)
+    {
+        llValue = (int64)(m_pJsonData->valuedouble);
+        return(true);
+    }
+    return(false);
+}
+
+bool CJsonView::Get(uint64& ullValue) const
+{
+    if (m_pJsonData != NULL && m_pJsonData->type == cJSON_Int)
+    {
+        ullValue = (uint64)(m_pJsonData->valueint);
+        return(true);
+    }
+    else if (m_pJsonData != NULL && m_pJsonData->type == cJSON_Double)
+    {
+        ullValue = (uint64)(m_pJsonData->valuedouble);
+        return(true);
+    }
+    return(false);
+}
+
+bool CJsonView::Get(bool& bValue) const
+{
+    if (m_pJsonData == NULL || m_pJsonData->type > cJSON_True)
+    {
+        return(false);
+    }
+    bValue = (m_pJsonData->type == cJSON_True);
+    return(true);
+}
+
+bool CJsonView::Get(float& fValue) const
+{
+    double dValue = 0;
+    if (!Get(dValue))
+    {
+        return(false);
+    }
+    fValue = (float)dValue;
+    return(true);
+}
+
+bool CJsonView::Get(double& dValue) const
+{
+    if (m_pJsonData != NULL && m_pJsonData->type == cJSON_Double)
+    {
+        dValue = m_pJsonData->valuedouble;
+        return(true);
+    }
+    else if (m_pJsonData != NULL && m_pJsonData->type == cJSON_Int)
+    {
+        dValue = (m_pJsonData->sign == -1) ? (double)(int64)m_pJsonData->valueint : (double)m_pJsonData->valueint;
+        return(true);
+    }
+    return(false);
+}
+
+bool CJsonView::ToValueString(std::string& strValue) const
+{
+    char szNumber[128] = {0};
+    if (m_pJsonData == NULL)
+    {
+        return(false);
+    }
+    switch (m_pJsonData->type)
+    {
+    case cJSON_String:
+        strValue = m_pJsonData->valuestring;
+        return(true);
+    case cJSON_Int:
+        if (m_pJsonData->sign == -1)
+        {
+            snprintf(szNumber, sizeof(szNumber), "%lld", (int64)m_pJsonData->valueint);
+        }
+        else
+        {
+            snprintf(szNumber, sizeof(szNumber), "%llu", m_pJsonData->valueint);
+        }
+        strValue = szNumber;
+        return(true);
+    case cJSON_Double:
+        if (fabs(m_pJsonData->valuedouble) < 1.0e-6 || fabs(m_pJsonData->valuedouble) > 1.0e9)
+        {
+            snprintf(szNumber, sizeof(szNumber), "%e", m_pJsonData->valuedouble);
+        }
+        else
+        {
+            snprintf(szNumber, sizeof(szNumber), "%f", m_pJsonData->valuedouble);
+        }
+        strValue = szNumber;
+        return(true);
+    case cJSON_False:
+        strValue = "false";
+        return(true);
+    case cJSON_True:
+        strValue = "true";
+        return(true);
+    default:
+        return(false);
+    }
+}
+
+bool CJsonView::IsNull() const
+{
+    return(m_pJsonData != NULL && m_pJsonData->type == cJSON_NULL);
+}
+
+CJsonView CJsonView::operator[](const CJsonPath& oPath) const
+{
+    unsigned int uiPending = 1;
+    if (oPath.Size() <= 1)
+    {
+        CJsonView oFirst;
+        if (m_pJsonData != NULL && oPath.Size() == 1)
+        {
+            Walk(oPath, 0, m_pJsonData, &oFirst, NULL, uiPending);
+        }
+        return(oFirst);
+    }
+    std::vector<CJsonView> vecMatch;
+    Find(oPath, vecMatch);
+    return(vecMatch[0]);
+}
+
+bool CJsonView::Find(const CJsonPath& oPath, std::vector<CJsonView>& vecMatch) const
+{
+    vecMatch.assign(oPath.Size(), CJsonView());
+    unsigned int uiPending = oPath.Size();
+    if (m_pJsonData != NULL && uiPending > 0)
+    {
+        Walk(oPath, 0, m_pJsonData, &vecMatch[0], NULL, uiPending);
+    }
+    return(uiPending == 0);
+}
+
+size_t CJsonView::FindAll(const CJsonPath& oPath, std::vector<CJsonView>& vecMatch) const
+{
+    size_t uiSize = vecMatch.size();
+    unsigned int uiPending = 0;
+    if (m_pJsonData != NULL && oPath.Size() > 0)
+    {
+        Walk(oPath, 0, m_pJsonData, NULL, &vecMatch, uiPending);
+    }
+    return(vecMatch.size() - uiSize);
+}
+
+// match oPath's step uiStep against pJsonData and descend; returns false once every first match is in
+bool CJsonView::Walk(const CJsonPath& oPath, unsigned int uiStep, cJSON* pJsonData,
+                     CJsonView* pFirst, std::vector<CJsonView>* pAll, unsigned int& uiPending) const
+{
+    const CJsonPath::CStep& oStep = oPath.m_vecStep[uiStep];
+    for (size_t i = 0; i < oStep.vecSlot.size(); ++i)
+    {
+        if (pAll != NULL)
+        {
+            pAll->push_back(CJsonView(pJsonData, m_bCaseSensitive));
+        }
+        else if (pFirst[oStep.vecSlot[i]].IsEmpty())
+        {
+            pFirst[oStep.vecSlot[i]] = CJsonView(pJsonData, m_bCaseSensitive);
+            if (--uiPending == 0)
+            {
+                return(false);
+            }
+        }
+    }
+    if (pJsonData->type == cJSON_Object)
+    {
+        for (size_t i = 0; i < oStep.vecChild.size(); ++i)
+        {
+            const CJsonPath::CStep& oChild = oPath.m_vecStep[oStep.vecChild[i]];
+            if (oChild.bWildcard)
+            {
+                for (cJSON* pItem = pJsonData->child; pItem != NULL; pItem = pItem->next)
+                {
+                    if (!Walk(oPath, oStep.vecChild[i], pItem, pFirst, pAll, uiPending))
+                    {
+                        return(false);
+                    }
+                }
+                continue;
+            }
+            cJSON* pItem = m_bCaseSensitive
+                ? cJSON_GetObjectItemCaseSensitive(pJsonData, oChild.strKey.c_str())
+                : cJSON_GetObjectItem(pJsonData, oChild.strKey.c_str());
+            if (pItem != NULL && !Walk(oPath, oStep.vecChild[i], pItem, pFirst, pAll, uiPending))
+            {
+                return(false);
+            }
+        }
+    }
+    else if (pJsonData->type == cJSON_Array)
+    {
+        // one pass over the items serves every index and wildcard step below this one
+        uint32 uiIndex = 0;
+        for (cJSON* pItem = pJsonData->child; pItem != NULL; pItem = pItem->next, ++uiIndex)
+        {
+            if (!oStep.bWildcardChild && uiIndex >= oStep.uiIndexEnd)
+            {
+                break;
+            }
+            for (size_t i = 0; i < oStep.vecChild.size(); ++i)
+            {
+                const CJsonPath::CStep& oChild = oPath.m_vecStep[oStep.vecChild[i]];
+                if ((oChild.bWildcard || oChild.uiIndex == uiIndex)
+                    && !Walk(oPath, oStep.vecChild[i], pItem, pFirst, pAll, uiPending))
+                {
+                    return(false);
+                }
+            }
+        }
+    }
+    return(true);
+}
+
+CJsonPath::CJsonPath()
+    : m_uiSize(0)
+{
+    Clear();
+}
+
+CJsonPath::CJsonPath(const std::string& strPointer)
+    : m_uiSize(0)
+{
+    Clear();
+    Add(strPointer);
+}
+
+void CJsonPath::Clear()
+{
+    m_vecStep.resize(1);
+    m_vecStep[0].strKey.clear();
+    m_vecStep[0].uiIndex = 0xFFFFFFFF;
+    m_vecStep[0].bWildcard = false;
+    m_vecStep[0].bWildcardChild = false;
+    m_vecStep[0].uiIndexEnd = 0;
+    m_vecStep[0].vecChild.clear();
+    m_vecStep[0].vecSlot.clear();
+    m_uiSize = 0;
+    m_strErrMsg.clear();
+}
+
+int CJsonPath::Add(const std::string& strPointer)
+{
+    if (!strPointer.empty() && strPointer[0] != '/')
+    {
+        m_strErrMsg = "json pointer must be empty or start with '/': " + strPointer;
+        return(-1);
+    }
+
+    // split and unescape first, so a malformed pointer leaves the path untouched
+    std::vector<std::string> vecToken;
+    for (size_t uiPos = 0; uiPos < strPointer.size(); )
+    {
+        size_t uiEnd = strPointer.find('/', uiPos + 1);
+        if (uiEnd == std::string::npos)
+        {
+            uiEnd = strPointer.size();
+        }
+        std::string strToken;
+        for (size_t i = uiPos + 1; i < uiEnd; ++i)
+        {
+            if (strPointer[i] != '~')
+            {
+                strToken += strPointer[i];
+            }
+            else if (i + 1 < uiEnd && (strPointer[i + 1] == '0' || strPointer[i + 1] == '1'))
+            {
+                strToken += (strPointer[++i] == '0') ? '~' : '/';
+            }
+            else
+            {
+                m_strErrMsg = "json pointer has '~' not followed by '0' or '1': " + strPointer;
+                return(-1);
+            }
+        }
+        vecToken.push_back(strToken);
+        uiPos = uiEnd;
+    }
+
+    unsigned int uiStep = 0;
+    for (size_t t = 0; t < vecToken.size(); ++t)
+    {
+        // "*" is the wildcard; a member literally named "*" is still reached through it
+        bool bWildcard = (vecToken[t] == "*");
+        unsigned int uiNext = 0;
+        for (size_t i = 0; i < m_vecStep[uiStep].vecChild.size(); ++i)
+        {
+            const CStep& oChild = m_vecStep[m_vecStep[uiStep].vecChild[i]];
+            if (oChild.bWildcard == bWildcard && oChild.strKey == vecToken[t])
+            {
+                uiNext = m_vecStep[uiStep].vecChild[i];
+                break;
+            }
+        }
+        if (uiNext == 0)
+        {
+            CStep oStep;
+            oStep.strKey = vecToken[t];
+            oStep.uiIndex = 0xFFFFFFFF;
+            oStep.bWildcard = bWildcard;
+            oStep.bWildcardChild = false;
+            oStep.uiIndexEnd = 0;
+            const std::string& strToken = oStep.strKey;
+            if (!strToken.empty() && strToken.size() <= 10 && (strToken[0] != '0' || strToken.size() == 1)
+                && strToken.find_first_not_of("0123456789") == std::string::npos)
+            {
+                uint64 ullIndex = 0;
+                for (size_t i = 0; i < strToken.size(); ++i)
+                {
+                    ullIndex = ullIndex * 10 + (strToken[i] - '0');
+                }
+                if (ullIndex < 0xFFFFFFFF)
+                {
+                    oStep.uiIndex = (uint32)ullIndex;
+                }
+            }
+            uiNext = (unsigned int)m_vecStep.size();
+            m_vecStep.push_back(oStep);
+            CStep& oParent = m_vecStep[uiStep];
+            oParent.vecChild.push_back(uiNext);
+            if (bWildcard)
+            {
+                oParent.bWildcardChild = true;
+            }
+            else if (oStep.uiIndex != 0xFFFFFFFF && oStep.uiIndex + 1 > oParent.uiIndexEnd)
+            {
+                oParent.uiIndexEnd = oStep.uiIndex + 1;
+            }
+        }
+        uiStep = uiNext;
+    }
+    m_vecStep[uiStep].vecSlot.push_back(m_uiSize);
+    return((int)m_uiSize++);
+}
+
+bool CJsonObject::Find(const CJsonPath& oPath, std::vector<CJsonView>& vecMatch) const
+{
+    return(View().Find(oPath, vecMatch));
+}
+
+size_t CJsonObject::FindAll(const CJsonPath& oPath, std::vector<CJsonView>& vecMatch) const
+{
+    return(View().FindAll(oPath, vecMatch));
+}
+
 CJsonObject::CJsonObject(cJSON* pJsonData)
-    : m_pJsonData(NULL), m_pExternJsonDataRef(pJsonData), m_pKeyTravers(pJsonData)
+    : m_pJsonData(NULL), m_pExternJsonDataRef(pJsonData), m_pKeyTravers(pJsonData), m_bCaseSensitive(false),
+      m_pLazyDoc(NULL), m_pLazyRoot(NULL), m_uiLazyBegin(0), m_bLazyPartial(false)
 {
 }
 
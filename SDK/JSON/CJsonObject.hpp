@@ -20,6 +20,7 @@
 #include <string>
 #include <map>
 #include <list>
+#include <vector>
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -30,9 +31,134 @@ extern "C" {
 
 
 
+template<class T, size_t MAX_CACHE_SIZE> class CBufferPtrT;
+
 namespace neb
 {
 
+struct CJsonLazyDoc;
+class CJsonObject;
+
+/**
+ * @brief JSON Pointer (RFC 6901) compiled once and applied to many documents
+ * @note  "/items/0/price" addresses one value; a "*" step matches every member
+ *        or item at its level. Several pointers added to one path share their
+ *        common prefixes and are resolved together in a single walk.
+ */
+class CJsonPath
+{
+public:
+    CJsonPath();
+    explicit CJsonPath(const std::string& strPointer);
+
+    int Add(const std::string& strPointer);     // slot of the new pointer, -1 if it is malformed
+    void Clear();
+    unsigned int Size() const
+    {
+        return(m_uiSize);
+    }
+    const std::string& GetErrMsg() const
+    {
+        return(m_strErrMsg);
+    }
+
+private:
+    struct CStep
+    {
+        std::string strKey;                     // unescaped reference token
+        uint32 uiIndex;                         // strKey as an array index, 0xFFFFFFFF if it is not one
+        bool bWildcard;
+        bool bWildcardChild;
+        uint32 uiIndexEnd;                      // one past the largest index among the children
+        std::vector<unsigned int> vecChild;
+        std::vector<unsigned int> vecSlot;      // pointers that end here
+    };
+
+    std::vector<CStep> m_vecStep;               // m_vecStep[0] is the document itself
+    unsigned int m_uiSize;
+    std::string m_strErrMsg;
+
+    friend class CJsonView;
+};
+
+/**
+ * @brief non-owning cursor into a CJsonObject's tree for read-only navigation
+ * @note  copying or indexing a view allocates nothing; a view is valid until
+ *        the CJsonObject it came from is modified or destroyed
+ */
+class CJsonView
+{
+public:
+    CJsonView() : m_pJsonData(NULL), m_bCaseSensitive(false)
+    {
+    }
+    explicit CJsonView(cJSON* pJsonData, bool bCaseSensitive = false)
+        : m_pJsonData(pJsonData), m_bCaseSensitive(bCaseSensitive)
+    {
+    }
+
+    bool IsEmpty() const
+    {
+        return(m_pJsonData == NULL);
+    }
+    bool IsArray() const;
+    bool IsObject() const;
+    int GetArraySize() const;
+    const char* GetKey() const;                 // key of this member, NULL for array items
+    CJsonView First() const;                    // first member or item, for traversal without GetKey() state
+    CJsonView Next() const;
+    CJsonView operator[](const std::string& strKey) const;
+    CJsonView operator[](unsigned int uiWhich) const;
+    std::string operator()(const std::string& strKey) const;
+    std::string operator()(unsigned int uiWhich) const;
+    std::string ToString() const;
+    std::string ToFormattedString() const;
+    bool ToString(std::string& strJson) const;
+
+    bool Get(std::string& strValue) const;      // value of the viewed item itself
+    bool Get(int32& iValue) const;
+    bool Get(uint32& uiValue) const;
+    bool Get(int64& llValue) const;
+    bool Get(uint64& ullValue) const;
+    bool Get(bool& bValue) const;
+    bool Get(float& fValue) const;
+    bool Get(double& dValue) const;
+    bool IsNull() const;
+    template<class T> bool Get(const std::string& strKey, T& tValue) const
+    {
+        return((*this)[strKey].Get(tValue));
+    }
+    template<class T> bool Get(int iWhich, T& tValue) const
+    {
+        return((*this)[(unsigned int)iWhich].Get(tValue));
+    }
+    bool IsNull(const std::string& strKey) const
+    {
+        return((*this)[strKey].IsNull());
+    }
+    bool IsNull(int iWhich) const
+    {
+        return((*this)[(unsigned int)iWhich].IsNull());
+    }
+
+    CJsonView operator[](const CJsonPath& oPath) const;                         // first match of the first pointer
+    bool Find(const CJsonPath& oPath, std::vector<CJsonView>& vecMatch) const;   // first match of each pointer, by slot
+    size_t FindAll(const CJsonPath& oPath, std::vector<CJsonView>& vecMatch) const;  // appends every match
+    template<class T> bool Get(const CJsonPath& oPath, T& tValue) const
+    {
+        return((*this)[oPath].Get(tValue));
+    }
+
+private:
+    bool ToValueString(std::string& strValue) const;
+    bool Walk(const CJsonPath& oPath, unsigned int uiStep, cJSON* pJsonData,
+              CJsonView* pFirst, std::vector<CJsonView>* pAll, unsigned int& uiPending) const;
+
+private:
+    cJSON* m_pJsonData;
+    bool m_bCaseSensitive;
+};
+
 class CJsonObject
 {
 public:     // method of ordinary json object or json array
@@ -40,20 +166,40 @@ public:     // method of ordinary json object or json array
     CJsonObject(const std::string& strJson);
     CJsonObject(const CJsonObject* pJsonObject);
     CJsonObject(const CJsonObject& oJsonObject);
+    CJsonObject(CJsonObject&& oJsonObject);
     virtual ~CJsonObject();
 
     CJsonObject& operator=(const CJsonObject& oJsonObject);
+    CJsonObject& operator=(CJsonObject&& oJsonObject);
     bool operator==(const CJsonObject& oJsonObject) const;
     bool Parse(const std::string& strJson);
+    // Index brackets only; values are parsed when Get()/operator[] reach them. Such reads add to the tree, so
+    // even const access to a lazily parsed object must stay on one thread; Parse() it instead if it is shared.
+    bool ParseLazy(const std::string& strJson);
     void Clear();
     bool IsEmpty() const;
     bool IsArray() const;
     std::string ToString() const;
     std::string ToFormattedString() const;
+    bool ToString(std::string& strJson) const;              // reuses the capacity of strJson
+    bool ToFormattedString(std::string& strJson) const;
+    template<class T, size_t S> bool ToBuffer(CBufferPtrT<T, S>& oBuffer, bool bFormatted = false) const;   // e.g. for TcpServerSystem::Send(dwConnID, oBuffer.Ptr(), (int)oBuffer.Size())
+    bool ToMsgPack(std::string& strMsgPack) const;      // MessagePack instead of text for the wire
+    template<class T, size_t S> bool ToMsgPack(CBufferPtrT<T, S>& oBuffer) const;
+    bool FromMsgPack(const void* pData, size_t uiSize);
+    static int GrowString(cJSON_PrintBuffer* pBuffer, size_t uiSize);     // grow_fn for a cJSON_PrintBuffer whose user is a std::string
     const std::string& GetErrMsg() const
     {
         return(m_strErrMsg);
     }
+    void SetCaseSensitive(bool bCaseSensitive);     // match keys exactly instead of ignoring case
+    CJsonView View() const;     // allocation-free read access, see CJsonView
+    bool Find(const CJsonPath& oPath, std::vector<CJsonView>& vecMatch) const;
+    size_t FindAll(const CJsonPath& oPath, std::vector<CJsonView>& vecMatch) const;
+    template<class T> bool Get(const CJsonPath& oPath, T& tValue) const
+    {
+        return(View().Get(oPath, tValue));
+    }
 
 public:     // method of ordinary json object
     bool AddEmptySubObject(const std::string& strKey);
@@ -143,6 +289,21 @@ public:     // method of json array
 
 private:
     CJsonObject(cJSON* pJsonData);
+    cJSON* GetObjectItem(cJSON* pJsonData, const char* szKey) const;
+    void DeleteObjectItem(cJSON* pJsonData, const char* szKey) const;
+    void ReplaceObjectItem(cJSON* pJsonData, const char* szKey, cJSON* pNewItem) const;
+    bool Print(cJSON_PrintBuffer* pBuffer, bool bFormatted) const;
+    bool PrintMsgPack(cJSON_PrintBuffer* pBuffer) const;
+    void Move(CJsonObject& oJsonObject);
+    template<class T, size_t S> static int GrowBuffer(cJSON_PrintBuffer* pBuffer, size_t uiSize);
+    bool LazyFind(const std::string& strKey, size_t& uiBegin, size_t& uiEnd) const;
+    bool LazyFind(unsigned int uiWhich, size_t& uiBegin, size_t& uiEnd) const;
+    CJsonObject* LazyChild(size_t uiBegin, size_t uiEnd);
+    void LazyTouch(const std::string& strKey) const;
+    void LazyLoad() const;
+    void LazyMaterialize();
+    void LazyRebind(cJSON* pJsonData, CJsonObject* pLazyRoot);
+    void LazyRebindChildren(cJSON* pJsonData, CJsonObject* pLazyRoot);
 
 private:
     cJSON* m_pJsonData;
@@ -151,8 +312,65 @@ private:
     std::string m_strErrMsg;
     std::map<unsigned int, CJsonObject*> m_mapJsonArrayRef;
     std::map<std::string, CJsonObject*> m_mapJsonObjectRef;
+    bool m_bCaseSensitive;
+    CJsonLazyDoc* m_pLazyDoc;           // owned by the object ParseLazy() was called on
+    CJsonObject* m_pLazyRoot;           // that object, while this one still reads from its text
+    size_t m_uiLazyBegin;
+    bool m_bLazyPartial;                // m_pJsonData holds only the members reached so far
+
+    friend class CJsonView;
 };
 
+template<class T, size_t S>
+bool CJsonObject::ToBuffer(CBufferPtrT<T, S>& oBuffer, bool bFormatted) const
+{
+    cJSON_PrintBuffer oPrintBuffer = {};
+    oBuffer.SetSize(oBuffer.Capacity());
+    oPrintBuffer.buffer = (char*)oBuffer.Ptr();
+    oPrintBuffer.size = oBuffer.Size() * sizeof(T);
+    oPrintBuffer.grow_fn = &CJsonObject::GrowBuffer<T, S>;
+    oPrintBuffer.user = &oBuffer;
+    bool bResult = Print(&oPrintBuffer, bFormatted);
+    oBuffer.SetSize(bResult ? (oPrintBuffer.length + sizeof(T) - 1) / sizeof(T) : 0);
+    return(bResult);
+}
+
+template<class T, size_t S>
+bool CJsonObject::ToMsgPack(CBufferPtrT<T, S>& oBuffer) const
+{
+    cJSON_PrintBuffer oPrintBuffer = {};
+    oBuffer.SetSize(oBuffer.Capacity());
+    oPrintBuffer.buffer = (char*)oBuffer.Ptr();
+    oPrintBuffer.size = oBuffer.Size() * sizeof(T);
+    oPrintBuffer.grow_fn = &CJsonObject::GrowBuffer<T, S>;
+    oPrintBuffer.user = &oBuffer;
+    bool bResult = PrintMsgPack(&oPrintBuffer);
+    oBuffer.SetSize(bResult ? (oPrintBuffer.length + sizeof(T) - 1) / sizeof(T) : 0);
+    return(bResult);
+}
+
+template<class T, size_t S>
+int CJsonObject::GrowBuffer(cJSON_PrintBuffer* pBuffer, size_t uiSize)
+{
+    CBufferPtrT<T, S>* pOutput = (CBufferPtrT<T, S>*)pBuffer->user;
+    size_t uiCount = (uiSize + sizeof(T) - 1) / sizeof(T);
+    if (uiCount < pOutput->Capacity() * 2)
+    {
+        uiCount = pOutput->Capacity() * 2;
+    }
+    try
+    {
+        pOutput->Realloc(uiCount);
+    }
+    catch (...)
+    {
+        return(0);
+    }
+    pBuffer->buffer = (char*)pOutput->Ptr();
+    pBuffer->size = pOutput->Size() * sizeof(T);
+    return(1);
+}
+
 }
 
 #endif /* CJSONHELPER_HPP_ */
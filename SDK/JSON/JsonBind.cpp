@@ -0,0 +1,501 @@
+/*******************************************************************************
+ * Project:  neb
+ * @file     JsonBind.cpp
+ * @brief    compile-time binding between C++ structs and json text
+ * @note
+ * Modify history:
+ ******************************************************************************/
+
+#include "JsonBind.hpp"
+#include <ctype.h>
+
+namespace neb
+{
+
+CJsonReader::CJsonReader(const char* szJson)
+    : m_szJson(szJson), m_szCursor(szJson), m_bCaseSensitive(false), m_strPath("$")
+{
+}
+
+void CJsonReader::SetCaseSensitive(bool bCaseSensitive)
+{
+    m_bCaseSensitive = bCaseSensitive;
+}
+
+bool CJsonReader::KeyEquals(const char* szKey) const
+{
+    if (m_bCaseSensitive)
+    {
+        return(m_strKey == szKey);
+    }
+    size_t i = 0;
+    for (; i < m_strKey.size() && szKey[i] != '\0'; ++i)
+    {
+        if (tolower((unsigned char)m_strKey[i]) != tolower((unsigned char)szKey[i]))
+        {
+            return(false);
+        }
+    }
+    return(i == m_strKey.size() && szKey[i] == '\0');
+}
+
+bool CJsonReader::Read(bool& bValue)
+{
+    SkipSpace();
+    if (strncmp(m_szCursor, "true", 4) == 0)
+    {
+        m_szCursor += 4;
+        bValue = true;
+        return(true);
+    }
+    if (strncmp(m_szCursor, "false", 5) == 0)
+    {
+        m_szCursor += 5;
+        bValue = false;
+        return(true);
+    }
+    if (ReadNull())
+    {
+        return(true);
+    }
+    return(Fail("expected true or false"));
+}
+
+bool CJsonReader::Read(int32& iValue)
+{
+    cJSON oNumber;
+    if (ReadNull())
+    {
+        return(true);
+    }
+    if (!ReadNumber(oNumber))
+    {
+        return(false);
+    }
+    iValue = (int32)oNumber.valueint;
+    return(true);
+}
+
+bool CJsonReader::Read(uint32& uiValue)
+{
+    cJSON oNumber;
+    if (ReadNull())
+    {
+        return(true);
+    }
+    if (!ReadNumber(oNumber))
+    {
+        return(false);
+    }
+    uiValue = (uint32)oNumber.valueint;
+    return(true);
+}
+
+bool CJsonReader::Read(int64& llValue)
+{
+    cJSON oNumber;
+    if (ReadNull())
+    {
+        return(true);
+    }
+    if (!ReadNumber(oNumber))
+    {
+        return(false);
+    }
+    llValue = (int64)oNumber.valueint;
+    return(true);
+}
+
+bool CJsonReader::Read(uint64& ullValue)
+{
+    cJSON oNumber;
+    if (ReadNull())
+    {
+        return(true);
+    }
+    if (!ReadNumber(oNumber))
+    {
+        return(false);
+    }
+    ullValue = oNumber.valueint;
+    return(true);
+}
+
+bool CJsonReader::Read(float& fValue)
+{
+    cJSON oNumber;
+    if (ReadNull())
+    {
+        return(true);
+    }
+    if (!ReadNumber(oNumber))
+    {
+        return(false);
+    }
+    fValue = (float)oNumber.valuedouble;
+    return(true);
+}
+
+bool CJsonReader::Read(double& dValue)
+{
+    cJSON oNumber;
+    if (ReadNull())
+    {
+        return(true);
+    }
+    if (!ReadNumber(oNumber))
+    {
+        return(false);
+    }
+    dValue = oNumber.valuedouble;
+    return(true);
+}
+
+bool CJsonReader::Read(std::string& strValue)
+{
+    if (ReadNull())
+    {
+        return(true);
+    }
+    if (*m_szCursor != '"')
+    {
+        return(Fail("expected string"));
+    }
+    cJSON_PrintBuffer oPrintBuffer = {};
+    oPrintBuffer.grow_fn = &CJsonObject::GrowString;
+    oPrintBuffer.user = &strValue;
+    strValue.resize(strValue.capacity());
+    oPrintBuffer.buffer = strValue.empty() ? NULL : &strValue[0];
+    oPrintBuffer.size = strValue.size();
+    const char* szEnd = cJSON_ParseStringBuffered(m_szCursor, &oPrintBuffer);
+    strValue.resize(oPrintBuffer.length);
+    if (szEnd == NULL)
+    {
+        return(Fail("unterminated string"));
+    }
+    m_szCursor = szEnd;
+    return(true);
+}
+
+bool CJsonReader::Read(CJsonObject& oJsonObject)
+{
+    SkipSpace();
+    const char* szBegin = m_szCursor;
+    if (!SkipValue())
+    {
+        return(false);
+    }
+    if (!oJsonObject.Parse(std::string(szBegin, m_szCursor - szBegin)))
+    {
+        m_szCursor = szBegin;
+        return(Fail("invalid json value"));
+    }
+    return(true);
+}
+
+bool CJsonReader::Finish()
+{
+    SkipSpace();
+    if (*m_szCursor != '\0')
+    {
+        return(Fail("unexpected trailing data"));
+    }
+    return(true);
+}
+
+void CJsonReader::SkipSpace()
+{
+    while (*m_szCursor && (unsigned char)*m_szCursor <= 32)
+    {
+        ++m_szCursor;
+    }
+}
+
+bool CJsonReader::ReadNull()
+{
+    SkipSpace();
+    if (strncmp(m_szCursor, "null", 4) == 0)
+    {
+        m_szCursor += 4;
+        return(true);
+    }
+    return(false);
+}
+
+bool CJsonReader::ReadNumber(cJSON& oNumber)
+{
+    const char* szEnd = cJSON_ParseNumber(&oNumber, m_szCursor);
+    if (szEnd == NULL)
+    {
+        return(Fail("expected number"));
+    }
+    m_szCursor = szEnd;
+    return(true);
+}
+
+// after '{' or a member: leaves the next key in m_strKey with the cursor past its ':'
+bool CJsonReader::NextMember(bool& bMore, bool bFirst)
+{
+    SkipSpace();
+    if (*m_szCursor == '}')
+    {
+        ++m_szCursor;
+        bMore = false;
+        return(true);
+    }
+    if (!bFirst)
+    {
+        if (*m_szCursor != ',')
+        {
+            return(Fail("expected ',' or '}'"));
+        }
+        ++m_szCursor;
+        SkipSpace();
+    }
+    if (*m_szCursor != '"')
+    {
+        return(Fail(bFirst ? "expected key or '}'" : "expected key"));
+    }
+    if (!Read(m_strKey))
+    {
+        return(false);
+    }
+    SkipSpace();
+    if (*m_szCursor != ':')
+    {
+        return(Fail("expected ':'"));
+    }
+    ++m_szCursor;
+    bMore = true;
+    return(true);
+}
+
+bool CJsonReader::NextElement(bool& bMore, bool bFirst)
+{
+    SkipSpace();
+    if (*m_szCursor == ']')
+    {
+        ++m_szCursor;
+        bMore = false;
+        return(true);
+    }
+    if (!bFirst)
+    {
+        if (*m_szCursor != ',')
+        {
+            return(Fail("expected ',' or ']'"));
+        }
+        ++m_szCursor;
+    }
+    bMore = true;
+    return(true);
+}
+
+void CJsonReader::PushIndex(size_t uiIndex)
+{
+    char szIndex[24];
+    char* pDigit = szIndex + sizeof(szIndex);
+    *--pDigit = ']';
+    do
+    {
+        *--pDigit = '0' + uiIndex % 10;
+        uiIndex /= 10;
+    } while (uiIndex > 0);
+    *--pDigit = '[';
+    m_strPath.append(pDigit, szIndex + sizeof(szIndex) - pDigit);
+}
+
+bool CJsonReader::ReadElement(std::vector<bool>& vecValue)
+{
+    bool bValue = false;
+    if (!Read(bValue))
+    {
+        return(false);
+    }
+    vecValue.push_back(bValue);
+    return(true);
+}
+
+// skip one value; scalars are checked, containers only for balanced brackets
+bool CJsonReader::SkipValue()
+{
+    cJSON oNumber;
+    SkipSpace();
+    switch (*m_szCursor)
+    {
+        case '"':
+            for (const char* p = m_szCursor + 1; *p; ++p)
+            {
+                if (*p == '"')
+                {
+                    m_szCursor = p + 1;
+                    return(true);
+                }
+                if (*p == '\\' && *++p == '\0')
+                {
+                    break;
+                }
+            }
+            return(Fail("unterminated string"));
+        case '{':
+        case '[':
+            {
+                int iDepth = 0;
+                for (const char* p = m_szCursor; *p; ++p)
+                {
+                    if (*p == '{' || *p == '[')
+                    {
+                        ++iDepth;
+                    }
+                    else if (*p == '}' || *p == ']')
+                    {
+                        if (--iDepth == 0)
+                        {
+                            m_szCursor = p + 1;
+                            return(true);
+                        }
+                    }
+                    else if (*p == '"')
+                    {
+                        for (++p; *p && *p != '"'; ++p)
+                        {
+                            if (*p == '\\' && p[1] != '\0')
+                            {
+                                ++p;
+                            }
+                        }
+                        if (*p == '\0')
+                        {
+                            break;
+                        }
+                    }
+                }
+            }
+            return(Fail("unterminated array or object"));
+        case 't':
+            if (strncmp(m_szCursor, "true", 4) == 0)
+            {
+                m_szCursor += 4;
+                return(true);
+            }
+            break;
+        case 'f':
+            if (strncmp(m_szCursor, "false", 5) == 0)
+            {
+                m_szCursor += 5;
+                return(true);
+            }
+            break;
+        case 'n':
+            if (ReadNull())
+            {
+                return(true);
+            }
+            break;
+        default:
+            if (cJSON_ParseNumber(&oNumber, m_szCursor) != NULL)
+            {
+                return(ReadNumber(oNumber));
+            }
+            break;
+    }
+    return(Fail("expected value"));
+}
+
+bool CJsonReader::Fail(const char* szExpected)
+{
+    char szOffset[32];
+    snprintf(szOffset, sizeof(szOffset), " at offset %u", (uint32)(m_szCursor - m_szJson));
+    m_strErrMsg = m_strPath + ": " + szExpected + szOffset;
+    return(false);
+}
+
+CJsonWriter::CJsonWriter(std::string& strJson)
+    : m_strJson(strJson)
+{
+}
+
+bool CJsonWriter::Write(bool bValue)
+{
+    m_strJson += bValue ? "true" : "false";
+    return(true);
+}
+
+bool CJsonWriter::Write(int32 iValue)
+{
+    return(Write((int64)iValue));
+}
+
+bool CJsonWriter::Write(uint32 uiValue)
+{
+    return(Write((uint64)uiValue));
+}
+
+bool CJsonWriter::Write(int64 llValue)
+{
+    char szNumber[24];
+    m_strJson.append(szNumber, snprintf(szNumber, sizeof(szNumber), "%lld", llValue));
+    return(true);
+}
+
+bool CJsonWriter::Write(uint64 ullValue)
+{
+    char szNumber[24];
+    m_strJson.append(szNumber, snprintf(szNumber, sizeof(szNumber), "%llu", ullValue));
+    return(true);
+}
+
+bool CJsonWriter::Write(float fValue)
+{
+    return(Write((double)fValue));
+}
+
+bool CJsonWriter::Write(double dValue)
+{
+    char szNumber[32];
+    m_strJson.append(szNumber, cJSON_FormatDouble(dValue, szNumber));
+    return(true);
+}
+
+bool CJsonWriter::Write(const char* szValue)
+{
+    if (szValue == NULL)
+    {
+        m_strJson += "null";
+        return(true);
+    }
+    return(WriteString(szValue, strlen(szValue)));
+}
+
+bool CJsonWriter::Write(const std::string& strValue)
+{
+    return(WriteString(strValue.data(), strValue.size()));
+}
+
+bool CJsonWriter::Write(const CJsonObject& oJsonObject)
+{
+    std::string strJson;
+    if (!oJsonObject.ToString(strJson))
+    {
+        m_strJson += "null";
+        return(true);
+    }
+    m_strJson += strJson;
+    return(true);
+}
+
+bool CJsonWriter::WriteString(const char* szValue, size_t uiLength)
+{
+    cJSON_PrintBuffer oPrintBuffer = {};
+    oPrintBuffer.grow_fn = &CJsonObject::GrowString;
+    oPrintBuffer.user = &m_strJson;
+    oPrintBuffer.length = m_strJson.size();
+    m_strJson.resize(m_strJson.size() + uiLength + 3);     // enough unless something needs escaping
+    oPrintBuffer.buffer = m_strJson.empty() ? NULL : &m_strJson[0];
+    oPrintBuffer.size = m_strJson.size();
+    int iResult = cJSON_PrintStringBuffered(szValue, uiLength, &oPrintBuffer);
+    m_strJson.resize(oPrintBuffer.length);
+    return(iResult != 0);
+}
+
+}
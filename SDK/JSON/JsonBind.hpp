@@ -0,0 +1,321 @@
+/*******************************************************************************
+ * Project:  neb
+ * @file     JsonBind.hpp
+ * @brief    compile-time binding between C++ structs and json text
+ * @note     Members are bound to keys once, at global scope:
+ *
+ *               NEB_JSON_BIND_BEGIN(Order)
+ *                   NEB_JSON_FIELD(id)
+ *                   NEB_JSON_FIELD_AS(price, "unit_price")
+ *                   NEB_JSON_FIELD(items)
+ *               NEB_JSON_BIND_END()
+ *
+ *           after which neb::FromJson() parses text straight into an Order
+ *           and neb::ToJson() writes one out, neither building a cJSON tree.
+ *           Bound members may be bool, the int32/uint32/int64/uint64 types,
+ *           float, double, std::string, CJsonObject, std::vector of any of
+ *           these, or another bound struct.
+ * Modify history:
+ ******************************************************************************/
+
+#ifndef JSONBIND_HPP_
+#define JSONBIND_HPP_
+
+#include <string.h>
+#include <string>
+#include <vector>
+#include "CJsonObject.hpp"
+
+namespace neb
+{
+
+/**
+ * @brief specialised by NEB_JSON_BIND_BEGIN for every bound struct; Visit()
+ *        calls oVisitor(key, member) for each field in declaration order and
+ *        stops as soon as a call returns false
+ */
+template<class T> struct CJsonBind;
+
+#define NEB_JSON_BIND_BEGIN(Type) \
+    namespace neb { \
+    template<> struct CJsonBind<Type> \
+    { \
+        template<class T, class V> static bool Visit(T& oValue, V& oVisitor) \
+        { \
+            return(true
+
+#define NEB_JSON_FIELD_AS(member, key) \
+            && oVisitor(key, oValue.member)
+
+#define NEB_JSON_FIELD(member) NEB_JSON_FIELD_AS(member, #member)
+
+#define NEB_JSON_BIND_END() \
+            ); \
+        } \
+    }; \
+    }
+
+/**
+ * @brief pull parser that reads json text directly into bound structs
+ * @note  keys match ignoring case, as CJsonObject lookups do, unless
+ *        SetCaseSensitive(true); unknown keys are skipped and null leaves the
+ *        target untouched; numbers convert between integer and floating types
+ *        as CJsonObject::Get() does.
+ *        Errors name the offending field, e.g. "$.items[3].price: expected
+ *        number at offset 57".
+ */
+class CJsonReader
+{
+public:
+    explicit CJsonReader(const char* szJson);
+    void SetCaseSensitive(bool bCaseSensitive);     // match keys exactly instead of ignoring case
+
+    bool Read(bool& bValue);
+    bool Read(int32& iValue);
+    bool Read(uint32& uiValue);
+    bool Read(int64& llValue);
+    bool Read(uint64& ullValue);
+    bool Read(float& fValue);
+    bool Read(double& dValue);
+    bool Read(std::string& strValue);
+    bool Read(CJsonObject& oJsonObject);
+    template<class T> bool Read(std::vector<T>& vecValue);
+    template<class T> bool Read(T& oValue);
+
+    bool Finish();                      // only whitespace may follow the value
+    const std::string& GetErrMsg() const
+    {
+        return(m_strErrMsg);
+    }
+
+private:
+    class CFieldReader
+    {
+    public:
+        explicit CFieldReader(CJsonReader& oReader) : m_oReader(oReader), m_iResult(0)
+        {
+        }
+        template<class T> bool operator()(const char* szKey, T& oMember)
+        {
+            if (!m_oReader.KeyEquals(szKey))
+            {
+                return(true);
+            }
+            m_iResult = m_oReader.Read(oMember) ? 1 : -1;
+            return(false);
+        }
+
+        CJsonReader& m_oReader;
+        int m_iResult;                  // 0 no field has this key, 1 read, -1 failed
+    };
+
+    bool KeyEquals(const char* szKey) const;
+    void SkipSpace();
+    bool ReadNull();
+    bool ReadNumber(cJSON& oNumber);
+    bool NextMember(bool& bMore, bool bFirst);
+    bool NextElement(bool& bMore, bool bFirst);
+    void PushIndex(size_t uiIndex);
+    template<class T> bool ReadElement(std::vector<T>& vecValue);
+    bool ReadElement(std::vector<bool>& vecValue);
+    bool SkipValue();
+    bool Fail(const char* szExpected);
+
+private:
+    const char* m_szJson;
+    const char* m_szCursor;
+    bool m_bCaseSensitive;
+    std::string m_strKey;               // key of the member being dispatched
+    std::string m_strPath;              // "$" followed by the keys and indexes entered
+    std::string m_strErrMsg;
+};
+
+/**
+ * @brief appends bound structs to a string as compact json, byte for byte what
+ *        CJsonObject::ToString() prints for the same data
+ */
+class CJsonWriter
+{
+public:
+    explicit CJsonWriter(std::string& strJson);
+
+    bool Write(bool bValue);
+    bool Write(int32 iValue);
+    bool Write(uint32 uiValue);
+    bool Write(int64 llValue);
+    bool Write(uint64 ullValue);
+    bool Write(float fValue);
+    bool Write(double dValue);
+    bool Write(const char* szValue);
+    bool Write(const std::string& strValue);
+    bool Write(const CJsonObject& oJsonObject);
+    template<class T> bool Write(const std::vector<T>& vecValue);
+    template<class T> bool Write(const T& oValue);
+
+private:
+    class CFieldWriter
+    {
+    public:
+        explicit CFieldWriter(CJsonWriter& oWriter) : m_oWriter(oWriter), m_bFirst(true)
+        {
+        }
+        template<class T> bool operator()(const char* szKey, T& oMember)
+        {
+            if (!m_bFirst)
+            {
+                m_oWriter.m_strJson += ',';
+            }
+            m_bFirst = false;
+            if (!m_oWriter.WriteString(szKey, strlen(szKey)))
+            {
+                return(false);
+            }
+            m_oWriter.m_strJson += ':';
+            return(m_oWriter.Write(oMember));
+        }
+
+        CJsonWriter& m_oWriter;
+        bool m_bFirst;
+    };
+
+    bool WriteString(const char* szValue, size_t uiLength);
+
+private:
+    std::string& m_strJson;
+};
+
+/**
+ * @brief parse strJson into oValue; on failure strErrMsg says which field was wrong
+ */
+template<class T>
+bool FromJson(const std::string& strJson, T& oValue, std::string& strErrMsg, bool bCaseSensitive = false)
+{
+    CJsonReader oReader(strJson.c_str());
+    oReader.SetCaseSensitive(bCaseSensitive);
+    if (oReader.Read(oValue) && oReader.Finish())
+    {
+        return(true);
+    }
+    strErrMsg = oReader.GetErrMsg();
+    return(false);
+}
+
+/**
+ * @brief replace strJson with the compact json of oValue, reusing its capacity
+ */
+template<class T>
+bool ToJson(const T& oValue, std::string& strJson)
+{
+    strJson.clear();
+    CJsonWriter oWriter(strJson);
+    return(oWriter.Write(oValue));
+}
+
+template<class T>
+bool CJsonReader::Read(std::vector<T>& vecValue)
+{
+    if (ReadNull())
+    {
+        return(true);
+    }
+    SkipSpace();
+    if (*m_szCursor != '[')
+    {
+        return(Fail("expected array"));
+    }
+    ++m_szCursor;
+    vecValue.clear();
+    size_t uiPathSize = m_strPath.size();
+    bool bMore = false;
+    for (bool bFirst = true; NextElement(bMore, bFirst); bFirst = false)
+    {
+        if (!bMore)
+        {
+            return(true);
+        }
+        PushIndex(vecValue.size());
+        if (!ReadElement(vecValue))
+        {
+            return(false);
+        }
+        m_strPath.resize(uiPathSize);
+    }
+    return(false);
+}
+
+template<class T>
+bool CJsonReader::Read(T& oValue)
+{
+    if (ReadNull())
+    {
+        return(true);
+    }
+    SkipSpace();
+    if (*m_szCursor != '{')
+    {
+        return(Fail("expected object"));
+    }
+    ++m_szCursor;
+    size_t uiPathSize = m_strPath.size();
+    bool bMore = false;
+    for (bool bFirst = true; NextMember(bMore, bFirst); bFirst = false)
+    {
+        if (!bMore)
+        {
+            return(true);
+        }
+        m_strPath += '.';
+        m_strPath += m_strKey;
+        CFieldReader oFieldReader(*this);
+        CJsonBind<T>::Visit(oValue, oFieldReader);
+        if (oFieldReader.m_iResult < 0 || (oFieldReader.m_iResult == 0 && !SkipValue()))
+        {
+            return(false);
+        }
+        m_strPath.resize(uiPathSize);
+    }
+    return(false);
+}
+
+template<class T>
+bool CJsonReader::ReadElement(std::vector<T>& vecValue)
+{
+    vecValue.resize(vecValue.size() + 1);
+    return(Read(vecValue.back()));
+}
+
+template<class T>
+bool CJsonWriter::Write(const std::vector<T>& vecValue)
+{
+    m_strJson += '[';
+    for (size_t i = 0; i < vecValue.size(); ++i)
+    {
+        if (i > 0)
+        {
+            m_strJson += ',';
+        }
+        if (!Write(vecValue[i]))
+        {
+            return(false);
+        }
+    }
+    m_strJson += ']';
+    return(true);
+}
+
+template<class T>
+bool CJsonWriter::Write(const T& oValue)
+{
+    CFieldWriter oFieldWriter(*this);
+    m_strJson += '{';
+    if (!CJsonBind<T>::Visit(oValue, oFieldWriter))
+    {
+        return(false);
+    }
+    m_strJson += '}';
+    return(true);
+}
+
+}
+
+#endif /* JSONBIND_HPP_ */
@@ -27,8 +27,28 @@
 #include <float.h>
 #include <limits.h>
 #include <ctype.h>
+#include <locale.h>
 #include "cJSON.h"
 
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define CJSON_SIMD 1
+#include <emmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#else
+#define CJSON_SIMD 0
+#endif
+
+/* The string scanner reads whole aligned 16-byte blocks around the terminator, which never crosses a page. */
+#if defined(__clang__) || defined(__GNUC__)
+#define CJSON_NO_SANITIZE_ADDRESS __attribute__((no_sanitize_address))
+#elif defined(_MSC_VER) && defined(__SANITIZE_ADDRESS__)
+#define CJSON_NO_SANITIZE_ADDRESS __declspec(no_sanitize_address)
+#else
+#define CJSON_NO_SANITIZE_ADDRESS
+#endif
+
 #ifndef INT_MAX
 #define INT_MAX 2147483647
 #define INT_MIN (-INT_MAX - 1)
@@ -48,7 +68,7 @@ static int cJSON_strcasecmp(const char* s1, const char* s2)
         return (s1 == s2) ? 0 : 1;
     if (!s2)
         return 1;
-    for (; tolower(*s1) == tolower(*s2); ++s1, ++s2)
+    for (; *s1 == *s2 || tolower(*s1) == tolower(*s2); ++s1, ++s2) /* keys mostly match byte for byte */
         if (*s1 == 0)
             return 0;
     return tolower(*(const unsigned char*)s1)
@@ -83,16 +103,224 @@ void cJSON_InitHooks(cJSON_Hooks* hooks)
     cJSON_free = (hooks->free_fn) ? hooks->free_fn : free;
 }
 
+#define CJSON_ARENA_DEFAULT_BLOCK 16384
+#define CJSON_ARENA_ALIGN 8
+
+typedef struct cJSON_ArenaBlock
+{
+    struct cJSON_ArenaBlock* next;
+    size_t size; /* usable bytes after the header */
+    size_t used;
+} cJSON_ArenaBlock;
+
+struct cJSON_Arena
+{
+    cJSON_ArenaBlock* head; /* block currently being carved, newest first */
+    size_t block_size;
+};
+
+/* Keep the block payload aligned for cJSON nodes. */
+#define CJSON_ARENA_HEADER ((sizeof(cJSON_ArenaBlock) + CJSON_ARENA_ALIGN - 1) & ~(size_t)(CJSON_ARENA_ALIGN - 1))
+
+static cJSON_ArenaBlock* cJSON_ArenaNewBlock(size_t size)
+{
+    cJSON_ArenaBlock* block = (cJSON_ArenaBlock*)cJSON_malloc(CJSON_ARENA_HEADER + size);
+    if (block)
+    {
+        block->next = 0;
+        block->size = size;
+        block->used = 0;
+    }
+    return block;
+}
+
+cJSON_Arena* cJSON_CreateArena(size_t block_size)
+{
+    cJSON_Arena* arena = (cJSON_Arena*)cJSON_malloc(sizeof(cJSON_Arena));
+    if (!arena)
+        return 0;
+    arena->head = 0;
+    arena->block_size = block_size ? block_size : CJSON_ARENA_DEFAULT_BLOCK;
+    return arena;
+}
+
+static void* cJSON_ArenaAlloc(cJSON_Arena* arena, size_t sz)
+{
+    cJSON_ArenaBlock* block = arena->head;
+    sz = (sz + CJSON_ARENA_ALIGN - 1) & ~(size_t)(CJSON_ARENA_ALIGN - 1);
+    if (!block || block->size - block->used < sz)
+    {
+        block = cJSON_ArenaNewBlock(sz > arena->block_size ? sz : arena->block_size);
+        if (!block)
+            return 0;
+        block->next = arena->head;
+        arena->head = block;
+    }
+    block->used += sz;
+    return (char*)block + CJSON_ARENA_HEADER + block->used - sz;
+}
+
+void cJSON_ResetArena(cJSON_Arena* arena)
+{
+    cJSON_ArenaBlock* block, * next;
+    size_t total = 0;
+    if (!arena || !arena->head)
+        return;
+    if (!arena->head->next)
+    {
+        arena->head->used = 0;
+        return;
+    }
+    /* The last document needed several blocks: replace them with one block large enough for all of them. */
+    for (block = arena->head; block; block = next)
+    {
+        next = block->next;
+        total += block->size;
+        cJSON_free(block);
+    }
+    arena->head = cJSON_ArenaNewBlock(total);
+    if (total > arena->block_size)
+        arena->block_size = total;
+}
+
+void cJSON_DeleteArena(cJSON_Arena* arena)
+{
+    cJSON_ArenaBlock* block, * next;
+    if (!arena)
+        return;
+    for (block = arena->head; block; block = next)
+    {
+        next = block->next;
+        cJSON_free(block);
+    }
+    cJSON_free(arena);
+}
+
+/* Arena the current thread is parsing into, if any. */
+static thread_local cJSON_Arena* parse_arena = 0;
+
+static void* cJSON_parse_malloc(size_t sz)
+{
+    return parse_arena ? cJSON_ArenaAlloc(parse_arena, sz) : cJSON_malloc(sz);
+}
+
 /* Internal constructor. */
 static cJSON* cJSON_New_Item()
 {
-    cJSON* node = (cJSON*)cJSON_malloc(sizeof(cJSON));
+    cJSON* node = (cJSON*)cJSON_parse_malloc(sizeof(cJSON));
     if (node)
+    {
         memset(node, 0, sizeof(cJSON));
+        node->in_arena = parse_arena != 0;
+    }
     return node;
 }
 
-/* Delete a cJSON structure. */
+/* Objects with at least this many members get a hash index for cJSON_GetObjectItem. The index is built when the
+   object is parsed or grows to that size and kept up to date by the calls that change the object, so lookups only
+   read it. */
+#define CJSON_INDEX_MIN_ITEMS 16
+
+/* Open addressing with linear probing. Members are inserted in list order and never removed (the index is rebuilt
+   instead), so for equal keys the probe sequence meets the earlier member first, like the linear scan does. */
+typedef struct cJSON_Index
+{
+    unsigned int mask; /* capacity - 1, capacity is a power of two */
+    unsigned int count;
+    cJSON* slots[1];
+} cJSON_Index;
+
+static unsigned int cJSON_hash_key(const char* str)
+{
+    unsigned int hash = 2166136261u;
+    for (; *str; ++str)
+        hash = (hash ^ (unsigned char)tolower(*(const unsigned char*)str)) * 16777619u;
+    return hash;
+}
+
+static void cJSON_index_insert(cJSON_Index* index, cJSON* item)
+{
+    unsigned int i = cJSON_hash_key(item->string) & index->mask;
+    while (index->slots[i])
+        i = (i + 1) & index->mask;
+    index->slots[i] = item;
+    index->count++;
+}
+
+/* The index of an arena object is carved from the same arena, so it can only be built while parsing. */
+static cJSON_Index* cJSON_index_build(cJSON* object)
+{
+    cJSON* c;
+    cJSON_Index* index;
+    unsigned int count = 0, capacity = 32;
+    if (object->in_arena != (parse_arena != 0))
+        return 0;
+    for (c = object->child; c; c = c->next)
+        count++;
+    while (capacity < count * 2)
+        capacity <<= 1;
+    index = (cJSON_Index*)cJSON_parse_malloc(sizeof(cJSON_Index) + (capacity - 1) * sizeof(cJSON*));
+    if (!index)
+        return 0;
+    memset(index->slots, 0, capacity * sizeof(cJSON*));
+    index->mask = capacity - 1;
+    index->count = 0;
+    for (c = object->child; c; c = c->next)
+        if (c->string)
+            cJSON_index_insert(index, c);
+    return index;
+}
+
+/* Rebuild the index after a mutation it cannot follow. The index of an arena object is dropped instead and later
+   lookups scan the members. */
+static void cJSON_index_rebuild(cJSON* object)
+{
+    cJSON_Index* index = object->index;
+    if (!index)
+        return;
+    object->index = 0;
+    if (object->in_arena)
+        return;
+    if (cJSON_GetArraySize(object) >= CJSON_INDEX_MIN_ITEMS)
+        object->index = cJSON_index_build(object);
+    cJSON_free(index);
+}
+
+/* Keep the index in step with an item appended to the end of the object; count is the new number of members. */
+static void cJSON_index_append(cJSON* object, cJSON* item, int count)
+{
+    if (!object->index)
+    {
+        if (object->type == cJSON_Object && count >= CJSON_INDEX_MIN_ITEMS)
+            object->index = cJSON_index_build(object);
+    }
+    else if (!item->string || (object->index->count + 1) * 2 > object->index->mask + 1)
+        cJSON_index_rebuild(object);
+    else
+        cJSON_index_insert(object->index, item);
+}
+
+/* Keep the index in step with newitem taking the place of c. */
+static void cJSON_index_replace(cJSON* object, cJSON* c, cJSON* newitem)
+{
+    cJSON_Index* index = object->index;
+    unsigned int i;
+    if (!index)
+        return;
+    if (!c->string || !newitem->string || cJSON_hash_key(c->string) != cJSON_hash_key(newitem->string))
+    {
+        cJSON_index_rebuild(object);
+        return;
+    }
+    for (i = cJSON_hash_key(c->string) & index->mask; index->slots[i] && index->slots[i] != c; i = (i + 1) & index->mask)
+        ;
+    if (index->slots[i])
+        index->slots[i] = newitem;
+    else
+        cJSON_index_rebuild(object);
+}
+
+/* Delete a cJSON structure. The memory of arena items stays with the arena; heap items attached to them are freed. */
 void cJSON_Delete(cJSON* c)
 {
     cJSON* next;
@@ -101,335 +329,1203 @@ void cJSON_Delete(cJSON* c)
         next = c->next;
         if (!(c->type & cJSON_IsReference) && c->child)
             cJSON_Delete(c->child);
-        if (!(c->type & cJSON_IsReference) && c->valuestring)
-            cJSON_free(c->valuestring);
-        if (c->string)
-            cJSON_free(c->string);
-        cJSON_free(c);
+        if (!c->in_arena)
+        {
+            if (c->index)
+                cJSON_free(c->index);
+            if (!(c->type & cJSON_IsReference) && c->valuestring)
+                cJSON_free(c->valuestring);
+            if (c->string)
+                cJSON_free(c->string);
+            cJSON_free(c);
+        }
         c = next;
     }
 }
 
-/* Parse the input text to generate a number, and populate the result into item. */
+/* Parse the input text to generate a number, and populate the result into item.
+   Integers are accumulated exactly in 64 bits; doubles take the exact fast path when the significand and the
+   power of ten are both exactly representable, otherwise the correctly rounded strtod in any locale. */
+static const double cJSON_exact_pow10[] =
+{
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+/* strtod expects the decimal point of the current C locale: hand it a copy of [start, end) using that point. */
+static double cJSON_strtod(const char* start, const char* end)
+{
+    char local[64];
+    char point = localeconv()->decimal_point[0];
+    size_t length = end - start;
+    char *buffer, *dot;
+    double d;
+    if (point == '.')
+        return strtod(start, 0);
+    buffer = length < sizeof(local) ? local : (char*)cJSON_malloc(length + 1);
+    if (!buffer)
+        return strtod(start, 0);
+    memcpy(buffer, start, length);
+    buffer[length] = 0;
+    dot = (char*)memchr(buffer, '.', length);
+    if (dot)
+        *dot = point;
+    d = strtod(buffer, 0);
+    if (buffer != local)
+        cJSON_free(buffer);
+    return d;
+}
+
 static const char* parse_number(cJSON* item, const char* num)
 {
-    long double n = 0, scale = 0;
-    int subscale = 0, signsubscale = 1;
+    const char* start = num;
+    uint64 n = 0;
+    int overflow = 0, scale = 0, subscale = 0, signsubscale = 1, is_double = 0;
     item->sign = 1;
 
-    /* Could use sscanf for this? */
     if (*num == '-')
         item->sign = -1, num++; /* Has sign? */
     if (*num == '0')
         num++; /* is zero */
-    if (*num >= '1' && *num <= '9')
+    else if (*num >= '1' && *num <= '9')
         do
-            n = (n * 10.0) + (*num++ - '0');
-    while (*num >= '0' && *num <= '9'); /* Number? */
+        {
+            unsigned int d = *num++ - '0';
+            if (n > (0xFFFFFFFFFFFFFFFFULL - d) / 10)
+                overflow = 1;
+            else
+                n = n * 10 + d;
+        } while (*num >= '0' && *num <= '9'); /* Number? */
     if (*num == '.' && num[1] >= '0' && num[1] <= '9')
     {
         num++;
+        is_double = 1;
         do
-            n = (n * 10.0) + (*num++ - '0'), scale--;
-        while (*num >= '0' && *num <= '9');
+        {
+            unsigned int d = *num++ - '0';
+            if (!overflow && n <= (0xFFFFFFFFFFFFFFFFULL - d) / 10)
+                n = n * 10 + d, scale--;
+            else
+                overflow = 1;
+        } while (*num >= '0' && *num <= '9');
     } /* Fractional part? */
     if (*num == 'e' || *num == 'E') /* Exponent? */
     {
         num++;
+        is_double = 1;
         if (*num == '+')
             num++;
         else if (*num == '-')
             signsubscale = -1, num++; /* With sign? */
         while (*num >= '0' && *num <= '9')
-            subscale = (subscale * 10) + (*num++ - '0'); /* Number? */
+        {
+            if (subscale < 100000)
+                subscale = (subscale * 10) + (*num - '0'); /* Number? */
+            num++;
+        }
     }
 
-    if (scale == 0 && subscale == 0)
+    /* A negative integer below -2^63 does not fit either: it is read as a double, like a positive one above 2^64 - 1. */
+    if (!is_double && !overflow && (item->sign == 1 || n <= 0x8000000000000000ULL))
     {
-        item->valuedouble = (double)(item->sign * n);
-        item->valueint = (uint64)(item->sign * (uint64)n);
+        item->valuedouble = item->sign == -1 ? -(double)n : (double)n;
+        item->valueint = item->sign == -1 ? 0 - n : n;
         item->type = cJSON_Int;
+        return num;
+    }
+
+    scale += subscale * signsubscale;
+    if (!overflow && n <= (1ULL << 53) && scale >= -22 && scale <= 22)
+    {
+        double d = (double)n;
+        d = scale < 0 ? d / cJSON_exact_pow10[-scale] : d * cJSON_exact_pow10[scale];
+        item->valuedouble = item->sign == -1 ? -d : d;
+    }
+    else
+        item->valuedouble = cJSON_strtod(start, num);
+    if (item->valuedouble >= 0 && item->valuedouble < 18446744073709551616.0)
+        item->valueint = (uint64)item->valuedouble;
+    else if (item->valuedouble < 0 && item->valuedouble >= -9223372036854775808.0)
+        item->valueint = (uint64)(int64)item->valuedouble;
+    else
+        item->valueint = 0;
+    item->type = cJSON_Double;
+    return num;
+}
+
+const char* cJSON_ParseNumber(cJSON* item, const char* value)
+{
+    if (!value || !(*value == '-' || (*value >= '0' && *value <= '9')))
+        return 0;
+    return parse_number(item, value);
+}
+
+/* Make room for at least needed more bytes plus the terminating 0. */
+static char* ensure(cJSON_PrintBuffer* p, size_t needed)
+{
+    size_t required = p->length + needed + 1;
+    if (required > p->size)
+    {
+        if (p->grow_fn)
+        {
+            if (!p->grow_fn(p, required))
+                return 0;
+        }
+        else
+        {
+            size_t newsize = p->size ? p->size * 2 : 256;
+            char* newbuffer;
+            while (newsize < required)
+                newsize *= 2;
+            newbuffer = (char*)cJSON_malloc(newsize);
+            if (!newbuffer)
+                return 0;
+            if (p->buffer)
+            {
+                memcpy(newbuffer, p->buffer, p->length);
+                cJSON_free(p->buffer);
+            }
+            p->buffer = newbuffer;
+            p->size = newsize;
+        }
+    }
+    return p->buffer + p->length;
+}
+
+static int print_raw(cJSON_PrintBuffer* p, const char* str, size_t len)
+{
+    char* out = ensure(p, len);
+    if (!out)
+        return 0;
+    memcpy(out, str, len);
+    p->length += len;
+    return 1;
+}
+
+static const char cJSON_digit_pairs[201] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+/* Write the decimal digits of n ending at end, two at a time; returns the first digit. */
+static char* cJSON_u64toa(uint64 n, char* end)
+{
+    while (n >= 100)
+    {
+        const char* pair = cJSON_digit_pairs + (n % 100) * 2;
+        n /= 100;
+        *--end = pair[1];
+        *--end = pair[0];
+    }
+    if (n >= 10)
+    {
+        *--end = cJSON_digit_pairs[n * 2 + 1];
+        *--end = cJSON_digit_pairs[n * 2];
+    }
+    else
+        *--end = (char)('0' + n);
+    return end;
+}
+
+/* Grisu2 shortest round-trip double to digits (Florian Loitsch, "Printing Floating-Point Numbers Quickly and
+   Accurately with Integers"). A diy_fp is f * 2^e with a 64-bit significand. */
+typedef struct
+{
+    uint64 f;
+    int e;
+} cJSON_diy_fp;
+
+/* 10^k for k = -348, -340, ..., 340, normalized. */
+static const cJSON_diy_fp cJSON_cached_powers[] =
+{
+    { 0xfa8fd5a0081c0288ULL, -1220 }, { 0xbaaee17fa23ebf76ULL, -1193 }, { 0x8b16fb203055ac76ULL, -1166 }, { 0xcf42894a5dce35eaULL, -1140 },
+    { 0x9a6bb0aa55653b2dULL, -1113 }, { 0xe61acf033d1a45dfULL, -1087 }, { 0xab70fe17c79ac6caULL, -1060 }, { 0xff77b1fcbebcdc4fULL, -1034 },
+    { 0xbe5691ef416bd60cULL, -1007 }, { 0x8dd01fad907ffc3cULL, -980 }, { 0xd3515c2831559a83ULL, -954 }, { 0x9d71ac8fada6c9b5ULL, -927 },
+    { 0xea9c227723ee8bcbULL, -901 }, { 0xaecc49914078536dULL, -874 }, { 0x823c12795db6ce57ULL, -847 }, { 0xc21094364dfb5637ULL, -821 },
+    { 0x9096ea6f3848984fULL, -794 }, { 0xd77485cb25823ac7ULL, -768 }, { 0xa086cfcd97bf97f4ULL, -741 }, { 0xef340a98172aace5ULL, -715 },
+    { 0xb23867fb2a35b28eULL, -688 }, { 0x84c8d4dfd2c63f3bULL, -661 }, { 0xc5dd44271ad3cdbaULL, -635 }, { 0x936b9fcebb25c996ULL, -608 },
+    { 0xdbac6c247d62a584ULL, -582 }, { 0xa3ab66580d5fdaf6ULL, -555 }, { 0xf3e2f893dec3f126ULL, -529 }, { 0xb5b5ada8aaff80b8ULL, -502 },
+    { 0x87625f056c7c4a8bULL, -475 }, { 0xc9bcff6034c13053ULL, -449 }, { 0x964e858c91ba2655ULL, -422 }, { 0xdff9772470297ebdULL, -396 },
+    { 0xa6dfbd9fb8e5b88fULL, -369 }, { 0xf8a95fcf88747d94ULL, -343 }, { 0xb94470938fa89bcfULL, -316 }, { 0x8a08f0f8bf0f156bULL, -289 },
+    { 0xcdb02555653131b6ULL, -263 }, { 0x993fe2c6d07b7facULL, -236 }, { 0xe45c10c42a2b3b06ULL, -210 }, { 0xaa242499697392d3ULL, -183 },
+    { 0xfd87b5f28300ca0eULL, -157 }, { 0xbce5086492111aebULL, -130 }, { 0x8cbccc096f5088ccULL, -103 }, { 0xd1b71758e219652cULL, -77 },
+    { 0x9c40000000000000ULL, -50 }, { 0xe8d4a51000000000ULL, -24 }, { 0xad78ebc5ac620000ULL, 3 }, { 0x813f3978f8940984ULL, 30 },
+    { 0xc097ce7bc90715b3ULL, 56 }, { 0x8f7e32ce7bea5c70ULL, 83 }, { 0xd5d238a4abe98068ULL, 109 }, { 0x9f4f2726179a2245ULL, 136 },
+    { 0xed63a231d4c4fb27ULL, 162 }, { 0xb0de65388cc8ada8ULL, 189 }, { 0x83c7088e1aab65dbULL, 216 }, { 0xc45d1df942711d9aULL, 242 },
+    { 0x924d692ca61be758ULL, 269 }, { 0xda01ee641a708deaULL, 295 }, { 0xa26da3999aef774aULL, 322 }, { 0xf209787bb47d6b85ULL, 348 },
+    { 0xb454e4a179dd1877ULL, 375 }, { 0x865b86925b9bc5c2ULL, 402 }, { 0xc83553c5c8965d3dULL, 428 }, { 0x952ab45cfa97a0b3ULL, 455 },
+    { 0xde469fbd99a05fe3ULL, 481 }, { 0xa59bc234db398c25ULL, 508 }, { 0xf6c69a72a3989f5cULL, 534 }, { 0xb7dcbf5354e9beceULL, 561 },
+    { 0x88fcf317f22241e2ULL, 588 }, { 0xcc20ce9bd35c78a5ULL, 614 }, { 0x98165af37b2153dfULL, 641 }, { 0xe2a0b5dc971f303aULL, 667 },
+    { 0xa8d9d1535ce3b396ULL, 694 }, { 0xfb9b7cd9a4a7443cULL, 720 }, { 0xbb764c4ca7a44410ULL, 747 }, { 0x8bab8eefb6409c1aULL, 774 },
+    { 0xd01fef10a657842cULL, 800 }, { 0x9b10a4e5e9913129ULL, 827 }, { 0xe7109bfba19c0c9dULL, 853 }, { 0xac2820d9623bf429ULL, 880 },
+    { 0x80444b5e7aa7cf85ULL, 907 }, { 0xbf21e44003acdd2dULL, 933 }, { 0x8e679c2f5e44ff8fULL, 960 }, { 0xd433179d9c8cb841ULL, 986 },
+    { 0x9e19db92b4e31ba9ULL, 1013 }, { 0xeb96bf6ebadf77d9ULL, 1039 }, { 0xaf87023b9bf0ee6bULL, 1066 },
+};
+
+static cJSON_diy_fp cJSON_diy_mul(cJSON_diy_fp x, cJSON_diy_fp y)
+{
+    const uint64 M32 = 0xFFFFFFFFULL;
+    uint64 a = x.f >> 32, b = x.f & M32, c = y.f >> 32, d = y.f & M32;
+    uint64 ac = a * c, bc = b * c, ad = a * d, bd = b * d;
+    uint64 tmp = (bd >> 32) + (ad & M32) + (bc & M32) + (1ULL << 31); /* round */
+    cJSON_diy_fp r;
+    r.f = ac + (ad >> 32) + (bc >> 32) + (tmp >> 32);
+    r.e = x.e + y.e + 64;
+    return r;
+}
+
+static cJSON_diy_fp cJSON_diy_normalize(cJSON_diy_fp x)
+{
+    while (!(x.f & 0x8000000000000000ULL))
+        x.f <<= 1, x.e--;
+    return x;
+}
+
+static void cJSON_grisu_round(char* buffer, int len, uint64 delta, uint64 rest, uint64 ten_kappa, uint64 wp_w)
+{
+    while (rest < wp_w && delta - rest >= ten_kappa
+        && (rest + ten_kappa < wp_w || wp_w - rest > rest + ten_kappa - wp_w))
+    {
+        buffer[len - 1]--;
+        rest += ten_kappa;
+    }
+}
+
+/* Writes the shortest digit string d with v == d * 10^k (within rounding) and returns its length; v > 0. */
+static int cJSON_grisu2(double value, char* buffer, int* k)
+{
+    static const unsigned int pow10[] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000 };
+    cJSON_diy_fp v, w, wp, wm, c, one;
+    uint64 bits, delta, wp_w, p2;
+    unsigned int p1;
+    int biased, mk, index, kappa, len = 0;
+    double dk;
+
+    memcpy(&bits, &value, sizeof(bits));
+    biased = (int)((bits >> 52) & 0x7FF);
+    v.f = bits & 0x000FFFFFFFFFFFFFULL;
+    if (biased)
+        v.f += 0x0010000000000000ULL, v.e = biased - 1075;
+    else
+        v.e = -1074;
+
+    /* Boundaries m- and m+ of the rounding interval, with a common exponent. */
+    wp.f = (v.f << 1) + 1, wp.e = v.e - 1;
+    while (!(wp.f & (0x0010000000000000ULL << 1)))
+        wp.f <<= 1, wp.e--;
+    wp.f <<= 10, wp.e -= 10;
+    if (v.f == 0x0010000000000000ULL)
+        wm.f = (v.f << 2) - 1, wm.e = v.e - 2;
+    else
+        wm.f = (v.f << 1) - 1, wm.e = v.e - 1;
+    wm.f <<= wm.e - wp.e, wm.e = wp.e;
+
+    /* Pick a cached power bringing the product exponent into [-60, -32]. */
+    dk = (-61 - wp.e) * 0.30102999566398114 + 347;
+    mk = (int)dk;
+    if (dk - mk > 0.0)
+        mk++;
+    index = (mk >> 3) + 1;
+    *k = -(-348 + (index << 3));
+    c = cJSON_cached_powers[index];
+
+    w = cJSON_diy_mul(cJSON_diy_normalize(v), c);
+    wp = cJSON_diy_mul(wp, c);
+    wm = cJSON_diy_mul(wm, c);
+    wm.f++;
+    wp.f--;
+
+    /* Generate digits of wp until inside the unsafe interval. */
+    delta = wp.f - wm.f;
+    wp_w = wp.f - w.f;
+    one.e = wp.e;
+    one.f = 1ULL << -one.e;
+    p1 = (unsigned int)(wp.f >> -one.e);
+    p2 = wp.f & (one.f - 1);
+    kappa = 10;
+    while (kappa > 1 && p1 < pow10[kappa - 1])
+        kappa--;
+    while (kappa > 0)
+    {
+        unsigned int d = p1 / pow10[kappa - 1];
+        uint64 rest;
+        p1 %= pow10[kappa - 1];
+        kappa--;
+        if (d || len)
+            buffer[len++] = (char)('0' + d);
+        rest = ((uint64)p1 << -one.e) + p2;
+        if (rest <= delta)
+        {
+            *k += kappa;
+            cJSON_grisu_round(buffer, len, delta, rest, (uint64)pow10[kappa] << -one.e, wp_w);
+            return len;
+        }
+    }
+    for (;;)
+    {
+        unsigned int d;
+        p2 *= 10;
+        delta *= 10;
+        d = (unsigned int)(p2 >> -one.e);
+        if (d || len)
+            buffer[len++] = (char)('0' + d);
+        p2 &= one.f - 1;
+        kappa--;
+        if (p2 < delta)
+        {
+            *k += kappa;
+            cJSON_grisu_round(buffer, len, delta, p2, one.f, -kappa < 10 ? wp_w * pow10[-kappa] : 0);
+            return len;
+        }
+    }
+}
+
+/* Render the number nicely from the given item into a string. Doubles print the shortest text that parses back
+   to the same value and always carry a fraction or exponent so they read back as cJSON_Double. */
+static char* format_double(double d, char* out)
+{
+    char digits[24];
+    int len, k, kk, i;
+
+    if (d != d || d - d != 0)
+    {
+        memcpy(out, "null", 4); /* NaN and infinity have no JSON form */
+        return out + 4;
+    }
+    if (signbit(d))
+        *out++ = '-', d = -d;
+    if (d == 0)
+    {
+        memcpy(out, "0.0", 3);
+        return out + 3;
+    }
+
+    len = cJSON_grisu2(d, digits, &k);
+    kk = len + k; /* 10^(kk-1) <= v < 10^kk */
+    if (k >= 0 && kk <= 21)
+    {
+        /* 1234e2 -> 123400.0 */
+        memcpy(out, digits, len);
+        memset(out + len, '0', k);
+        out += kk;
+        *out++ = '.', *out++ = '0';
+    }
+    else if (kk > 0 && kk <= 21)
+    {
+        /* 1234e-2 -> 12.34 */
+        memcpy(out, digits, kk);
+        out[kk] = '.';
+        memcpy(out + kk + 1, digits + kk, len - kk);
+        out += len + 1;
+    }
+    else if (kk > -6 && kk <= 0)
+    {
+        /* 1234e-6 -> 0.001234 */
+        *out++ = '0', *out++ = '.';
+        for (i = kk; i < 0; i++)
+            *out++ = '0';
+        memcpy(out, digits, len);
+        out += len;
+    }
+    else
+    {
+        /* 1234e30 -> 1.234e33 */
+        *out++ = digits[0];
+        if (len > 1)
+        {
+            *out++ = '.';
+            memcpy(out, digits + 1, len - 1);
+            out += len - 1;
+        }
+        *out++ = 'e';
+        if (kk - 1 < 0)
+            *out++ = '-', kk = -kk + 2;
+        else
+            *out++ = '+';
+        {
+            char exp[4];
+            char* first = cJSON_u64toa((uint64)(kk - 1), exp + 4);
+            memcpy(out, first, exp + 4 - first);
+            out += exp + 4 - first;
+        }
+    }
+    return out;
+}
+
+size_t cJSON_FormatDouble(double d, char* out)
+{
+    return format_double(d, out) - out;
+}
+
+static int print_double(cJSON* item, cJSON_PrintBuffer* p)
+{
+    char* out = ensure(p, 32); /* -d.ddddddddddddddddde-308 */
+    if (!out)
+        return 0;
+    p->length = format_double(item->valuedouble, out) - p->buffer;
+    return 1;
+}
+
+static int print_int(cJSON* item, cJSON_PrintBuffer* p)
+{
+    char digits[21];
+    char* first;
+    char* out = ensure(p, 21); /* 2^64+1 can be represented in 21 chars. */
+    if (!out)
+        return 0;
+    if (item->sign == -1 && (int64)item->valueint < 0)
+    {
+        *out++ = '-';
+        first = cJSON_u64toa(0 - item->valueint, digits + sizeof(digits));
     }
     else
+        first = cJSON_u64toa(item->valueint, digits + sizeof(digits));
+    memcpy(out, first, digits + sizeof(digits) - first);
+    p->length = out + (digits + sizeof(digits) - first) - p->buffer;
+    return 1;
+}
+
+static const unsigned char firstByteMark[7] = { 0x00, 0x00, 0xC0, 0xE0, 0xF0,
+                0xF8, 0xFC };
+
+#if CJSON_SIMD
+static unsigned int cJSON_ctz(unsigned int mask)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return index;
+#else
+    return (unsigned int)__builtin_ctz(mask);
+#endif
+}
+#endif
+
+/* First '"', '\\' or terminating 0 at or after ptr. */
+static CJSON_NO_SANITIZE_ADDRESS const char* cJSON_scan_string(const char* ptr)
+{
+#if CJSON_SIMD
+    const __m128i quote = _mm_set1_epi8('\"'), backslash = _mm_set1_epi8('\\'), zero = _mm_setzero_si128();
+    const char* block = (const char*)((size_t)ptr & ~(size_t)15);
+    unsigned int mask = 0xFFFFu << (ptr - block);
+    for (;;)
+    {
+        __m128i bytes = _mm_load_si128((const __m128i*)block);
+        __m128i hit = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(bytes, quote), _mm_cmpeq_epi8(bytes, backslash)),
+            _mm_cmpeq_epi8(bytes, zero));
+        mask &= (unsigned int)_mm_movemask_epi8(hit);
+        if (mask)
+            return block + cJSON_ctz(mask);
+        block += 16;
+        mask = 0xFFFF;
+    }
+#else
+    while (*ptr && *ptr != '\"' && *ptr != '\\')
+        ptr++;
+    return ptr;
+#endif
+}
+
+/* First byte in [ptr, end) that print_string_ptr has to escape. */
+static const char* cJSON_scan_escape(const char* ptr, const char* end)
+{
+#if CJSON_SIMD
+    const __m128i quote = _mm_set1_epi8('\"'), backslash = _mm_set1_epi8('\\'), control = _mm_set1_epi8(0x1F);
+    while (end - ptr >= 16)
+    {
+        __m128i bytes = _mm_loadu_si128((const __m128i*)ptr);
+        __m128i hit = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(bytes, quote), _mm_cmpeq_epi8(bytes, backslash)),
+            _mm_cmpeq_epi8(_mm_min_epu8(bytes, control), bytes));
+        unsigned int mask = (unsigned int)_mm_movemask_epi8(hit);
+        if (mask)
+            return ptr + cJSON_ctz(mask);
+        ptr += 16;
+    }
+#endif
+    while (ptr < end && (unsigned char)*ptr > 31 && *ptr != '\"' && *ptr != '\\')
+        ptr++;
+    return ptr;
+}
+
+static int parse_hex4(const char* str, unsigned* value)
+{
+    int i;
+    *value = 0;
+    for (i = 0; i < 4; i++)
+    {
+        unsigned char c = (unsigned char)str[i];
+        if (c >= '0' && c <= '9')
+            *value = (*value << 4) | (c - '0');
+        else if ((c | 0x20) >= 'a' && (c | 0x20) <= 'f')
+            *value = (*value << 4) | ((c | 0x20) - 'a' + 10);
+        else
+            return 0;
+    }
+    return 1;
+}
+
+/* End of the string body starting at ptr (the closing quote or the terminating 0); *escaped tells whether it holds a
+   backslash. */
+static const char* scan_string_end(const char* ptr, int* escaped)
+{
+    const char* end;
+    *escaped = 0;
+    for (end = cJSON_scan_string(ptr); *end == '\\'; end = cJSON_scan_string(end))
+    {
+        *escaped = 1;
+        end += end[1] ? 2 : 1; /* Skip escaped quotes. */
+    }
+    return end;
+}
+
+/* Write the unescaped body [ptr, end) to out, which needs end - ptr bytes; returns the end of what was written.
+   Runs between escapes are copied whole. */
+static char* unescape_string(const char* ptr, const char* end, int escaped, char* out)
+{
+    const char* run;
+    char* ptr2 = out;
+    int len = 0;
+    unsigned uc, uc2;
+
+    if (!escaped)
+    {
+        memcpy(ptr2, ptr, end - ptr);
+        return ptr2 + (end - ptr);
+    }
+    while (ptr < end)
+    {
+        run = (const char*)memchr(ptr, '\\', end - ptr);
+        if (!run)
+            run = end;
+        memcpy(ptr2, ptr, run - ptr);
+        ptr2 += run - ptr;
+        ptr = run;
+        if (ptr == end)
+            break;
+
+        ptr++;
+        switch (*ptr)
+        {
+        case 'b':
+            *ptr2++ = '\b';
+            break;
+        case 'f':
+            *ptr2++ = '\f';
+            break;
+        case 'n':
+            *ptr2++ = '\n';
+            break;
+        case 'r':
+            *ptr2++ = '\r';
+            break;
+        case 't':
+            *ptr2++ = '\t';
+            break;
+        case 'u': /* transcode utf16 to utf8. */
+            if (end - ptr < 5 || !parse_hex4(ptr + 1, &uc))
+                break;	// truncated escape, keep what follows as is.
+            ptr += 4; /* get the unicode char. */
+
+            if ((uc >= 0xDC00 && uc <= 0xDFFF) || uc == 0)
+                break;	// check for invalid.
+
+            if (uc >= 0xD800 && uc <= 0xDBFF)	// UTF16 surrogate pairs.
+            {
+                if (end - ptr < 7 || ptr[1] != '\\' || ptr[2] != 'u' || !parse_hex4(ptr + 3, &uc2))
+                    break;	// missing second-half of surrogate.
+                ptr += 6;
+                if (uc2 < 0xDC00 || uc2 > 0xDFFF)
+                    break;	// invalid second-half of surrogate.
+                uc = 0x10000 | ((uc & 0x3FF) << 10) | (uc2 & 0x3FF);
+            }
+
+            len = 4;
+            if (uc < 0x80)
+                len = 1;
+            else if (uc < 0x800)
+                len = 2;
+            else if (uc < 0x10000)
+                len = 3;
+            ptr2 += len;
+
+            switch (len)
+            {
+            case 4:
+                *--ptr2 = ((uc | 0x80) & 0xBF);
+                uc >>= 6;
+            case 3:
+                *--ptr2 = ((uc | 0x80) & 0xBF);
+                uc >>= 6;
+            case 2:
+                *--ptr2 = ((uc | 0x80) & 0xBF);
+                uc >>= 6;
+            case 1:
+                *--ptr2 = (uc | firstByteMark[len]);
+            }
+            ptr2 += len;
+            break;
+        default:
+            *ptr2++ = *ptr;
+            break;
+        }
+        ptr++;
+    }
+    return ptr2;
+}
+
+/* Parse the input text into an unescaped cstring, and populate item.
+   The first pass only looks for quotes and backslashes, the second copies the body. */
+static const char* parse_string(cJSON* item, const char* str)
+{
+    const char* end;
+    char* out;
+    int escaped;
+    if (*str != '\"')
+    {
+        ep = str;
+        return 0;
+    } /* not a string! */
+
+    end = scan_string_end(str + 1, &escaped);
+    out = (char*)cJSON_parse_malloc(end - str); /* Escapes only ever shrink. */
+    if (!out)
+        return 0;
+    *unescape_string(str + 1, end, escaped, out) = 0;
+    if (*end == '\"')
+        end++;
+    item->valuestring = out;
+    item->type = cJSON_String;
+    return end;
+}
+
+const char* cJSON_ParseStringBuffered(const char* value, cJSON_PrintBuffer* p)
+{
+    const char* end;
+    char* out;
+    int escaped;
+    if (!value || *value != '\"')
+        return 0;
+    end = scan_string_end(value + 1, &escaped);
+    if (*end != '\"')
+        return 0; /* unterminated */
+    out = ensure(p, end - value - 1);
+    if (!out)
+        return 0;
+    p->length = unescape_string(value + 1, end, escaped, out) - p->buffer;
+    p->buffer[p->length] = 0;
+    return end + 1;
+}
+
+/* Render the cstring provided to an escaped version that can be printed.
+   Clean runs are copied whole; only the bytes that need escaping are handled one at a time. */
+static int print_string_len(const char* str, size_t len, cJSON_PrintBuffer* p)
+{
+    static const char hex[] = "0123456789abcdef";
+    const char* ptr = str;
+    const char* end = str + len;
+    const char* run;
+    char* ptr2;
+
+    if (!ensure(p, end - ptr + 2)) /* the common case needs no escapes */
+        return 0;
+    p->buffer[p->length++] = '\"';
+    while (ptr < end)
+    {
+        run = cJSON_scan_escape(ptr, end);
+        if (run != ptr && !print_raw(p, ptr, run - ptr))
+            return 0;
+        ptr = run;
+        if (ptr == end)
+            break;
+
+        ptr2 = ensure(p, 6);
+        if (!ptr2)
+            return 0;
+        *ptr2++ = '\\';
+        switch (*ptr)
+        {
+        case '\\':
+            *ptr2++ = '\\';
+            break;
+        case '\"':
+            *ptr2++ = '\"';
+            break;
+        case '\b':
+            *ptr2++ = 'b';
+            break;
+        case '\f':
+            *ptr2++ = 'f';
+            break;
+        case '\n':
+            *ptr2++ = 'n';
+            break;
+        case '\r':
+            *ptr2++ = 'r';
+            break;
+        case '\t':
+            *ptr2++ = 't';
+            break;
+        default:
+            *ptr2++ = 'u', *ptr2++ = '0', *ptr2++ = '0';
+            *ptr2++ = hex[(unsigned char)*ptr >> 4];
+            *ptr2++ = hex[*ptr & 15];
+            break; /* escape and print */
+        }
+        p->length = ptr2 - p->buffer;
+        ptr++;
+    }
+    return print_raw(p, "\"", 1);
+}
+
+static int print_string_ptr(const char* str, cJSON_PrintBuffer* p)
+{
+    if (!str)
+        return print_raw(p, "", 0);
+    return print_string_len(str, strlen(str), p);
+}
+
+int cJSON_PrintStringBuffered(const char* str, size_t len, cJSON_PrintBuffer* p)
+{
+    return print_string_len(str, len, p);
+}
+/* Invote print_string_ptr (which is useful) on an item. */
+static int print_string(cJSON* item, cJSON_PrintBuffer* p)
+{
+    return print_string_ptr(item->valuestring, p);
+}
+
+/* Predeclare these prototypes. */
+static const char* parse_value(cJSON* item, const char* value);
+static int print_value(cJSON* item, int depth, int fmt, cJSON_PrintBuffer* p);
+static const char* parse_array(cJSON* item, const char* value);
+static int print_array(cJSON* item, int depth, int fmt, cJSON_PrintBuffer* p);
+static const char* parse_object(cJSON* item, const char* value);
+static int print_object(cJSON* item, int depth, int fmt, cJSON_PrintBuffer* p);
+
+/* Utility to jump whitespace and cr/lf */
+static const char* skip(const char* in)
+{
+    while (in && *in && (unsigned char)*in <= 32)
+        in++;
+    return in;
+}
+
+/* Parse an object - create a new root, and populate. */
+cJSON* cJSON_Parse(const char* value)
+{
+    cJSON* c = cJSON_New_Item();
+    ep = 0;
+    if (!c)
+        return 0; /* memory fail */
+
+    if (!parse_value(c, skip(value)))
+    {
+        cJSON_Delete(c);
+        return 0;
+    }
+    return c;
+}
+
+cJSON* cJSON_ParseWithArena(const char* value, cJSON_Arena* arena)
+{
+    cJSON* c;
+    if (!arena)
+        return cJSON_Parse(value);
+    parse_arena = arena;
+    c = cJSON_New_Item();
+    ep = 0;
+    if (c && !parse_value(c, skip(value)))
+        c = 0; /* partial nodes stay in the arena until it is reset */
+    parse_arena = 0;
+    return c;
+}
+
+/* Render a cJSON item/entity/structure to text. */
+static char* print_alloc(cJSON* item, int fmt)
+{
+    cJSON_PrintBuffer p = {};
+    if (!cJSON_PrintBuffered(item, fmt, &p))
+    {
+        cJSON_FreePrintBuffer(&p);
+        return 0;
+    }
+    return p.buffer;
+}
+char* cJSON_Print(cJSON* item)
+{
+    return print_alloc(item, 1);
+}
+char* cJSON_PrintUnformatted(cJSON* item)
+{
+    return print_alloc(item, 0);
+}
+int cJSON_PrintBuffered(cJSON* item, int fmt, cJSON_PrintBuffer* pb)
+{
+    size_t start = pb->length;
+    if (!print_value(item, 0, fmt, pb) || !ensure(pb, 0))
+    {
+        pb->length = start;
+        return 0;
+    }
+    pb->buffer[pb->length] = 0;
+    return 1;
+}
+void cJSON_FreePrintBuffer(cJSON_PrintBuffer* pb)
+{
+    if (!pb->grow_fn && pb->buffer)
+        cJSON_free(pb->buffer);
+    pb->buffer = 0;
+    pb->length = pb->size = 0;
+}
+
+/* MessagePack. Integers, strings, arrays and maps use their smallest encoding; doubles are always float 64. */
+static int mp_put(cJSON_PrintBuffer* p, unsigned char tag, uint64 value, int bytes)
+{
+    char* out = ensure(p, 1 + bytes);
+    if (!out)
+        return 0;
+    *out++ = (char)tag;
+    while (bytes--)
+        *out++ = (char)(value >> (bytes * 8));
+    p->length = out - p->buffer;
+    return 1;
+}
+
+static int mp_put_length(cJSON_PrintBuffer* p, uint64 n, unsigned char fix, unsigned int fixmax,
+    unsigned char tag8, unsigned char tag16)
+{
+    if (n <= fixmax)
+        return mp_put(p, (unsigned char)(fix | n), 0, 0);
+    if (tag8 && n <= 0xFF)
+        return mp_put(p, tag8, n, 1);
+    if (n <= 0xFFFF)
+        return mp_put(p, tag16, n, 2);
+    return mp_put(p, (unsigned char)(tag16 + 1), n, 4); /* the 32-bit form always follows the 16-bit tag */
+}
+
+static int mp_put_string(cJSON_PrintBuffer* p, const char* str)
+{
+    size_t len = str ? strlen(str) : 0;
+    return mp_put_length(p, len, 0xa0, 31, 0xd9, 0xda) && print_raw(p, str ? str : "", len);
+}
+
+static int mp_print_value(cJSON* item, cJSON_PrintBuffer* p)
+{
+    cJSON* child;
+    int n = 0;
+    switch ((item->type) & 255)
+    {
+    case cJSON_NULL:
+        return mp_put(p, 0xc0, 0, 0);
+    case cJSON_False:
+        return mp_put(p, 0xc2, 0, 0);
+    case cJSON_True:
+        return mp_put(p, 0xc3, 0, 0);
+    case cJSON_Int:
+        if (item->sign == -1 && (int64)item->valueint < 0)
+        {
+            int64 v = (int64)item->valueint;
+            if (v >= -32)
+                return mp_put(p, (unsigned char)v, 0, 0);
+            if (v >= -128)
+                return mp_put(p, 0xd0, (uint64)v, 1);
+            if (v >= -32768)
+                return mp_put(p, 0xd1, (uint64)v, 2);
+            if (v >= -2147483647LL - 1)
+                return mp_put(p, 0xd2, (uint64)v, 4);
+            return mp_put(p, 0xd3, (uint64)v, 8);
+        }
+        if (item->valueint <= 0x7F)
+            return mp_put(p, (unsigned char)item->valueint, 0, 0);
+        if (item->valueint <= 0xFF)
+            return mp_put(p, 0xcc, item->valueint, 1);
+        if (item->valueint <= 0xFFFF)
+            return mp_put(p, 0xcd, item->valueint, 2);
+        if (item->valueint <= 0xFFFFFFFFULL)
+            return mp_put(p, 0xce, item->valueint, 4);
+        return mp_put(p, 0xcf, item->valueint, 8);
+    case cJSON_Double:
     {
-        n = item->sign * n * pow(10.0, (scale + subscale * signsubscale)); /* number = +/- number.fraction * 10^+/- exponent */
-        item->valuedouble = (double)n;
-        item->valueint = (uint64)n;
-        item->type = cJSON_Double;
+        uint64 bits;
+        memcpy(&bits, &item->valuedouble, sizeof(bits));
+        return mp_put(p, 0xcb, bits, 8);
     }
-    return num;
+    case cJSON_String:
+        return mp_put_string(p, item->valuestring);
+    case cJSON_Array:
+    case cJSON_Object:
+        for (child = item->child; child; child = child->next)
+            n++;
+        if ((item->type & 255) == cJSON_Array)
+        {
+            if (!mp_put_length(p, n, 0x90, 15, 0, 0xdc))
+                return 0;
+        }
+        else if (!mp_put_length(p, n, 0x80, 15, 0, 0xde))
+            return 0;
+        for (child = item->child; child; child = child->next)
+        {
+            if ((item->type & 255) == cJSON_Object && !mp_put_string(p, child->string))
+                return 0;
+            if (!mp_print_value(child, p))
+                return 0;
+        }
+        return 1;
+    }
+    return 0;
 }
 
-/* Render the number nicely from the given item into a string. */
-static char* print_double(cJSON* item)
+int cJSON_PrintMsgPack(cJSON* item, cJSON_PrintBuffer* pb)
 {
-    char* str;
-    double d = item->valuedouble;
-    str = (char*)cJSON_malloc(64); /* This is a nice tradeoff. */
-    if (str)
+    size_t start = pb->length;
+    if (!item || !mp_print_value(item, pb) || !ensure(pb, 0))
     {
-        if (fabs(d) < 1.0e-6 || fabs(d) > 1.0e9)
-            sprintf_s(str,64, "%lf", d);
-        else
-			sprintf_s(str,64, "%f", d);
+        pb->length = start;
+        return 0;
     }
-    return str;
+    pb->buffer[pb->length] = 0;
+    return 1;
 }
 
-static char* print_int(cJSON* item)
+typedef struct
 {
-    char* str;
-    str = (char*)cJSON_malloc(22); /* 2^64+1 can be represented in 21 chars. */
-    if (str)
-    {
-        if (item->sign == -1)
-        {
-            if ((int64)item->valueint <= (int64)INT_MAX && (int64)item->valueint >= (int64)INT_MIN)
-            {
-                sprintf_s(str, 22, "%d", (int32)item->valueint);
-            }
-            else
-            {
-                sprintf_s(str, 22, "%lld", (int64)item->valueint);
-            }
-        }
-        else
-        {
-            if (item->valueint <= (uint64)UINT_MAX)
-            {
-				sprintf_s(str, 22, "%u", (uint32)item->valueint);
-            }
-            else
-            {
-				sprintf_s(str, 22, "%llu", item->valueint);
-            }
-        }
-    }
-    return str;
+    unsigned char* ptr;
+    unsigned char* end;
+    int insitu; /* strings are terminated in the input instead of copied */
+    int depth;
+} mp_reader;
+
+#define CJSON_MSGPACK_MAX_DEPTH 1000
+
+static int mp_get(mp_reader* r, int bytes, uint64* value)
+{
+    if (r->end - r->ptr < bytes)
+        return 0;
+    *value = 0;
+    while (bytes--)
+        *value = (*value << 8) | *r->ptr++;
+    return 1;
 }
 
-/* Parse the input text into an unescaped cstring, and populate item. */
-static const unsigned char firstByteMark[7] = { 0x00, 0x00, 0xC0, 0xE0, 0xF0,
-                0xF8, 0xFC };
-static const char* parse_string(cJSON* item, const char* str)
+/* Reads a str or bin body of len bytes whose header started at head. */
+static char* mp_get_string(mp_reader* r, unsigned char* head, uint64 len)
 {
-    const char* ptr = str + 1;
-    char* ptr2;
+    unsigned char* data = r->ptr;
     char* out;
-    int len = 0;
-    unsigned uc, uc2;
-    if (*str != '\"')
+    if ((uint64)(r->end - r->ptr) < len)
+        return 0;
+    r->ptr += len;
+    if (r->insitu)
     {
-        ep = str;
+        /* the header is at least one byte, so the moved text and its terminator fit where header and text were */
+        memmove(head, data, (size_t)len);
+        head[len] = 0;
+        return (char*)head;
+    }
+    out = (char*)cJSON_parse_malloc((size_t)len + 1);
+    if (!out)
         return 0;
-    } /* not a string! */
+    memcpy(out, data, (size_t)len);
+    out[len] = 0;
+    return out;
+}
 
-    while (*ptr != '\"' && *ptr && ++len)
-        if (*ptr++ == '\\')
-            ptr++; /* Skip escaped quotes. */
+static char* mp_read_string(mp_reader* r)
+{
+    unsigned char* head = r->ptr;
+    uint64 len;
+    if (r->ptr >= r->end)
+        return 0;
+    if ((*r->ptr & 0xe0) == 0xa0)
+        len = *r->ptr++ & 31;
+    else if (*r->ptr == 0xd9 || *r->ptr == 0xc4) /* str 8 / bin 8 */
+    {
+        if (r->ptr++, !mp_get(r, 1, &len))
+            return 0;
+    }
+    else if (*r->ptr == 0xda || *r->ptr == 0xc5)
+    {
+        if (r->ptr++, !mp_get(r, 2, &len))
+            return 0;
+    }
+    else if (*r->ptr == 0xdb || *r->ptr == 0xc6)
+    {
+        if (r->ptr++, !mp_get(r, 4, &len))
+            return 0;
+    }
+    else
+        return 0;
+    return mp_get_string(r, head, len);
+}
 
-    out = (char*)cJSON_malloc(len + 1); /* This is how long we need for the string, roughly. */
-    if (!out)
+static int mp_parse_value(cJSON* item, mp_reader* r)
+{
+    unsigned char tag;
+    uint64 v = 0, count = 0, i;
+    cJSON* child = 0;
+    if (r->ptr >= r->end)
         return 0;
+    tag = *r->ptr;
+    item->sign = 1;
 
-    ptr = str + 1;
-    ptr2 = out;
-    while (*ptr != '\"' && *ptr)
+    if (tag <= 0x7f || tag >= 0xe0 || (tag >= 0xcc && tag <= 0xd3))
     {
-        if (*ptr != '\\')
-            *ptr2++ = *ptr++;
+        int bytes = 0;
+        r->ptr++;
+        if (tag >= 0xcc && tag <= 0xd3)
+        {
+            bytes = 1 << ((tag - 0xcc) & 3);
+            if (!mp_get(r, bytes, &v))
+                return 0;
+        }
         else
+            v = tag;
+        if (tag >= 0xd0)
         {
-            ptr++;
-            switch (*ptr)
-            {
-            case 'b':
-                *ptr2++ = '\b';
-                break;
-            case 'f':
-                *ptr2++ = '\f';
-                break;
-            case 'n':
-                *ptr2++ = '\n';
-                break;
-            case 'r':
-                *ptr2++ = '\r';
-                break;
-            case 't':
-                *ptr2++ = '\t';
-                break;
-            case 'u': /* transcode utf16 to utf8. */
-                sscanf_s(ptr + 1, "%4x", &uc);
-                ptr += 4; /* get the unicode char. */
-
-                if ((uc >= 0xDC00 && uc <= 0xDFFF) || uc == 0)
-                    break;	// check for invalid.
-
-                if (uc >= 0xD800 && uc <= 0xDBFF)	// UTF16 surrogate pairs.
-                {
-                    if (ptr[1] != '\\' || ptr[2] != 'u')
-                        break;	// missing second-half of surrogate.
-					sscanf_s(ptr + 3, "%4x", &uc2);
-                    ptr += 6;
-                    if (uc2 < 0xDC00 || uc2 > 0xDFFF)
-                        break;	// invalid second-half of surrogate.
-                    uc = 0x10000 | ((uc & 0x3FF) << 10) | (uc2 & 0x3FF);
-                }
-
-                len = 4;
-                if (uc < 0x80)
-                    len = 1;
-                else if (uc < 0x800)
-                    len = 2;
-                else if (uc < 0x10000)
-                    len = 3;
-                ptr2 += len;
-
-                switch (len)
-                {
-                case 4:
-                    *--ptr2 = ((uc | 0x80) & 0xBF);
-                    uc >>= 6;
-                case 3:
-                    *--ptr2 = ((uc | 0x80) & 0xBF);
-                    uc >>= 6;
-                case 2:
-                    *--ptr2 = ((uc | 0x80) & 0xBF);
-                    uc >>= 6;
-                case 1:
-                    *--ptr2 = (uc | firstByteMark[len]);
-                }
-                ptr2 += len;
-                break;
-            default:
-                *ptr2++ = *ptr;
-                break;
-            }
-            ptr++;
+            /* sign-extend the negative fixint or intN */
+            int shift = 64 - (tag >= 0xe0 ? 8 : bytes * 8);
+            v = (uint64)(((int64)(v << shift)) >> shift);
+            if ((int64)v < 0)
+                item->sign = -1;
         }
+        item->type = cJSON_Int;
+        item->valueint = v;
+        item->valuedouble = item->sign == -1 ? (double)(int64)v : (double)v;
+        return 1;
+    }
+    switch (tag)
+    {
+    case 0xc0:
+        r->ptr++;
+        item->type = cJSON_NULL;
+        return 1;
+    case 0xc2:
+    case 0xc3:
+        r->ptr++;
+        item->type = tag == 0xc3 ? cJSON_True : cJSON_False;
+        item->valueint = tag == 0xc3;
+        return 1;
+    case 0xca:
+    case 0xcb:
+        r->ptr++;
+        if (!mp_get(r, tag == 0xca ? 4 : 8, &v))
+            return 0;
+        if (tag == 0xca)
+        {
+            unsigned int bits = (unsigned int)v;
+            float f;
+            memcpy(&f, &bits, sizeof(f));
+            item->valuedouble = f;
+        }
+        else
+            memcpy(&item->valuedouble, &v, sizeof(v));
+        if (item->valuedouble >= 0 && item->valuedouble < 18446744073709551616.0)
+            item->valueint = (uint64)item->valuedouble;
+        else if (item->valuedouble < 0 && item->valuedouble >= -9223372036854775808.0)
+            item->valueint = (uint64)(int64)item->valuedouble, item->sign = -1;
+        item->type = cJSON_Double;
+        return 1;
     }
-    *ptr2 = 0;
-    if (*ptr == '\"')
-        ptr++;
-    item->valuestring = out;
-    item->type = cJSON_String;
-    return ptr;
-}
-
-/* Render the cstring provided to an escaped version that can be printed. */
-static char* print_string_ptr(const char* str)
-{
-    const char* ptr;
-    char* ptr2, * out;
-    int len = 0;
-    unsigned char token;
 
-    if (!str)
-        return cJSON_strdup("");
-    ptr = str;
-    while ((token = *ptr) && ++len)
-    {
-        if (strchr("\"\\\b\f\n\r\t", token))
-            len++;
-        else if (token < 32)
-            len += 5;
-        ptr++;
+    if ((tag & 0xe0) == 0xa0 || tag == 0xd9 || tag == 0xda || tag == 0xdb || tag == 0xc4 || tag == 0xc5 || tag == 0xc6)
+    {
+        item->valuestring = mp_read_string(r);
+        if (!item->valuestring)
+            return 0;
+        item->type = cJSON_String;
+        return 1;
     }
 
-    out = (char*)cJSON_malloc(len + 3);
-    if (!out)
-        return 0;
+    if ((tag & 0xf0) == 0x90 || tag == 0xdc || tag == 0xdd)
+        item->type = cJSON_Array;
+    else if ((tag & 0xf0) == 0x80 || tag == 0xde || tag == 0xdf)
+        item->type = cJSON_Object;
+    else
+        return 0; /* ext types have no JSON form */
+    r->ptr++;
+    if (tag == 0xdc || tag == 0xde)
+    {
+        if (!mp_get(r, 2, &count))
+            return 0;
+    }
+    else if (tag == 0xdd || tag == 0xdf)
+    {
+        if (!mp_get(r, 4, &count))
+            return 0;
+    }
+    else
+        count = tag & 15;
+    if (count > (uint64)(r->end - r->ptr) || ++r->depth > CJSON_MSGPACK_MAX_DEPTH)
+        return 0; /* every element takes at least one byte */
 
-    ptr2 = out;
-    ptr = str;
-    *ptr2++ = '\"';
-    while (*ptr)
+    for (i = 0; i < count; i++)
     {
-        if ((unsigned char)*ptr > 31 && *ptr != '\"' && *ptr != '\\')
-            *ptr2++ = *ptr++;
+        cJSON* new_item = cJSON_New_Item();
+        if (!new_item)
+            return 0;
+        if (child)
+            child->next = new_item, new_item->prev = child;
         else
+            item->child = new_item;
+        child = new_item;
+        if (item->type == cJSON_Object)
         {
-            *ptr2++ = '\\';
-            switch (token = *ptr++)
-            {
-            case '\\':
-                *ptr2++ = '\\';
-                break;
-            case '\"':
-                *ptr2++ = '\"';
-                break;
-            case '\b':
-                *ptr2++ = 'b';
-                break;
-            case '\f':
-                *ptr2++ = 'f';
-                break;
-            case '\n':
-                *ptr2++ = 'n';
-                break;
-            case '\r':
-                *ptr2++ = 'r';
-                break;
-            case '\t':
-                *ptr2++ = 't';
-                break;
-            default:
-                sprintf(ptr2, "u%04x", token);
-                ptr2 += 5;
-                break; /* escape and print */
-            }
+            child->string = mp_read_string(r);
+            if (!child->string)
+                return 0;
         }
+        if (!mp_parse_value(child, r))
+            return 0;
     }
-    *ptr2++ = '\"';
-    *ptr2++ = 0;
-    return out;
-}
-/* Invote print_string_ptr (which is useful) on an item. */
-static char* print_string(cJSON* item)
-{
-    return print_string_ptr(item->valuestring);
-}
-
-/* Predeclare these prototypes. */
-static const char* parse_value(cJSON* item, const char* value);
-static char* print_value(cJSON* item, int depth, int fmt);
-static const char* parse_array(cJSON* item, const char* value);
-static char* print_array(cJSON* item, int depth, int fmt);
-static const char* parse_object(cJSON* item, const char* value);
-static char* print_object(cJSON* item, int depth, int fmt);
-
-/* Utility to jump whitespace and cr/lf */
-static const char* skip(const char* in)
-{
-    while (in && *in && (unsigned char)*in <= 32)
-        in++;
-    return in;
+    r->depth--;
+    if (item->type == cJSON_Object && count >= CJSON_INDEX_MIN_ITEMS)
+        item->index = cJSON_index_build(item);
+    return 1;
 }
 
-/* Parse an object - create a new root, and populate. */
-cJSON* cJSON_Parse(const char* value)
+static cJSON* mp_parse(mp_reader* r, size_t* consumed)
 {
+    unsigned char* begin = r->ptr;
     cJSON* c = cJSON_New_Item();
     ep = 0;
     if (!c)
-        return 0; /* memory fail */
-
-    if (!parse_value(c, skip(value)))
+        return 0;
+    if (!mp_parse_value(c, r))
     {
-        cJSON_Delete(c);
+        ep = (const char*)r->ptr;
+        if (!parse_arena)
+            cJSON_Delete(c);
         return 0;
     }
+    if (consumed)
+        *consumed = r->ptr - begin;
     return c;
 }
 
-/* Render a cJSON item/entity/structure to text. */
-char* cJSON_Print(cJSON* item)
+cJSON* cJSON_ParseMsgPack(const void* data, size_t size, size_t* consumed)
 {
-    return print_value(item, 0, 1);
+    mp_reader r;
+    r.ptr = (unsigned char*)data;
+    r.end = r.ptr + size;
+    r.insitu = 0;
+    r.depth = 0;
+    return mp_parse(&r, consumed);
 }
-char* cJSON_PrintUnformatted(cJSON* item)
+
+cJSON* cJSON_ParseMsgPackInSitu(void* data, size_t size, size_t* consumed, cJSON_Arena* arena)
 {
-    return print_value(item, 0, 0);
+    mp_reader r;
+    cJSON* c;
+    if (!arena)
+        return cJSON_ParseMsgPack(data, size, consumed);
+    r.ptr = (unsigned char*)data;
+    r.end = r.ptr + size;
+    r.insitu = 1;
+    r.depth = 0;
+    parse_arena = arena;
+    c = mp_parse(&r, consumed);
+    parse_arena = 0;
+    return c;
 }
 
 /* Parser core - when encountering text, process appropriately. */
@@ -475,39 +1571,30 @@ static const char* parse_value(cJSON* item, const char* value)
 }
 
 /* Render a value to text. */
-static char* print_value(cJSON* item, int depth, int fmt)
+static int print_value(cJSON* item, int depth, int fmt, cJSON_PrintBuffer* p)
 {
-    char* out = 0;
     if (!item)
         return 0;
     switch ((item->type) & 255)
     {
     case cJSON_NULL:
-        out = cJSON_strdup("null");
-        break;
+        return print_raw(p, "null", 4);
     case cJSON_False:
-        out = cJSON_strdup("false");
-        break;
+        return print_raw(p, "false", 5);
     case cJSON_True:
-        out = cJSON_strdup("true");
-        break;
+        return print_raw(p, "true", 4);
     case cJSON_Int:
-        out = print_int(item);
-        break;
+        return print_int(item, p);
     case cJSON_Double:
-        out = print_double(item);
-        break;
+        return print_double(item, p);
     case cJSON_String:
-        out = print_string(item);
-        break;
+        return print_string(item, p);
     case cJSON_Array:
-        out = print_array(item, depth, fmt);
-        break;
+        return print_array(item, depth, fmt, p);
     case cJSON_Object:
-        out = print_object(item, depth, fmt);
-        break;
+        return print_object(item, depth, fmt, p);
     }
-    return out;
+    return 0;
 }
 
 /* Build an array from input text. */
@@ -552,79 +1639,27 @@ static const char* parse_array(cJSON* item, const char* value)
 }
 
 /* Render an array to text */
-static char* print_array(cJSON* item, int depth, int fmt)
+static int print_array(cJSON* item, int depth, int fmt, cJSON_PrintBuffer* p)
 {
-    char** entries;
-    char* out = 0, * ptr, * ret;
-    int len = 5;
     cJSON* child = item->child;
-    int numentries = 0, i = 0, fail = 0;
-
-    /* How many entries in the array? */
-    while (child)
-        numentries++, child = child->next;
-    /* Allocate an array to hold the values for each */
-    entries = (char**)cJSON_malloc(numentries * sizeof(char*));
-    if (!entries)
-        return 0;
-    memset(entries, 0, numentries * sizeof(char*));
-    /* Retrieve all the results: */
-    child = item->child;
-    while (child && !fail)
-    {
-        ret = print_value(child, depth + 1, fmt);
-        entries[i++] = ret;
-        if (ret)
-            len += strlen(ret) + 2 + (fmt ? 1 : 0);
-        else
-            fail = 1;
-        child = child->next;
-    }
-
-    /* If we didn't fail, try to malloc the output string */
-    if (!fail)
-        out = (char*)cJSON_malloc(len);
-    /* If that fails, we fail. */
-    if (!out)
-        fail = 1;
-
-    /* Handle failure. */
-    if (fail)
-    {
-        for (i = 0; i < numentries; i++)
-            if (entries[i])
-                cJSON_free(entries[i]);
-        cJSON_free(entries);
+    if (!print_raw(p, "[", 1))
         return 0;
-    }
-
-    /* Compose the output array. */
-    *out = '[';
-    ptr = out + 1;
-    *ptr = 0;
-    for (i = 0; i < numentries; i++)
+    while (child)
     {
-        strcpy(ptr, entries[i]);
-        ptr += strlen(entries[i]);
-        if (i != numentries - 1)
-        {
-            *ptr++ = ',';
-            if (fmt)
-                *ptr++ = ' ';
-            *ptr = 0;
-        }
-        cJSON_free(entries[i]);
+        if (!print_value(child, depth + 1, fmt, p))
+            return 0;
+        child = child->next;
+        if (child && !print_raw(p, ", ", fmt ? 2 : 1))
+            return 0;
     }
-    cJSON_free(entries);
-    *ptr++ = ']';
-    *ptr++ = 0;
-    return out;
+    return print_raw(p, "]", 1);
 }
 
 /* Build an object from the text. */
 static const char* parse_object(cJSON* item, const char* value)
 {
     cJSON* child;
+    int count = 1;
     if (*value != '{')
     {
         ep = value;
@@ -661,6 +1696,7 @@ static const char* parse_object(cJSON* item, const char* value)
         child->next = new_item;
         new_item->prev = child;
         child = new_item;
+        count++;
         value = skip(parse_string(child, skip(value + 1)));
         if (!value)
             return 0;
@@ -677,107 +1713,52 @@ static const char* parse_object(cJSON* item, const char* value)
     }
 
     if (*value == '}')
+    {
+        if (count >= CJSON_INDEX_MIN_ITEMS)
+            item->index = cJSON_index_build(item);
         return value + 1; /* end of array */
+    }
     ep = value;
     return 0; /* malformed. */
 }
 
 /* Render an object to text. */
-static char* print_object(cJSON* item, int depth, int fmt)
+static int print_tabs(cJSON_PrintBuffer* p, int count)
 {
-    char** entries = 0, ** names = 0;
-    char* out = 0, * ptr, * ret, * str;
-    int len = 7, i = 0, j;
-    cJSON* child = item->child;
-    int numentries = 0, fail = 0;
-    /* Count the number of entries. */
-    while (child)
-        numentries++, child = child->next;
-    /* Allocate space for the names and the objects */
-    entries = (char**)cJSON_malloc(numentries * sizeof(char*));
-    if (!entries)
-        return 0;
-    names = (char**)cJSON_malloc(numentries * sizeof(char*));
-    if (!names)
-    {
-        cJSON_free(entries);
+    char* out;
+    if (count <= 0)
+        return 1;
+    out = ensure(p, count);
+    if (!out)
         return 0;
-    }
-    memset(entries, 0, sizeof(char*) * numentries);
-    memset(names, 0, sizeof(char*) * numentries);
+    memset(out, '\t', count);
+    p->length += count;
+    return 1;
+}
 
-    /* Collect all the results into our arrays: */
-    child = item->child;
+static int print_object(cJSON* item, int depth, int fmt, cJSON_PrintBuffer* p)
+{
+    cJSON* child = item->child;
     depth++;
-    if (fmt)
-        len += depth;
+    if (!print_raw(p, "{\n", fmt ? 2 : 1))
+        return 0;
     while (child)
     {
-        names[i] = str = print_string_ptr(child->string);
-        entries[i++] = ret = print_value(child, depth, fmt);
-        if (str && ret)
-            len += strlen(ret) + strlen(str) + 2 + (fmt ? 2 + depth : 0);
-        else
-            fail = 1;
+        if (fmt && !print_tabs(p, depth))
+            return 0;
+        if (!print_string_ptr(child->string, p) || !print_raw(p, ":\t", fmt ? 2 : 1))
+            return 0;
+        if (!print_value(child, depth, fmt, p))
+            return 0;
         child = child->next;
+        if (child && !print_raw(p, ",", 1))
+            return 0;
+        if (fmt && !print_raw(p, "\n", 1))
+            return 0;
     }
-
-    /* Try to allocate the output string */
-    if (!fail)
-        out = (char*)cJSON_malloc(len);
-    if (!out)
-        fail = 1;
-
-    /* Handle failure */
-    if (fail)
-    {
-        for (i = 0; i < numentries; i++)
-        {
-            if (names[i])
-                cJSON_free(names[i]);
-            if (entries[i])
-                cJSON_free(entries[i]);
-        }
-        cJSON_free(names);
-        cJSON_free(entries);
+    if (fmt && !print_tabs(p, depth - 1))
         return 0;
-    }
-
-    /* Compose the output: */
-    *out = '{';
-    ptr = out + 1;
-    if (fmt)
-        *ptr++ = '\n';
-    *ptr = 0;
-    for (i = 0; i < numentries; i++)
-    {
-        if (fmt)
-            for (j = 0; j < depth; j++)
-                *ptr++ = '\t';
-        strcpy(ptr, names[i]);
-        ptr += strlen(names[i]);
-        *ptr++ = ':';
-        if (fmt)
-            *ptr++ = '\t';
-        strcpy(ptr, entries[i]);
-        ptr += strlen(entries[i]);
-        if (i != numentries - 1)
-            *ptr++ = ',';
-        if (fmt)
-            *ptr++ = '\n';
-        *ptr = 0;
-        cJSON_free(names[i]);
-        cJSON_free(entries[i]);
-    }
-
-    cJSON_free(names);
-    cJSON_free(entries);
-    if (fmt)
-        for (i = 0; i < depth - 1; i++)
-            *ptr++ = '\t';
-    *ptr++ = '}';
-    *ptr++ = 0;
-    return out;
+    return print_raw(p, "}", 1);
 }
 
 /* Get Array size/item / object item. */
@@ -796,13 +1777,31 @@ cJSON* cJSON_GetArrayItem(cJSON* array, int item)
         item--, c = c->next;
     return c;
 }
-cJSON* cJSON_GetObjectItem(cJSON* object, const char* string)
+static cJSON* cJSON_FindObjectItem(cJSON* object, const char* string, int case_sensitive)
 {
-    cJSON* c = object->child;
-    while (c && cJSON_strcasecmp(c->string, string))
+    cJSON* c;
+    if (object->index && string)
+    {
+        cJSON_Index* index = object->index;
+        unsigned int i = cJSON_hash_key(string) & index->mask;
+        for (; (c = index->slots[i]) != 0; i = (i + 1) & index->mask)
+            if (case_sensitive ? !strcmp(c->string, string) : !cJSON_strcasecmp(c->string, string))
+                return c;
+        return 0;
+    }
+    c = object->child;
+    while (c && (case_sensitive ? (!c->string || !string || strcmp(c->string, string)) : cJSON_strcasecmp(c->string, string)))
         c = c->next;
     return c;
 }
+cJSON* cJSON_GetObjectItem(cJSON* object, const char* string)
+{
+    return cJSON_FindObjectItem(object, string, 0);
+}
+cJSON* cJSON_GetObjectItemCaseSensitive(cJSON* object, const char* string)
+{
+    return cJSON_FindObjectItem(object, string, 1);
+}
 
 /* Utility for array list handling. */
 static void suffix_object(cJSON* prev, cJSON* item)
@@ -818,6 +1817,8 @@ static cJSON* create_reference(cJSON* item)
         return 0;
     memcpy(ref, item, sizeof(cJSON));
     ref->string = 0;
+    ref->index = 0;
+    ref->in_arena = 0;
     ref->type |= cJSON_IsReference;
     ref->next = ref->prev = 0;
     return ref;
@@ -827,6 +1828,7 @@ static cJSON* create_reference(cJSON* item)
 void cJSON_AddItemToArray(cJSON* array, cJSON* item)
 {
     cJSON* c = array->child;
+    int count = 1;
     if (!item)
         return;
     if (!c)
@@ -836,9 +1838,11 @@ void cJSON_AddItemToArray(cJSON* array, cJSON* item)
     else
     {
         while (c && c->next)
-            c = c->next;
+            c = c->next, count++;
         suffix_object(c, item);
+        count++;
     }
+    cJSON_index_append(array, item, count);
 }
 
 void cJSON_AddItemToArrayHead(cJSON* array, cJSON* item)
@@ -857,13 +1861,14 @@ void cJSON_AddItemToArrayHead(cJSON* array, cJSON* item)
         c->prev = item;
         array->child = item;
     }
+    cJSON_index_rebuild(array);
 }
 
 void cJSON_AddItemToObject(cJSON* object, const char* string, cJSON* item)
 {
     if (!item)
         return;
-    if (item->string)
+    if (item->string && !item->in_arena)
         cJSON_free(item->string);
     item->string = cJSON_strdup(string);
     cJSON_AddItemToArray(object, item);
@@ -878,73 +1883,93 @@ void cJSON_AddItemReferenceToObject(cJSON* object, const char* string,
     cJSON_AddItemToObject(object, string, create_reference(item));
 }
 
-cJSON* cJSON_DetachItemFromArray(cJSON* array, int which)
+/* Unlink c from the members of parent. */
+static cJSON* detach_item(cJSON* parent, cJSON* c)
 {
-    cJSON* c = array->child;
-    while (c && which > 0)
-        c = c->next, which--;
-    if (!c)
-        return 0;
     if (c->prev)
         c->prev->next = c->next;
     if (c->next)
         c->next->prev = c->prev;
-    if (c == array->child)
-        array->child = c->next;
+    if (c == parent->child)
+        parent->child = c->next;
     c->prev = c->next = 0;
+    cJSON_index_rebuild(parent);
     return c;
 }
+/* Put newitem in the place of c and delete c. */
+static void replace_item(cJSON* parent, cJSON* c, cJSON* newitem)
+{
+    newitem->next = c->next;
+    newitem->prev = c->prev;
+    if (newitem->next)
+        newitem->next->prev = newitem;
+    if (c == parent->child)
+        parent->child = newitem;
+    else
+        newitem->prev->next = newitem;
+    c->next = c->prev = 0;
+    cJSON_index_replace(parent, c, newitem);
+    cJSON_Delete(c);
+}
+
+cJSON* cJSON_DetachItemFromArray(cJSON* array, int which)
+{
+    cJSON* c = cJSON_GetArrayItem(array, which);
+    return c ? detach_item(array, c) : 0;
+}
 void cJSON_DeleteItemFromArray(cJSON* array, int which)
 {
     cJSON_Delete(cJSON_DetachItemFromArray(array, which));
 }
+/* The by-key calls resolve the member the same way the matching cJSON_GetObjectItem* call does. */
+static cJSON* detach_item_from_object(cJSON* object, const char* string, int case_sensitive)
+{
+    cJSON* c = cJSON_FindObjectItem(object, string, case_sensitive);
+    return c ? detach_item(object, c) : 0;
+}
 cJSON* cJSON_DetachItemFromObject(cJSON* object, const char* string)
 {
-    int i = 0;
-    cJSON* c = object->child;
-    while (c && cJSON_strcasecmp(c->string, string))
-        i++, c = c->next;
-    if (c)
-        return cJSON_DetachItemFromArray(object, i);
-    return 0;
+    return detach_item_from_object(object, string, 0);
+}
+cJSON* cJSON_DetachItemFromObjectCaseSensitive(cJSON* object, const char* string)
+{
+    return detach_item_from_object(object, string, 1);
 }
 void cJSON_DeleteItemFromObject(cJSON* object, const char* string)
 {
     cJSON_Delete(cJSON_DetachItemFromObject(object, string));
 }
+void cJSON_DeleteItemFromObjectCaseSensitive(cJSON* object, const char* string)
+{
+    cJSON_Delete(cJSON_DetachItemFromObjectCaseSensitive(object, string));
+}
 
 /* Replace array/object items with new ones. */
 void cJSON_ReplaceItemInArray(cJSON* array, int which, cJSON* newitem)
 {
-    cJSON* c = array->child;
-    while (c && which > 0)
-        c = c->next, which--;
-    if (!c)
-        return;
-    newitem->next = c->next;
-    newitem->prev = c->prev;
-    if (newitem->next)
-        newitem->next->prev = newitem;
-    if (c == array->child)
-        array->child = newitem;
-    else
-        newitem->prev->next = newitem;
-    c->next = c->prev = 0;
-    cJSON_Delete(c);
+    cJSON* c = cJSON_GetArrayItem(array, which);
+    if (c)
+        replace_item(array, c, newitem);
 }
-void cJSON_ReplaceItemInObject(cJSON* object, const char* string,
-    cJSON* newitem)
+static void replace_item_in_object(cJSON* object, const char* string, cJSON* newitem, int case_sensitive)
 {
-    int i = 0;
-    cJSON* c = object->child;
-    while (c && cJSON_strcasecmp(c->string, string))
-        i++, c = c->next;
+    cJSON* c = cJSON_FindObjectItem(object, string, case_sensitive);
     if (c)
     {
         newitem->string = cJSON_strdup(string);
-        cJSON_ReplaceItemInArray(object, i, newitem);
+        replace_item(object, c, newitem);
     }
 }
+void cJSON_ReplaceItemInObject(cJSON* object, const char* string,
+    cJSON* newitem)
+{
+    replace_item_in_object(object, string, newitem, 0);
+}
+void cJSON_ReplaceItemInObjectCaseSensitive(cJSON* object, const char* string,
+    cJSON* newitem)
+{
+    replace_item_in_object(object, string, newitem, 1);
+}
 
 /* Create basic types: */
 cJSON* cJSON_CreateNull()
@@ -60,6 +60,10 @@ typedef struct cJSON
     int sign;   /* sign of valueint, 1(unsigned), -1(signed) */
 
     char *string; /* The item's name string, if this item is the child of, or is in the list of subitems of an object. */
+
+    struct cJSON_Index *index; /* Hash index over the members of a large object, built at parse time or when it grows large. */
+
+    int in_arena; /* Allocated from a parse arena: cJSON_Delete leaves the item's own memory to the arena. */
 } cJSON;
 
 typedef struct cJSON_Hooks
@@ -71,12 +75,57 @@ typedef struct cJSON_Hooks
 /* Supply malloc, realloc and free functions to cJSON */
 extern void cJSON_InitHooks(cJSON_Hooks* hooks);
 
+/* Bump allocator for parsed documents. Blocks are taken from the malloc hook; every node and string of a document
+   parsed into the arena is carved out of them, and the whole document is released at once by resetting the arena. */
+typedef struct cJSON_Arena cJSON_Arena;
+/* Create an arena whose blocks are at least block_size bytes (0 selects a default). */
+extern cJSON_Arena *cJSON_CreateArena(size_t block_size);
+/* Release every document parsed into the arena. Memory is kept (coalesced into one block) for the next document. */
+extern void cJSON_ResetArena(cJSON_Arena *arena);
+/* Free the arena and all of its blocks. */
+extern void cJSON_DeleteArena(cJSON_Arena *arena);
+/* Parse into the arena. The result is released by cJSON_ResetArena/cJSON_DeleteArena, never by cJSON_Delete.
+   Members may be detached, deleted or replaced, but heap items attached to it are not freed with the arena. */
+extern cJSON *cJSON_ParseWithArena(const char *value, cJSON_Arena *arena);
+
 /* Supply a block of JSON, and this returns a cJSON object you can interrogate. Call cJSON_Delete when finished. */
 extern cJSON *cJSON_Parse(const char *value);
 /* Render a cJSON entity to text for transfer/storage. Free the char* when finished. */
 extern char *cJSON_Print(cJSON *item);
 /* Render a cJSON entity to text for transfer/storage without any formatting. Free the char* when finished. */
 extern char *cJSON_PrintUnformatted(cJSON *item);
+/* Growable output for cJSON_PrintBuffered. Without grow_fn the buffer is grown through the malloc/free hooks and
+   released by cJSON_FreePrintBuffer; with grow_fn the caller owns it, and grow_fn must make buffer/size hold at least
+   `size` bytes (keeping the first `length`) and return 0 on failure. */
+typedef struct cJSON_PrintBuffer
+{
+    char *buffer;
+    size_t length; /* bytes written, not counting the terminating 0 */
+    size_t size;   /* bytes available at buffer */
+    int (*grow_fn)(struct cJSON_PrintBuffer *pb, size_t size);
+    void *user;    /* for grow_fn */
+} cJSON_PrintBuffer;
+/* Render a cJSON entity into pb at pb->length, without per-node allocations. Set length to 0 to reuse the buffer
+   for the next message. Returns 0 on failure, leaving pb->length unchanged. */
+extern int cJSON_PrintBuffered(cJSON *item, int fmt, cJSON_PrintBuffer *pb);
+extern void cJSON_FreePrintBuffer(cJSON_PrintBuffer *pb);
+/* Append the MessagePack encoding of a cJSON entity to pb, as cJSON_PrintBuffered does for text. */
+extern int cJSON_PrintMsgPack(cJSON *item, cJSON_PrintBuffer *pb);
+/* Decode one MessagePack value from size bytes of data; *consumed (if given) receives the bytes used. Strings are
+   copied. Call cJSON_Delete when finished. */
+extern cJSON *cJSON_ParseMsgPack(const void *data, size_t size, size_t *consumed);
+/* Decode into the arena without copying strings: each is moved down over its header and terminated in place, so
+   data is modified and must stay alive as long as the result is used. */
+extern cJSON *cJSON_ParseMsgPackInSitu(void *data, size_t size, size_t *consumed, cJSON_Arena *arena);
+/* Scalar conversions for code that reads or writes JSON text without building a tree.
+   cJSON_ParseNumber fills type, sign, valueint and valuedouble of a caller-owned item and returns the end of the
+   number, or 0 if value does not start one. cJSON_FormatDouble writes the shortest round-trip form (at most 32
+   bytes, no terminator). cJSON_ParseStringBuffered appends the unescaped body of the quoted string at value and
+   returns the byte after the closing quote; cJSON_PrintStringBuffered appends str quoted and escaped. */
+extern const char *cJSON_ParseNumber(cJSON *item, const char *value);
+extern size_t cJSON_FormatDouble(double d, char *out);
+extern const char *cJSON_ParseStringBuffered(const char *value, cJSON_PrintBuffer *p);
+extern int cJSON_PrintStringBuffered(const char *str, size_t len, cJSON_PrintBuffer *p);
 /* Delete a cJSON entity and all subentities. */
 extern void cJSON_Delete(cJSON *c);
 
@@ -86,6 +135,9 @@ extern int cJSON_GetArraySize(cJSON *array);
 extern cJSON *cJSON_GetArrayItem(cJSON *array, int item);
 /* Get item "string" from object. Case insensitive. */
 extern cJSON *cJSON_GetObjectItem(cJSON *object, const char *string);
+/* Get item "string" from object, matching the key exactly. */
+extern cJSON *cJSON_GetObjectItemCaseSensitive(cJSON *object, const char *string);
+/* Lookups never modify the object, so several threads may read one object at once. */
 
 /* For analysing failed parses. This returns a pointer to the parse error. You'll probably need to look a few chars back to make sense of it. Defined when cJSON_Parse() returns 0. 0 when cJSON_Parse() succeeds. */
 extern const char *cJSON_GetErrorPtr();
@@ -122,11 +174,15 @@ extern cJSON *cJSON_DetachItemFromArray(cJSON *array, int which);
 extern void cJSON_DeleteItemFromArray(cJSON *array, int which);
 extern cJSON *cJSON_DetachItemFromObject(cJSON *object, const char *string);
 extern void cJSON_DeleteItemFromObject(cJSON *object, const char *string);
+extern cJSON *cJSON_DetachItemFromObjectCaseSensitive(cJSON *object, const char *string);
+extern void cJSON_DeleteItemFromObjectCaseSensitive(cJSON *object, const char *string);
 
 /* Update array items. */
 extern void cJSON_ReplaceItemInArray(cJSON *array, int which, cJSON *newitem);
 extern void cJSON_ReplaceItemInObject(cJSON *object, const char *string,
                 cJSON *newitem);
+extern void cJSON_ReplaceItemInObjectCaseSensitive(cJSON *object, const char *string,
+                cJSON *newitem);
 
 #define cJSON_AddNullToObject(object,name)	cJSON_AddItemToObject(object, name, cJSON_CreateNull())
 #define cJSON_AddTrueToObject(object,name)	cJSON_AddItemToObject(object, name, cJSON_CreateTrue())
@@ -2,12 +2,203 @@
 #include <locale>
 #include <codecvt>
 #include <windows.h>
+#include <bcrypt.h>
 #include <random>
 #include <algorithm>
 #include <stdexcept>
-#include <comutil.h>
-#include <sstream>
-#pragma comment(lib, "comsuppw.lib")
+#include <cstring>
+#include <type_traits>
+#include <climits>
+#include <cctype>
+#pragma comment(lib, "bcrypt.lib")
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define TEXT_SIMD 1
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define TEXT_TARGET_SSSE3
+#else
+#include <cpuid.h>
+#include <x86intrin.h>
+#define TEXT_TARGET_SSSE3 __attribute__((target("ssse3")))
+#endif
+#else
+#define TEXT_SIMD 0
+#endif
+
+namespace {
+#if TEXT_SIMD
+    inline unsigned long text_ctz(unsigned int mask) {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward(&index, mask);
+        return index;
+#else
+        return static_cast<unsigned long>(__builtin_ctz(mask));
+#endif
+    }
+
+    bool text_cpu_has_ssse3() {
+        int cpu_info[4]{};
+#if defined(_MSC_VER)
+        __cpuid(cpu_info, 1);
+#else
+        __cpuid(1, cpu_info[0], cpu_info[1], cpu_info[2], cpu_info[3]);
+#endif
+        return (cpu_info[2] & (1 << 9)) != 0;
+    }
+
+    const bool g_text_ssse3 = text_cpu_has_ssse3();
+
+    // Ƚַеַλûʣ಻16ֽڵʼλ
+    size_t text_scan_sse2(const unsigned char* data, size_t size, size_t pos, const char* chars, size_t count) {
+        __m128i needles[8];
+        for (size_t i = 0; i < count; ++i) {
+            needles[i] = _mm_set1_epi8(chars[i]);
+        }
+        for (; pos + 16 <= size; pos += 16) {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+            __m128i hit = _mm_cmpeq_epi8(block, needles[0]);
+            for (size_t i = 1; i < count; ++i) {
+                hit = _mm_or_si128(hit, _mm_cmpeq_epi8(block, needles[i]));
+            }
+            unsigned int mask = static_cast<unsigned int>(_mm_movemask_epi8(hit));
+            if (mask != 0) {
+                return pos + text_ctz(mask);
+            }
+        }
+        return pos;
+    }
+
+    // Ե4λλͼС4λȡλλûʣ಻16ֽڵʼλ
+    TEXT_TARGET_SSSE3 size_t text_scan_ssse3(const unsigned char* data, size_t size, size_t pos, const unsigned char* nibble) {
+        const __m128i table_lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(nibble));
+        const __m128i table_hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(nibble + 16));
+        const __m128i bits = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+        const __m128i low_mask = _mm_set1_epi8(0x0f);
+        const __m128i seven = _mm_set1_epi8(7);
+        const __m128i zero = _mm_setzero_si128();
+        for (; pos + 16 <= size; pos += 16) {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+            __m128i lo = _mm_and_si128(block, low_mask);
+            __m128i hi = _mm_and_si128(_mm_srli_epi16(block, 4), low_mask);
+            __m128i upper = _mm_cmpgt_epi8(hi, seven);
+            __m128i row = _mm_or_si128(_mm_andnot_si128(upper, _mm_shuffle_epi8(table_lo, lo)),
+                _mm_and_si128(upper, _mm_shuffle_epi8(table_hi, lo)));
+            __m128i hit = _mm_and_si128(row, _mm_shuffle_epi8(bits, hi));
+            unsigned int mask = static_cast<unsigned int>(_mm_movemask_epi8(_mm_cmpeq_epi8(hit, zero))) ^ 0xffff;
+            if (mask != 0) {
+                return pos + text_ctz(mask);
+            }
+        }
+        return pos;
+    }
+#endif
+
+    // βַ˺Ƚϣδҵstd::string::npos
+    size_t text_search(const char* data, size_t size, const char* needle, size_t needle_size, size_t pos) {
+        if (needle_size == 0) {
+            return pos <= size ? pos : std::string::npos;
+        }
+        if (needle_size > size || pos > size - needle_size) {
+            return std::string::npos;
+        }
+        if (needle_size == 1) {
+            const void* found = memchr(data + pos, needle[0], size - pos);
+            return found ? static_cast<const char*>(found) - data : std::string::npos;
+        }
+        const size_t last = needle_size - 1;
+#if TEXT_SIMD
+        const __m128i first_char = _mm_set1_epi8(needle[0]);
+        const __m128i last_char = _mm_set1_epi8(needle[last]);
+        for (; pos + last + 16 <= size; pos += 16) {
+            __m128i block_first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+            __m128i block_last = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos + last));
+            unsigned int mask = static_cast<unsigned int>(_mm_movemask_epi8(
+                _mm_and_si128(_mm_cmpeq_epi8(block_first, first_char), _mm_cmpeq_epi8(block_last, last_char))));
+            while (mask != 0) {
+                size_t candidate = pos + text_ctz(mask);
+                if (memcmp(data + candidate + 1, needle + 1, last - 1) == 0) {
+                    return candidate;
+                }
+                mask &= mask - 1;
+            }
+        }
+#endif
+        for (; pos + last < size; ++pos) {
+            if (data[pos] == needle[0] && data[pos + last] == needle[last] && memcmp(data + pos + 1, needle + 1, last - 1) == 0) {
+                return pos;
+            }
+        }
+        return std::string::npos;
+    }
+}
+
+Text::TextCharSet::TextCharSet(const std::string& chars) {
+    for (unsigned char ch : chars) {
+        if (Contains(ch)) {
+            continue;
+        }
+        m_bitmap[ch >> 5] |= 1u << (ch & 31);
+        m_nibble[((ch & 0x80) >> 3) + (ch & 15)] |= static_cast<unsigned char>(1u << ((ch >> 4) & 7));
+        if (m_count < sizeof(m_chars)) {
+            m_chars[m_count] = static_cast<char>(ch);
+        }
+        ++m_count;
+    }
+}
+
+size_t Text::TextCharSet::Find(const char* data, size_t size, size_t pos) const {
+    if (m_count == 0) {
+        return std::string::npos;
+    }
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+#if TEXT_SIMD
+    if (m_count <= sizeof(m_chars)) {
+        pos = text_scan_sse2(bytes, size, pos, m_chars, m_count);
+    } else if (g_text_ssse3) {
+        pos = text_scan_ssse3(bytes, size, pos, m_nibble);
+    }
+#endif
+    for (; pos < size; ++pos) {
+        if (Contains(bytes[pos])) {
+            return pos;
+        }
+    }
+    return std::string::npos;
+}
+
+std::vector<std::string> __stdcall Text::text_split_any(const std::string& text, const TextCharSet& delimiters) {
+    std::vector<std::string> result;
+    const char* data = text.data();
+    const size_t size = text.size();
+    size_t pos1 = 0, pos2 = 0;
+    while ((pos2 = delimiters.Find(data, size, pos1)) != std::string::npos) {
+        if (pos2 > pos1) {
+            result.emplace_back(data + pos1, pos2 - pos1);
+        }
+        pos1 = pos2 + 1; // ָ
+    }
+    if (pos1 < size) {
+        result.emplace_back(data + pos1, size - pos1);
+    }
+    return result;
+}
+
+std::vector<std::string> __stdcall Text::text_split_lines(const std::string& text) {
+    std::vector<std::string> result;
+    const char* data = text.data();
+    const size_t size = text.size();
+    size_t pos = 0;
+    while (pos < size) {
+        const void* found = memchr(data + pos, '\n', size - pos);
+        size_t end = found ? static_cast<const char*>(found) - data : size;
+        size_t line_end = (end > pos && data[end - 1] == '\r') ? end - 1 : end;
+        result.emplace_back(data + pos, line_end - pos);
+        pos = end + 1;
+    }
+    return result;
+}
 std::string __stdcall Text::text_join(std::vector<std::string> text_list, std::string delimiter) {
     std::string result;
     for (size_t i = 0; i < text_list.size(); ++i) {
@@ -48,7 +239,7 @@ std::string __stdcall Text::text_right_del(std::string text, size_t length) {
 }
 
 int __stdcall Text::text_find(std::string text, std::string find_text) {
-    size_t position = text.find(find_text);
+    size_t position = text_search(text.data(), text.size(), find_text.data(), find_text.size(), 0);
     if (position != std::string::npos) {
         return static_cast<int>(position);
     }
@@ -56,79 +247,283 @@ int __stdcall Text::text_find(std::string text, std::string find_text) {
 }
 
 std::string __stdcall Text::text_replace(std::string text, std::string find_text, std::string replace_text, size_t count) {
-    size_t start_pos = 0;
-    while ((start_pos = text.find(find_text, start_pos)) != std::string::npos) {
-        text.replace(start_pos, find_text.length(), replace_text);
-        start_pos += replace_text.length();
-        if (--count == 0) {
+    if (find_text.empty()) {
+        return text;
+    }
+    size_t start_pos = text.find(find_text);
+    if (start_pos == std::string::npos) {
+        return text;
+    }
+
+    // һƴӽÿreplaceβ
+    std::string result;
+    result.reserve(text.size());
+    size_t last_pos = 0;
+    size_t replaced = 0;
+    do {
+        result.append(text, last_pos, start_pos - last_pos);
+        result += replace_text;
+        last_pos = start_pos + find_text.length();
+        if (++replaced == count) {
             break;
         }
+    } while ((start_pos = text.find(find_text, last_pos)) != std::string::npos);
+    result.append(text, last_pos, std::string::npos);
+    return result;
+}
+
+Text::TextReplacer::TextReplacer(const std::vector<std::pair<std::string, std::string>>& pairs) {
+    // ״̬0Ϊ
+    m_vecGoto.assign(256, -1);
+    m_vecDepth.push_back(0);
+    m_vecOutput.push_back(-1);
+
+    for (const auto& pair : pairs) {
+        if (pair.first.empty()) {
+            continue;
+        }
+        int state = 0;
+        for (unsigned char ch : pair.first) {
+            int next = m_vecGoto[state * 256 + ch];
+            if (next < 0) {
+                next = static_cast<int>(m_vecDepth.size());
+                m_vecGoto[state * 256 + ch] = next;
+                m_vecGoto.resize(m_vecGoto.size() + 256, -1);
+                m_vecDepth.push_back(m_vecDepth[state] + 1);
+                m_vecOutput.push_back(-1);
+            }
+            state = next;
+        }
+        if (m_vecOutput[state] < 0) {
+            m_vecOutput[state] = static_cast<int>(m_vecFind.size());
+            m_vecFind.push_back(pair.first);
+            m_vecReplace.push_back(pair.second);
+        }
+    }
+
+    // ʧָ룬۵תƱ
+    std::vector<int> fail(m_vecDepth.size(), 0);
+    std::vector<int> queue;
+    queue.reserve(m_vecDepth.size());
+    for (int ch = 0; ch < 256; ++ch) {
+        int& next = m_vecGoto[ch];
+        if (next < 0) {
+            next = 0;
+        } else {
+            queue.push_back(next);
+        }
+    }
+    for (size_t head = 0; head < queue.size(); ++head) {
+        int state = queue[head];
+        // ʧ״̬ȸǳڱ״̬
+        if (m_vecOutput[state] < 0) {
+            m_vecOutput[state] = m_vecOutput[fail[state]];
+        }
+        for (int ch = 0; ch < 256; ++ch) {
+            int& next = m_vecGoto[state * 256 + ch];
+            int fallback = m_vecGoto[fail[state] * 256 + ch];
+            if (next < 0) {
+                next = fallback;
+            } else {
+                fail[next] = fallback;
+                queue.push_back(next);
+            }
+        }
     }
-    return text;
+}
+
+std::string Text::TextReplacer::Replace(const std::string& text) const {
+    if (m_vecFind.empty()) {
+        return text;
+    }
+
+    std::string result;
+    result.reserve(text.size());
+    const unsigned char* data = reinterpret_cast<const unsigned char*>(text.data());
+    const size_t size = text.size();
+
+    size_t last_pos = 0;     // δеʼλ
+    size_t pending_start = 0, pending_end = 0;
+    int pending = -1;        // ѡƥģʽ±
+    size_t i = 0;
+    int state = 0;
+    for (;;) {
+        bool commit = false;
+        if (i < size) {
+            state = m_vecGoto[state * 256 + data[i]];
+            int output = m_vecOutput[state];
+            if (output >= 0) {
+                size_t start = i + 1 - m_vecFind[output].size();
+                if (pending < 0 || start <= pending_start) {
+                    pending = output;
+                    pending_start = start;
+                    pending_end = i + 1;
+                }
+            }
+            ++i;
+            // ǰ״̬Ӧǰ׺Խѡ㣬ٳָƥ
+            commit = pending >= 0 && i - m_vecDepth[state] > pending_start;
+        } else {
+            if (pending < 0) {
+                break;
+            }
+            commit = true;
+        }
+
+        if (commit) {
+            result.append(text, last_pos, pending_start - last_pos);
+            result += m_vecReplace[pending];
+            last_pos = pending_end;
+            // ƥβɨ裬֤ƥ以ص
+            i = pending_end;
+            state = 0;
+            pending = -1;
+        }
+    }
+    result.append(text, last_pos, std::string::npos);
+    return result;
+}
+
+std::string __stdcall Text::text_replace_multi(std::string text, const std::vector<std::pair<std::string, std::string>>& pairs) {
+    return TextReplacer(pairs).Replace(text);
 }
 
 std::wstring __stdcall Text::text_to_wstr(std::string text) {
-    _bstr_t bstr(text.c_str());
-    return (wchar_t*)bstr;
+    return text_ascii_to_unicode(std::move(text));
 }
 
 std::string __stdcall Text::text_to_str(std::wstring text) {
-    _bstr_t bstr(text.c_str());
-    return (char*)bstr;
+    return text_unicode_to_ascii(std::move(text));
 }
 
-std::string __stdcall Text::text_random_num(size_t length) {
-    const std::string characters = "0123456789";
-    std::random_device rd;  // 
-    std::mt19937 generator(rd());  // ʼ
+namespace {
+    const char g_text_random_num[] = "0123456789";
+    const char g_text_random_alpha[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    const char g_text_random_alnum[] = "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    const char g_text_random_special[] = "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ!@#$%^&*()_+[]{}|;:,.<>?/";
+
+    // xoshiro256**ÿ߳״ʹʱһ
+    class TextRandom {
+    public:
+        TextRandom() {
+            std::random_device rd;
+            unsigned __int64 seed = (static_cast<unsigned __int64>(rd()) << 32) | rd();
+            for (auto& state : m_state) {
+                // splitmix64չ
+                unsigned __int64 z = (seed += 0x9E3779B97F4A7C15ULL);
+                z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+                z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+                state = z ^ (z >> 31);
+            }
+        }
 
-    std::uniform_int_distribution<> distribution(0, characters.size() - 1);
+        unsigned __int64 Next() {
+            const unsigned __int64 result = Rotl(m_state[1] * 5, 7) * 9;
+            const unsigned __int64 t = m_state[1] << 17;
+            m_state[2] ^= m_state[0];
+            m_state[3] ^= m_state[1];
+            m_state[1] ^= m_state[2];
+            m_state[0] ^= m_state[3];
+            m_state[2] ^= t;
+            m_state[3] = Rotl(m_state[3], 45);
+            return result;
+        }
 
-    std::string result;
-    for (size_t i = 0; i < length; ++i) {
-        result += characters[distribution(generator)];
+    private:
+        static unsigned __int64 Rotl(unsigned __int64 x, int k) { return (x << k) | (x >> (64 - k)); }
+
+        unsigned __int64 m_state[4];
+    };
+
+    thread_local TextRandom t_text_random;
+
+    void text_random_words(unsigned __int64* words, size_t count, bool secure) {
+        if (secure) {
+            if (!BCRYPT_SUCCESS(BCryptGenRandom(nullptr, reinterpret_cast<PUCHAR>(words), static_cast<ULONG>(count * sizeof(*words)), BCRYPT_USE_SYSTEM_PREFERRED_RNG))) {
+                throw std::runtime_error("BCryptGenRandom failed");
+            }
+            return;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            words[i] = t_text_random.Next();
+        }
     }
-    return result;
-}
 
-std::string __stdcall Text::text_random_alpha(size_t length) {
-    const std::string characters = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
-    std::random_device rd;
-    std::mt19937 generator(rd());
+    /*
+    * 64λΪ[0,1)ĶСÿγַȡΪ±
+    * ȡַ֤ĵ״̬2^32ַƫС2^-32ܾ
+    */
+    void text_random_fill(char* dst, size_t length, const char* characters, size_t count, bool secure) {
+        if (length == 0 || count == 0) {
+            return;
+        }
+        const unsigned __int64 radix = count;
+        size_t per_word = 0;
+        for (unsigned __int64 used = radix; used <= 0x100000000ULL && per_word < 32; used *= radix) {
+            ++per_word;
+        }
+        if (per_word == 0) {
+            per_word = 1;
+        }
 
-    std::uniform_int_distribution<> distribution(0, characters.size() - 1);
+        unsigned __int64 words[64];
+        size_t pos = 0;
+        while (pos < length) {
+            size_t batch = (length - pos + per_word - 1) / per_word;
+            if (batch > _countof(words)) {
+                batch = _countof(words);
+            }
+            text_random_words(words, batch, secure);
+            for (size_t w = 0; w < batch; ++w) {
+                unsigned __int64 fraction = words[w];
+                for (size_t k = 0; k < per_word && pos < length; ++k) {
+                    unsigned __int64 low = (fraction & 0xFFFFFFFF) * radix;
+                    unsigned __int64 high = (fraction >> 32) * radix + (low >> 32);
+                    dst[pos++] = characters[high >> 32];
+                    fraction = (high << 32) | (low & 0xFFFFFFFF);
+                }
+            }
+        }
+    }
 
-    std::string result;
-    for (size_t i = 0; i < length; ++i) {
-        result += characters[distribution(generator)];
+    std::string text_random_text(size_t length, const char* characters, size_t count, bool secure) {
+        std::string result(length, '\0');
+        text_random_fill(&result[0], length, characters, count, secure);
+        return result;
     }
-    return result;
 }
 
-std::string __stdcall Text::text_random_alnum(size_t length) {
-    const std::string characters = "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
-    std::random_device rd;
-    std::mt19937 generator(rd());
+std::string __stdcall Text::text_random_num(size_t length, bool secure) {
+    return text_random_text(length, g_text_random_num, sizeof(g_text_random_num) - 1, secure);
+}
 
-    std::uniform_int_distribution<> distribution(0, characters.size() - 1);
+std::string __stdcall Text::text_random_alpha(size_t length, bool secure) {
+    return text_random_text(length, g_text_random_alpha, sizeof(g_text_random_alpha) - 1, secure);
+}
 
-    std::string result;
-    for (size_t i = 0; i < length; ++i) {
-        result += characters[distribution(generator)];
-    }
-    return result;
+std::string __stdcall Text::text_random_alnum(size_t length, bool secure) {
+    return text_random_text(length, g_text_random_alnum, sizeof(g_text_random_alnum) - 1, secure);
 }
 
-std::string __stdcall Text::text_random_special(size_t length) {
-    const std::string characters = "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ!@#$%^&*()_+[]{}|;:,.<>?/";
-    std::random_device rd;
-    std::mt19937 generator(rd());
+std::string __stdcall Text::text_random_special(size_t length, bool secure) {
+    return text_random_text(length, g_text_random_special, sizeof(g_text_random_special) - 1, secure);
+}
 
-    std::uniform_int_distribution<> distribution(0, characters.size() - 1);
+std::string __stdcall Text::text_random_string(size_t length, const std::string& characters, bool secure) {
+    return text_random_text(characters.empty() ? 0 : length, characters.data(), characters.size(), secure);
+}
 
-    std::string result;
-    for (size_t i = 0; i < length; ++i) {
-        result += characters[distribution(generator)];
+std::vector<std::string> __stdcall Text::text_random_batch(size_t count, size_t length, const std::string& characters, bool secure) {
+    std::vector<std::string> result;
+    if (characters.empty()) {
+        result.resize(count);
+        return result;
+    }
+    // һȫַзΪַ
+    std::string buffer = text_random_text(count * length, characters.data(), characters.size(), secure);
+    result.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        result.emplace_back(buffer, i * length, length);
     }
     return result;
 }
@@ -228,66 +623,51 @@ std::string __stdcall Text::text_base64_decode(std::string text) {
     return decoded_text;
 }
 
+// °һתضϵʵʳ
 std::string __stdcall Text::text_gb2312_to_utf8(std::string text) {
-    // GB2312ַתΪUTF-8
-    int wideCharLength = MultiByteToWideChar(936 /* GB2312 */, 0, text.c_str(), -1, nullptr, 0);
-    if (wideCharLength == 0) {
-        throw std::runtime_error("Conversion to wide char failed");
-    }
-
-    std::wstring wideString(wideCharLength, L'\0');
-    MultiByteToWideChar(936, 0, text.c_str(), -1, &wideString[0], wideCharLength);
-
-    int utf8Length = WideCharToMultiByte(CP_UTF8, 0, wideString.c_str(), -1, nullptr, 0, nullptr, nullptr);
-    if (utf8Length == 0) {
-        throw std::runtime_error("Conversion to UTF-8 failed");
-    }
-
-    std::string utf8String(utf8Length, '\0');
-    WideCharToMultiByte(CP_UTF8, 0, wideString.c_str(), -1, &utf8String[0], utf8Length, nullptr, nullptr);
-
-    return utf8String;
+    std::string result(text.size() * 3, '\0');
+    result.resize(text_gb2312_to_utf8(text.data(), text.size(), &result[0], result.size()));
+    return result;
 }
 
 std::string __stdcall Text::text_utf8_to_gb2312(std::string text) {
-    // UTF-8ַתΪGB2312
-    int wideCharLength = MultiByteToWideChar(CP_UTF8, 0, text.c_str(), -1, nullptr, 0);
-    if (wideCharLength == 0) {
-        throw std::runtime_error("Conversion to wide char failed");
-    }
-
-    std::wstring wideString(wideCharLength, L'\0');
-    MultiByteToWideChar(CP_UTF8, 0, text.c_str(), -1, &wideString[0], wideCharLength);
-
-    int gb2312Length = WideCharToMultiByte(936 /* GB2312 */, 0, wideString.c_str(), -1, nullptr, 0, nullptr, nullptr);
-    if (gb2312Length == 0) {
-        throw std::runtime_error("Conversion to GB2312 failed");
-    }
-
-    std::string gb2312String(gb2312Length, '\0');
-    WideCharToMultiByte(936, 0, wideString.c_str(), -1, &gb2312String[0], gb2312Length, nullptr, nullptr);
-
-    return gb2312String;
+    std::string result(text.size(), '\0');
+    result.resize(text_utf8_to_gb2312(text.data(), text.size(), &result[0], result.size()));
+    return result;
 }
 
 std::string __stdcall Text::text_unicode_to_utf8(std::wstring text)
 {
-    int size_needed = WideCharToMultiByte(CP_UTF8, 0, text.c_str(), (int)text.size(), NULL, 0, NULL, NULL);
-    std::string result(size_needed, 0);
-    WideCharToMultiByte(CP_UTF8, 0, text.c_str(), (int)text.size(), &result[0], size_needed, NULL, NULL);
+    std::string result(text.size() * (sizeof(wchar_t) == 2 ? 3 : 4), '\0');
+    result.resize(text_unicode_to_utf8(text.data(), text.size(), &result[0], result.size()));
     return result;
 }
 
 std::wstring __stdcall Text::text_utf8_to_unicode(std::string text)
 {
-    int size_needed = MultiByteToWideChar(CP_UTF8, 0, text.c_str(), (int)text.size(), NULL, 0);
-    std::wstring result(size_needed, 0);
-    MultiByteToWideChar(CP_UTF8, 0, text.c_str(), (int)text.size(), &result[0], size_needed);
+    std::wstring result(text.size(), L'\0');
+    result.resize(text_utf8_to_unicode(text.data(), text.size(), &result[0], result.size()));
+    return result;
+}
+
+std::wstring __stdcall Text::text_gb2312_to_unicode(std::string text) {
+    std::wstring result(text.size(), L'\0');
+    result.resize(text_gb2312_to_unicode(text.data(), text.size(), &result[0], result.size()));
+    return result;
+}
+
+std::string __stdcall Text::text_unicode_to_gb2312(std::wstring text) {
+    std::string result(text.size() * 2, '\0');
+    result.resize(text_unicode_to_gb2312(text.data(), text.size(), &result[0], result.size()));
     return result;
 }
 
 std::string __stdcall Text::text_unicode_to_ascii(std::wstring text)
 {
+    // ASCIIı辭ϵͳҳ
+    if (text_ascii_length(text.data(), text.size()) == text.size()) {
+        return std::string(text.begin(), text.end());
+    }
     int size_needed = WideCharToMultiByte(CP_ACP, 0, text.c_str(), (int)text.size(), NULL, 0, NULL, NULL);
     std::string result(size_needed, 0);
     WideCharToMultiByte(CP_ACP, 0, text.c_str(), (int)text.size(), &result[0], size_needed, NULL, NULL);
@@ -296,43 +676,210 @@ std::string __stdcall Text::text_unicode_to_ascii(std::wstring text)
 
 std::wstring __stdcall Text::text_ascii_to_unicode(std::string text)
 {
+    if (text_ascii_length(text.data(), text.size()) == text.size()) {
+        return std::wstring(text.begin(), text.end());
+    }
     int size_needed = MultiByteToWideChar(CP_ACP, 0, text.c_str(), (int)text.size(), NULL, 0);
     std::wstring result(size_needed, 0);
     MultiByteToWideChar(CP_ACP, 0, text.c_str(), (int)text.size(), &result[0], size_needed);
     return result;
 }
 
+namespace {
+    // ÿֽڶӦ16ַ
+    struct TextHexTable {
+        char upper[512];
+        char lower[512];
+
+        TextHexTable() {
+            static const char digits_upper[] = "0123456789ABCDEF";
+            static const char digits_lower[] = "0123456789abcdef";
+            for (int i = 0; i < 256; ++i) {
+                upper[i * 2] = digits_upper[i >> 4];
+                upper[i * 2 + 1] = digits_upper[i & 15];
+                lower[i * 2] = digits_lower[i >> 4];
+                lower[i * 2 + 1] = digits_lower[i & 15];
+            }
+        }
+    };
+
+    const TextHexTable g_text_hex_table;
+
+    // ÿ4λӦĸ2ַ
+    const char g_text_bin_table[] =
+        "0000000100100011010001010110011110001001101010111100110111101111";
+
+    unsigned text_bit_width(unsigned __int64 value) {
+#if defined(_MSC_VER) && defined(_M_X64)
+        unsigned long index;
+        return _BitScanReverse64(&index, value) ? index + 1 : 0;
+#elif defined(_MSC_VER)
+        unsigned long index;
+        if (_BitScanReverse(&index, static_cast<unsigned long>(value >> 32))) {
+            return index + 33;
+        }
+        return _BitScanReverse(&index, static_cast<unsigned long>(value)) ? index + 1 : 0;
+#else
+        return value ? 64 - __builtin_clzll(value) : 0;
+#endif
+    }
+
+    // ȥոǰհ׼ţǷΪ stoll/stoull дһ£
+    bool text_strip_number(std::string& text) {
+        text.erase(std::remove(text.begin(), text.end(), ' '), text.end());
+        size_t start = 0;
+        while (start < text.size() && std::isspace(static_cast<unsigned char>(text[start]))) {
+            ++start;
+        }
+        bool negative = false;
+        if (start < text.size() && (text[start] == '+' || text[start] == '-')) {
+            negative = text[start] == '-';
+            ++start;
+        }
+        text.erase(0, start);
+        return negative;
+    }
+
+    // ʮƵ 0x ǰ׺ûʱ strtoll һֻ "0"
+    size_t text_hex_prefix_length(const std::string& hex) {
+        return (hex.size() > 2 && hex[0] == '0' && (hex[1] == 'x' || hex[1] == 'X') &&
+            std::isxdigit(static_cast<unsigned char>(hex[2]))) ? 2 : 0;
+    }
+}
+
+size_t __stdcall Text::text_format_hex(unsigned __int64 value, char* dst, bool upper)
+{
+    const char* table = upper ? g_text_hex_table.upper : g_text_hex_table.lower;
+    size_t length = value ? (text_bit_width(value) + 3) / 4 : 1;
+    size_t pos = length;
+    while (pos >= 2) {
+        pos -= 2;
+        memcpy(dst + pos, table + (value & 0xFF) * 2, 2);
+        value >>= 8;
+    }
+    if (pos) {
+        dst[0] = table[value * 2 + 1];
+    }
+    return length;
+}
+
+size_t __stdcall Text::text_format_bin(unsigned __int64 value, char* dst)
+{
+    size_t length = value ? text_bit_width(value) : 1;
+    size_t pos = length;
+    while (pos >= 4) {
+        pos -= 4;
+        memcpy(dst + pos, g_text_bin_table + (value & 15) * 4, 4);
+        value >>= 4;
+    }
+    if (pos) {
+        memcpy(dst, g_text_bin_table + (value & 15) * 4 + (4 - pos), pos);
+    }
+    return length;
+}
+
+size_t __stdcall Text::text_parse_hex(const char* src, size_t size, unsigned __int64& value)
+{
+    unsigned __int64 result = 0;
+    size_t i = 0;
+    for (; i < size; ++i) {
+        unsigned digit = static_cast<unsigned char>(src[i]) - '0';
+        if (digit >= 10) {
+            digit = (static_cast<unsigned char>(src[i]) | 0x20) - 'a';
+            if (digit >= 6) {
+                break;
+            }
+            digit += 10;
+        }
+        if (result >> 60) {
+            return std::string::npos;
+        }
+        result = (result << 4) | digit;
+    }
+    value = result;
+    return i;
+}
+
+size_t __stdcall Text::text_parse_bin(const char* src, size_t size, unsigned __int64& value)
+{
+    unsigned __int64 result = 0;
+    size_t i = 0;
+    for (; i < size; ++i) {
+        unsigned digit = static_cast<unsigned char>(src[i]) - '0';
+        if (digit >= 2) {
+            break;
+        }
+        if (result >> 63) {
+            return std::string::npos;
+        }
+        result = (result << 1) | digit;
+    }
+    value = result;
+    return i;
+}
+
+size_t __stdcall Text::text_hex_dump(const void* data, size_t size, char* dst, bool upper)
+{
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    const char* table = upper ? g_text_hex_table.upper : g_text_hex_table.lower;
+    for (size_t i = 0; i < size; ++i) {
+        memcpy(dst + i * 2, table + bytes[i] * 2, 2);
+    }
+    return size * 2;
+}
+
+std::string __stdcall Text::text_hex_dump(const void* data, size_t size, bool upper)
+{
+    std::string result(size * 2, '\0');
+    text_hex_dump(data, size, &result[0], upper);
+    return result;
+}
+
 std::string __stdcall Text::text_10_to_16(__int64 num)
 {
-    std::stringstream ss{};
-    ss << std::hex << std::uppercase << num;
-    return ss.str();
+    char buffer[16];
+    return std::string(buffer, text_format_hex(static_cast<unsigned __int64>(num), buffer));
 }
 
 __int64 __stdcall Text::text_16_to_10(std::string hex)
 {
+    // ԭһȥո񼰿ͷ 0xԿпհסżڶ 0x
     hex.erase(std::remove(hex.begin(), hex.end(), ' '), hex.end());
-    if (hex.find("0x") == 0 || hex.find("0X") == 0) {
-        hex = hex.substr(2);
+    if (hex.size() >= 2 && hex[0] == '0' && (hex[1] == 'x' || hex[1] == 'X')) {
+        hex.erase(0, 2);
+    }
+    bool negative = text_strip_number(hex);
+    size_t start = text_hex_prefix_length(hex);
+
+    unsigned __int64 value = 0;
+    size_t parsed = text_parse_hex(hex.data() + start, hex.size() - start, value);
+    if (parsed == 0) {
+        throw std::invalid_argument("stoll");
     }
-    
-    return std::stoll(hex, nullptr, 16);
+    const unsigned __int64 limit = static_cast<unsigned __int64>(LLONG_MAX) + (negative ? 1 : 0);
+    if (parsed == std::string::npos || value > limit) {
+        throw std::out_of_range("stoll");
+    }
+    return negative ? static_cast<__int64>(0 - value) : static_cast<__int64>(value);
 }
 
 std::string __stdcall Text::text_10_to_2(size_t num)
 {
-    if (num == 0) return "0";
-    
-    std::string bin;
-    while (num > 0) {
-        bin = (num % 2 ? "1" : "0") + bin;
-        num /= 2;
-    }
-    return bin;
+    char buffer[64];
+    return std::string(buffer, text_format_bin(num, buffer));
 }
 
 size_t __stdcall Text::text_2_to_10(std::string bin)
 {
-    bin.erase(std::remove(bin.begin(), bin.end(), ' '), bin.end());
-    return static_cast<size_t>(std::stoull(bin, nullptr, 2));
+    bool negative = text_strip_number(bin);
+
+    unsigned __int64 value = 0;
+    size_t parsed = text_parse_bin(bin.data(), bin.size(), value);
+    if (parsed == 0) {
+        throw std::invalid_argument("stoull");
+    }
+    if (parsed == std::string::npos) {
+        throw std::out_of_range("stoull");
+    }
+    return static_cast<size_t>(negative ? 0 - value : value);
 }
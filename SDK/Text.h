@@ -1,9 +1,42 @@
 #pragma once
 #include <string>
+#include <utility>
 #include <vector>
+#include "TextCodec.h"
 namespace Text {
 	static const std::string base64_chars = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
 	/*
+	* ַ(256λλͼ)ڷָʱַ
+	* ַ8ʱʹSSE2ֽڱȽϣ֧SSSE3CPUʹPSHUFB
+	*/
+	class TextCharSet {
+	public:
+		TextCharSet() = default;
+		explicit TextCharSet(const std::string& chars);
+		bool Contains(unsigned char ch) const { return (m_bitmap[ch >> 5] >> (ch & 31)) & 1; }
+		/*
+		* ַ_Ѱ
+		* @param data ҵ
+		* @param size ݳ
+		* @param pos ʼλ
+		* @return һַַλãδҵstd::string::npos
+		*/
+		size_t Find(const char* data, size_t size, size_t pos = 0) const;
+
+	private:
+		unsigned int m_bitmap[8]{};
+		unsigned char m_nibble[32]{};   // 4λλͼǰ16Ӧ4λ0~716Ӧ8~15
+		char m_chars[8]{};
+		size_t m_count = 0;             // ַͬ
+	};
+	/*
+	* ı_ַָ
+	* @param text ָı
+	* @param delimiters ַָ
+	* @return ָı(ı)
+	*/
+	std::vector<std::string> __stdcall text_split_any(const std::string& text, const TextCharSet& delimiters);
+	/*
 	* ı_ָ
 	* @param text ָı
 	* @param delimiters ָ
@@ -11,26 +44,16 @@ namespace Text {
 	*/
 	template<typename... Delimiters>
 	std::vector<std::string> text_split(std::string text, Delimiters... delimiters) {
-		std::vector<std::string> result;
-
-		// зָϲΪһַ
-		std::string allDelimiters = (std::string(delimiters) + ...);
-
-		// ʹ÷ָָı
-		std::string::size_type pos1 = 0, pos2 = 0;
-		while ((pos2 = text.find_first_of(allDelimiters, pos1)) != std::string::npos) {
-			if (pos2 > pos1) {
-				result.push_back(text.substr(pos1, pos2 - pos1));
-			}
-			pos1 = pos2 + 1; // ָ
-		}
-		if (pos1 < text.length()) {
-			result.push_back(text.substr(pos1));
-		}
-
-		return result;
+		// зָϲΪһַ
+		return text_split_any(text, TextCharSet((std::string(delimiters) + ...)));
 	}
 	/*
+	* ı_ָ
+	* @param text ָı
+	* @return ָ飬֧\n\r\n
+	*/
+	std::vector<std::string> __stdcall text_split_lines(const std::string& text);
+	/*
 	* ı_ϲ
 	* @param text_list ϲı
 	* @param delimiter ӷ
@@ -75,7 +98,37 @@ namespace Text {
 	*/
 	std::string __stdcall text_replace(std::string text, std::string find_text, std::string replace_text, size_t count = -1);
 	/*
-	* ı_תַ(֧)
+	* ģʽ滻(Aho-CorasickԶ)
+	* ʱһΣɶԶıظʹãƥΪص
+	*/
+	class TextReplacer {
+	public:
+		TextReplacer() = default;
+		explicit TextReplacer(const std::vector<std::pair<std::string, std::string>>& pairs);
+		/*
+		* 滻_滻
+		* @param text 滻ı
+		* @return 滻ı
+		*/
+		std::string Replace(const std::string& text) const;
+		bool IsEmpty() const { return m_vecReplace.empty(); }
+
+	private:
+		std::vector<int> m_vecGoto;         // ״̬תƱÿ״̬256
+		std::vector<int> m_vecDepth;        // ״̬
+		std::vector<int> m_vecOutput;       // Ը״̬βģʽ±꣬-1ʾ
+		std::vector<std::string> m_vecFind;
+		std::vector<std::string> m_vecReplace;
+	};
+	/*
+	* ı_ģʽ滻
+	* @param text 滻ı
+	* @param pairs ı滻ıбͬһıȳΪ׼
+	* @return 滻ı
+	*/
+	std::string __stdcall text_replace_multi(std::string text, const std::vector<std::pair<std::string, std::string>>& pairs);
+	/*
+	* ı_תַ(ϵͳҳת)
 	* @param text תı
 	* @return תı
 	*/
@@ -89,27 +142,48 @@ namespace Text {
 	/*
 	* ı_ȡַ()
 	* @param length ַ (Ĭ10)
+	* @param secure Ƿʹϵͳѧ(Ƶ)Ĭʹ߳xoshiro256**
 	* @return ַ
 	*/
-	std::string __stdcall text_random_num(size_t length = 10);
+	std::string __stdcall text_random_num(size_t length = 10, bool secure = false);
 	/*
 	* ı_ȡַ(ĸ)
 	* @param length ַ (Ĭ10)
+	* @param secure Ƿʹϵͳѧ
 	* @return ַ
 	*/
-	std::string __stdcall text_random_alpha(size_t length = 10);
+	std::string __stdcall text_random_alpha(size_t length = 10, bool secure = false);
 	/*
 	* ı_ȡַ(ĸ+)
 	* @param length ַ (Ĭ10)
+	* @param secure Ƿʹϵͳѧ
 	* @return ַ
 	*/
-	std::string __stdcall text_random_alnum(size_t length = 10);
+	std::string __stdcall text_random_alnum(size_t length = 10, bool secure = false);
 	/*
 	* ı_ȡַ(ĸ++ַ)
 	* @param length ַ (Ĭ10)
+	* @param secure Ƿʹϵͳѧ
+	* @return ַ
+	*/
+	std::string __stdcall text_random_special(size_t length = 10, bool secure = false);
+	/*
+	* ı_ȡַ(ַָ)
+	* @param length ַ
+	* @param characters ַ
+	* @param secure Ƿʹϵͳѧ
 	* @return ַ
 	*/
-	std::string __stdcall text_random_special(size_t length = 10);
+	std::string __stdcall text_random_string(size_t length, const std::string& characters, bool secure = false);
+	/*
+	* ı_ȡַ
+	* @param count ַ
+	* @param length ÿַĳ
+	* @param characters ַ
+	* @param secure Ƿʹϵͳѧ
+	* @return ַ
+	*/
+	std::vector<std::string> __stdcall text_random_batch(size_t count, size_t length, const std::string& characters, bool secure = false);
 	//====================================ת====================================
 	/*
 	* ı_base64
@@ -159,6 +233,18 @@ namespace Text {
 	* @return תı
 	*/
 	std::wstring __stdcall text_ascii_to_unicode(std::string text);
+	/*
+	* ı_GB2312תUnicode
+	* @param text תı
+	* @return תı
+	*/
+	std::wstring __stdcall text_gb2312_to_unicode(std::string text);
+	/*
+	* ı_UnicodeתGB2312
+	* @param text תı
+	* @return תı
+	*/
+	std::string __stdcall text_unicode_to_gb2312(std::wstring text);
 	//====================================ת====================================
 	/*
 	* ı_10ת16
@@ -184,4 +270,39 @@ namespace Text {
 	* @return תʮ
 	*/
 	size_t __stdcall text_2_to_10(std::string bin);
+	/*
+	* Ϊд߻Ľתʱ
+	* ı_ʽ16
+	* @param value ת
+	* @param dst 16ֽ
+	* @param upper Ƿʹôдĸ
+	* @return дַ
+	*/
+	size_t __stdcall text_format_hex(unsigned __int64 value, char* dst, bool upper = true);
+	/*
+	* ı_ʽ2
+	* @param value ת
+	* @param dst 64ֽ
+	* @return дַ
+	*/
+	size_t __stdcall text_format_bin(unsigned __int64 value, char* dst);
+	/*
+	* ı_16/2
+	* @param src ı(ǰ׺)Ƿַֹͣ
+	* @param size ı
+	* @param value 
+	* @return ַûЧַ0std::string::npos
+	*/
+	size_t __stdcall text_parse_hex(const char* src, size_t size, unsigned __int64& value);
+	size_t __stdcall text_parse_bin(const char* src, size_t size, unsigned __int64& value);
+	/*
+	* ı_ֽڼת16
+	* @param data ת
+	* @param size ݳ
+	* @param dst size*2ֽ
+	* @param upper Ƿʹôдĸ
+	* @return дַ
+	*/
+	size_t __stdcall text_hex_dump(const void* data, size_t size, char* dst, bool upper = true);
+	std::string __stdcall text_hex_dump(const void* data, size_t size, bool upper = true);
 };
\ No newline at end of file
@@ -0,0 +1,242 @@
+#include "TextCodec.h"
+#include "TextGbkTable.h"
+#include <string>
+#include <algorithm>
+#include <type_traits>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define TEXT_SIMD 1
+#include <emmintrin.h>
+#else
+#define TEXT_SIMD 0
+#endif
+
+namespace {
+    const unsigned text_replacement_char = 0xFFFD;
+
+    // д߻dstΪnullptrʱֻۼƳ
+    template<typename T>
+    struct TextWriter {
+        T* dst;
+        size_t capacity;
+        size_t size = 0;
+        bool overflow = false;
+
+        TextWriter(T* dst, size_t capacity) : dst(dst), capacity(capacity) {}
+
+        void Put(unsigned value) {
+            if (dst) {
+                if (size >= capacity) {
+                    overflow = true;
+                    return;
+                }
+                dst[size] = static_cast<T>(value);
+            }
+            ++size;
+        }
+
+        template<typename S>
+        void Append(const S* src, size_t count) {
+            if (dst) {
+                if (capacity - size < count) {
+                    overflow = true;
+                    return;
+                }
+                std::copy(src, src + count, dst + size);
+            }
+            size += count;
+        }
+    };
+
+    // ؿͷASCIIַĸ
+    size_t text_ascii_run(const char* src, size_t size) {
+        const unsigned char* data = reinterpret_cast<const unsigned char*>(src);
+        size_t i = 0;
+#if TEXT_SIMD
+        for (; i + 32 <= size; i += 32) {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 16));
+            if (_mm_movemask_epi8(_mm_or_si128(a, b)) != 0) {
+                break;
+            }
+        }
+        for (; i + 16 <= size; i += 16) {
+            // зASCIIֽʱֽڶλ
+            if (_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i))) != 0) {
+                break;
+            }
+        }
+#endif
+        while (i < size && data[i] < 0x80) {
+            ++i;
+        }
+        return i;
+    }
+
+    size_t text_ascii_run(const wchar_t* src, size_t size) {
+        size_t i = 0;
+#if TEXT_SIMD
+        if (sizeof(wchar_t) == 2) {
+            const __m128i high_bits = _mm_set1_epi16(static_cast<short>(0xFF80));
+            const __m128i zero = _mm_setzero_si128();
+            for (; i + 16 <= size; i += 16) {
+                __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+                __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 8));
+                __m128i bits = _mm_and_si128(_mm_or_si128(a, b), high_bits);
+                if (_mm_movemask_epi8(_mm_cmpeq_epi16(bits, zero)) != 0xffff) {
+                    break;
+                }
+            }
+        }
+#endif
+        while (i < size && static_cast<unsigned>(src[i]) < 0x80) {
+            ++i;
+        }
+        return i;
+    }
+
+    unsigned text_decode_utf8(const char* src, size_t size, size_t& i) {
+        const unsigned char* data = reinterpret_cast<const unsigned char*>(src);
+        unsigned ch = data[i];
+        size_t length;
+        unsigned code, minimum;
+        if ((ch & 0xE0) == 0xC0) {
+            length = 2, code = ch & 0x1F, minimum = 0x80;
+        } else if ((ch & 0xF0) == 0xE0) {
+            length = 3, code = ch & 0x0F, minimum = 0x800;
+        } else if ((ch & 0xF8) == 0xF0) {
+            length = 4, code = ch & 0x07, minimum = 0x10000;
+        } else {
+            ++i;
+            return ch < 0x80 ? ch : text_replacement_char;
+        }
+        size_t k = 1;
+        for (; k < length && i + k < size && (data[i + k] & 0xC0) == 0x80; ++k) {
+            code = (code << 6) | (data[i + k] & 0x3F);
+        }
+        i += k;
+        if (k < length || code < minimum || code > 0x10FFFF || (code >= 0xD800 && code <= 0xDFFF)) {
+            return text_replacement_char;
+        }
+        return code;
+    }
+
+    unsigned text_decode_utf16(const wchar_t* src, size_t size, size_t& i) {
+        unsigned ch = static_cast<unsigned>(src[i++]);
+        if (ch >= 0xD800 && ch <= 0xDBFF) {
+            if (i < size && static_cast<unsigned>(src[i]) >= 0xDC00 && static_cast<unsigned>(src[i]) <= 0xDFFF) {
+                return 0x10000 + ((ch - 0xD800) << 10) + (static_cast<unsigned>(src[i++]) - 0xDC00);
+            }
+            return text_replacement_char;
+        }
+        if ((ch >= 0xDC00 && ch <= 0xDFFF) || ch > 0x10FFFF) {
+            return text_replacement_char;
+        }
+        return ch;
+    }
+
+    unsigned text_decode_gbk(const char* src, size_t size, size_t& i) {
+        const unsigned char* data = reinterpret_cast<const unsigned char*>(src);
+        unsigned ch = data[i];
+        if (ch >= 0x81 && ch <= 0xFE && i + 1 < size && data[i + 1] >= 0x40 && data[i + 1] <= 0xFE) {
+            unsigned short code = g_text_gbk_to_unicode[(ch - 0x81) * g_text_gbk_trail_count + (data[i + 1] - 0x40)];
+            if (code) {
+                i += 2;
+                return code;
+            }
+        }
+        ++i;
+        if (ch < 0x80) {
+            return ch;
+        }
+        // ֽڸλַֻ0x80(ŷԪ)ӳ
+        return ch == 0x80 ? 0x20AC : text_replacement_char;
+    }
+
+    void text_encode_utf8(TextWriter<char>& writer, unsigned code) {
+        if (code < 0x80) {
+            writer.Put(code);
+        } else if (code < 0x800) {
+            writer.Put(0xC0 | (code >> 6));
+            writer.Put(0x80 | (code & 0x3F));
+        } else if (code < 0x10000) {
+            writer.Put(0xE0 | (code >> 12));
+            writer.Put(0x80 | ((code >> 6) & 0x3F));
+            writer.Put(0x80 | (code & 0x3F));
+        } else {
+            writer.Put(0xF0 | (code >> 18));
+            writer.Put(0x80 | ((code >> 12) & 0x3F));
+            writer.Put(0x80 | ((code >> 6) & 0x3F));
+            writer.Put(0x80 | (code & 0x3F));
+        }
+    }
+
+    void text_encode_utf16(TextWriter<wchar_t>& writer, unsigned code) {
+        if (code < 0x10000 || sizeof(wchar_t) > 2) {
+            writer.Put(code);
+        } else {
+            code -= 0x10000;
+            writer.Put(0xD800 | (code >> 10));
+            writer.Put(0xDC00 | (code & 0x3FF));
+        }
+    }
+
+    void text_encode_gbk(TextWriter<char>& writer, unsigned code) {
+        unsigned short gbk = code < 0x10000 ? g_text_gbk_from_unicode[g_text_gbk_page[code >> 8] * 0x100 + (code & 0xFF)] : 0;
+        if (gbk > 0xFF) {
+            writer.Put(gbk >> 8);
+            writer.Put(gbk & 0xFF);
+        } else {
+            writer.Put(gbk ? gbk : '?');
+        }
+    }
+
+    // ͨת̣ASCIIοַٱ
+    template<typename S, typename T, typename Decode, typename Encode>
+    size_t text_transcode(const S* src, size_t size, T* dst, size_t capacity, Decode decode, Encode encode) {
+        TextWriter<T> writer(dst, capacity);
+        size_t i = 0;
+        while (i < size && !writer.overflow) {
+            if (static_cast<unsigned>(static_cast<typename std::make_unsigned<S>::type>(src[i])) < 0x80) {
+                size_t run = text_ascii_run(src + i, size - i);
+                writer.Append(src + i, run);
+                i += run;
+                continue;
+            }
+            encode(writer, decode(src, size, i));
+        }
+        return writer.overflow ? std::string::npos : writer.size;
+    }
+}
+
+size_t __stdcall Text::text_gb2312_to_utf8(const char* src, size_t size, char* dst, size_t capacity) {
+    return text_transcode(src, size, dst, capacity, text_decode_gbk, text_encode_utf8);
+}
+
+size_t __stdcall Text::text_utf8_to_gb2312(const char* src, size_t size, char* dst, size_t capacity) {
+    return text_transcode(src, size, dst, capacity, text_decode_utf8, text_encode_gbk);
+}
+
+size_t __stdcall Text::text_unicode_to_utf8(const wchar_t* src, size_t size, char* dst, size_t capacity) {
+    return text_transcode(src, size, dst, capacity, text_decode_utf16, text_encode_utf8);
+}
+
+size_t __stdcall Text::text_utf8_to_unicode(const char* src, size_t size, wchar_t* dst, size_t capacity) {
+    return text_transcode(src, size, dst, capacity, text_decode_utf8, text_encode_utf16);
+}
+
+size_t __stdcall Text::text_gb2312_to_unicode(const char* src, size_t size, wchar_t* dst, size_t capacity) {
+    return text_transcode(src, size, dst, capacity, text_decode_gbk, text_encode_utf16);
+}
+
+size_t __stdcall Text::text_unicode_to_gb2312(const wchar_t* src, size_t size, char* dst, size_t capacity) {
+    return text_transcode(src, size, dst, capacity, text_decode_utf16, text_encode_gbk);
+}
+
+size_t __stdcall Text::text_ascii_length(const char* src, size_t size) {
+    return text_ascii_run(src, size);
+}
+
+size_t __stdcall Text::text_ascii_length(const wchar_t* src, size_t size) {
+    return text_ascii_run(src, size);
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <cstddef>
+
+#if !defined(_WIN32) && !defined(__stdcall)
+#define __stdcall
+#endif
+
+// תģϵͳҳڷWindowsƽ̨
+namespace Text {
+	/*
+	* Ϊд߻ıתʱ
+	* Ƿ滻ΪU+FFFDGB2312޶Ӧַʱ'?'
+	* @param src ת
+	* @param size ݳ(ַ)
+	* @param dst Ϊnullptrʱ賤
+	* @param capacity (ַ)
+	* @return дַ㷵std::string::npos
+	*/
+	size_t __stdcall text_gb2312_to_utf8(const char* src, size_t size, char* dst, size_t capacity);
+	size_t __stdcall text_utf8_to_gb2312(const char* src, size_t size, char* dst, size_t capacity);
+	size_t __stdcall text_unicode_to_utf8(const wchar_t* src, size_t size, char* dst, size_t capacity);
+	size_t __stdcall text_utf8_to_unicode(const char* src, size_t size, wchar_t* dst, size_t capacity);
+	size_t __stdcall text_gb2312_to_unicode(const char* src, size_t size, wchar_t* dst, size_t capacity);
+	size_t __stdcall text_unicode_to_gb2312(const wchar_t* src, size_t size, char* dst, size_t capacity);
+	/*
+	* ı_ȡASCIIǰ׺
+	* @param src 
+	* @param size ݳ(ַ)
+	* @return ͷASCIIַĸ
+	*/
+	size_t __stdcall text_ascii_length(const char* src, size_t size);
+	size_t __stdcall text_ascii_length(const wchar_t* src, size_t size);
+}
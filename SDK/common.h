@@ -186,7 +186,8 @@ enum {
 
 enum {
 	CORE_OPTION_MEMORY_PROTECTION = 0x1,
-	CORE_OPTION_CHECK_DEBUGGER = 0x2
+	CORE_OPTION_CHECK_DEBUGGER = 0x2,
+	CORE_OPTION_PARALLEL_CRC = 0x4
 };
 
 enum {
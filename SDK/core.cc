@@ -156,15 +156,249 @@ struct CRCData {
 	uint32_t Table;
 	uint32_t Size;
 	uint32_t Hash;
+	uint32_t Options;
 	NOINLINE CRCData()
 	{
 		ImageBase = reinterpret_cast<uint8_t *>(FACE_IMAGE_BASE);
 		Table = FACE_CRC_TABLE_ENTRY;
 		Size = FACE_CRC_TABLE_SIZE;
 		Hash = FACE_CRC_TABLE_HASH;
+		Options = FACE_CORE_OPTIONS;
 	}
 };
 
+/**
+ * CRC check of the image
+ *
+ * By default the regions of a CRC_INFO table are hashed one by one on the calling thread, decrypting
+ * each entry as it is read. With CORE_OPTION_PARALLEL_CRC a large table is instead cut into blocks of
+ * at most CRC_BLOCK_SIZE bytes that the calling thread and up to CRC_MAX_WORKERS helpers claim one at
+ * a time; a region that is a single block is compared as soon as it is hashed, so the first mismatch
+ * stops every thread, and the hashes of split regions are joined with CombineCRC at the end.
+ */
+
+#define CRC_BLOCK_SIZE 0x100000
+#define CRC_MAX_WORKERS 3
+#define CRC_PARALLEL_SIZE 0x800000
+
+struct CRCBlock {
+	uint32_t Region;
+	uint32_t Offset;
+	uint32_t Size;
+	uint32_t Hash;
+};
+
+struct CRCCheckJob {
+	uint8_t *image_base;
+	CRC_INFO *regions;
+	CRCBlock *blocks;
+	size_t block_count;
+	volatile long next_block;
+	volatile long failed;
+};
+
+static void CheckCRCBlocks(CRCCheckJob *job)
+{
+	while (!job->failed) {
+#ifdef VMP_GNU
+		size_t i = static_cast<size_t>(__sync_fetch_and_add(&job->next_block, 1));
+#else
+		size_t i = static_cast<size_t>(InterlockedIncrement(&job->next_block) - 1);
+#endif
+		if (i >= job->block_count)
+			break;
+		CRCBlock &block = job->blocks[i];
+		const CRC_INFO &crc_info = job->regions[block.Region];
+		block.Hash = CalcCRC(job->image_base + crc_info.Address + block.Offset, block.Size);
+		if (block.Size == crc_info.Size && block.Hash != crc_info.Hash)
+			job->failed = true;
+	}
+}
+
+#ifdef VMP_GNU
+static void *CRCWorkerProc(void *param)
+{
+	CheckCRCBlocks(reinterpret_cast<CRCCheckJob *>(param));
+	return NULL;
+}
+#elif !defined(WIN_DRIVER)
+static DWORD WINAPI CRCWorkerProc(LPVOID param)
+{
+	CheckCRCBlocks(reinterpret_cast<CRCCheckJob *>(param));
+	return 0;
+}
+#endif
+
+static bool CanStartCRCWorkers()
+{
+#ifdef VMP_GNU
+	return true;
+#elif defined(WIN_DRIVER)
+	return false;
+#else
+	// DllMain and TLS callbacks run under the loader lock, and a new thread does not start before it is released
+#ifdef _WIN64
+	PEB64 *peb = reinterpret_cast<PEB64 *>(__readgsqword(0x60));
+#else
+	PEB32 *peb = reinterpret_cast<PEB32 *>(__readfsdword(0x30));
+#endif
+	RTL_CRITICAL_SECTION *loader_lock = reinterpret_cast<RTL_CRITICAL_SECTION *>(static_cast<size_t>(peb->LoaderLock));
+	return !loader_lock || loader_lock->OwningThread != reinterpret_cast<HANDLE>(static_cast<size_t>(GetCurrentThreadId()));
+#endif
+}
+
+static size_t CRCWorkerCount(size_t total_size)
+{
+	if (total_size < CRC_PARALLEL_SIZE)
+		return 0;
+	size_t cpu_count;
+#ifdef VMP_GNU
+	long n = sysconf(_SC_NPROCESSORS_ONLN);
+	cpu_count = (n > 0) ? static_cast<size_t>(n) : 1;
+#elif defined(WIN_DRIVER)
+	cpu_count = 1;
+#else
+	SYSTEM_INFO system_info;
+	GetSystemInfo(&system_info);
+	cpu_count = system_info.dwNumberOfProcessors;
+#endif
+	size_t res = (cpu_count > 1) ? cpu_count - 1 : 0;
+	return (res > CRC_MAX_WORKERS) ? CRC_MAX_WORKERS : res;
+}
+
+static void RunCRCCheckJob(CRCCheckJob *job, size_t worker_count)
+{
+#ifdef VMP_GNU
+	pthread_t workers[CRC_MAX_WORKERS];
+	size_t started = 0;
+	for (; started < worker_count; started++) {
+		if (pthread_create(&workers[started], NULL, CRCWorkerProc, job) != 0)
+			break;
+	}
+	CheckCRCBlocks(job);
+	for (size_t i = 0; i < started; i++) {
+		pthread_join(workers[i], NULL);
+	}
+#elif defined(WIN_DRIVER)
+	(void)worker_count;
+	CheckCRCBlocks(job);
+#else
+	HANDLE workers[CRC_MAX_WORKERS];
+	DWORD started = 0;
+	for (; started < worker_count; started++) {
+		workers[started] = CreateThread(NULL, 0, CRCWorkerProc, job, 0, NULL);
+		if (!workers[started])
+			break;
+	}
+	CheckCRCBlocks(job);
+	if (started) {
+		WaitForMultipleObjects(started, workers, TRUE, INFINITE);
+		for (DWORD i = 0; i < started; i++) {
+			CloseHandle(workers[i]);
+		}
+	}
+#endif
+}
+
+static void DecryptCRCInfo(CRCValueCryptor &crc_cryptor, CRC_INFO &crc_info)
+{
+	crc_info.Address = crc_cryptor.Decrypt(crc_info.Address);
+	crc_info.Size = crc_cryptor.Decrypt(crc_info.Size);
+	crc_info.Hash = crc_cryptor.Decrypt(crc_info.Hash);
+}
+
+static size_t CRCTableDataSize(const uint8_t *crc_table, size_t table_count, uint32_t image_size)
+{
+	size_t res = 0;
+	CRCValueCryptor crc_cryptor;
+	for (size_t i = 0; i < table_count; i++) {
+		CRC_INFO crc_info = reinterpret_cast<const CRC_INFO *>(crc_table)[i];
+		DecryptCRCInfo(crc_cryptor, crc_info);
+		if (image_size && image_size < crc_info.Address + crc_info.Size)
+			continue; // discardable sections of a driver
+		res += crc_info.Size;
+	}
+	return res;
+}
+
+static bool CheckCRCRegions(uint8_t *image_base, const uint8_t *crc_table, size_t table_count, uint32_t image_size)
+{
+	CRCValueCryptor crc_cryptor;
+	for (size_t i = 0; i < table_count; i++) {
+		CRC_INFO crc_info = reinterpret_cast<const CRC_INFO *>(crc_table)[i];
+		DecryptCRCInfo(crc_cryptor, crc_info);
+		if (image_size && image_size < crc_info.Address + crc_info.Size)
+			continue; // discardable sections of a driver
+		if (crc_info.Hash != CalcCRC(image_base + crc_info.Address, crc_info.Size))
+			return false;
+	}
+	return true;
+}
+
+static bool CheckCRCRegionsParallel(uint8_t *image_base, const uint8_t *crc_table, size_t table_count, uint32_t image_size, size_t worker_count)
+{
+	// the entries are chained through the cryptor, so decrypt them all before splitting the work
+	CRC_INFO *regions = new CRC_INFO[table_count];
+	size_t region_count = 0;
+	size_t block_count = 0;
+	CRCValueCryptor crc_cryptor;
+	for (size_t i = 0; i < table_count; i++) {
+		CRC_INFO crc_info = reinterpret_cast<const CRC_INFO *>(crc_table)[i];
+		DecryptCRCInfo(crc_cryptor, crc_info);
+		if (image_size && image_size < crc_info.Address + crc_info.Size)
+			continue; // discardable sections of a driver
+		regions[region_count++] = crc_info;
+		block_count += crc_info.Size ? (crc_info.Size + CRC_BLOCK_SIZE - 1) / CRC_BLOCK_SIZE : 1;
+	}
+
+	CRCCheckJob job;
+	job.image_base = image_base;
+	job.regions = regions;
+	job.blocks = new CRCBlock[block_count];
+	job.block_count = block_count;
+	job.next_block = 0;
+	job.failed = false;
+	for (size_t i = 0, k = 0; i < region_count; i++) {
+		uint32_t offset = 0;
+		do {
+			CRCBlock &block = job.blocks[k++];
+			block.Region = static_cast<uint32_t>(i);
+			block.Offset = offset;
+			block.Size = (regions[i].Size - offset > CRC_BLOCK_SIZE) ? CRC_BLOCK_SIZE : regions[i].Size - offset;
+			offset += block.Size;
+		} while (offset < regions[i].Size);
+	}
+
+	RunCRCCheckJob(&job, worker_count);
+
+	bool res = !job.failed;
+	for (size_t k = 0; res && k < block_count; ) {
+		const CRC_INFO &crc_info = regions[job.blocks[k].Region];
+		uint32_t hash = job.blocks[k++].Hash;
+		for (; k < block_count && job.blocks[k].Offset; k++) {
+			hash = CombineCRC(hash, job.blocks[k].Hash, job.blocks[k].Size);
+		}
+		if (hash != crc_info.Hash)
+			res = false;
+	}
+
+	delete [] job.blocks;
+	delete [] regions;
+	return res;
+}
+
+static bool CheckCRCTable(uint8_t *image_base, uint8_t *crc_table, uint32_t crc_table_size, uint32_t crc_table_hash, uint32_t image_size, bool parallel)
+{
+	if (crc_table_hash != CalcCRC(crc_table, crc_table_size))
+		return false;
+
+	size_t table_count = crc_table_size / sizeof(CRC_INFO);
+	size_t worker_count = parallel ? CRCWorkerCount(CRCTableDataSize(crc_table, table_count, image_size)) : 0;
+	if (!worker_count)
+		return CheckCRCRegions(image_base, crc_table, table_count, image_size);
+	return CheckCRCRegionsParallel(image_base, crc_table, table_count, image_size, worker_count);
+}
+
 bool WINAPI ExportedIsValidImageCRC()
 {
 	if (loader_data->is_patch_detected())
@@ -178,8 +412,8 @@ bool WINAPI ExportedIsValidImageCRC()
 	uint32_t crc_table_size = *reinterpret_cast<uint32_t *>(image_base + crc_data.Size);
 	uint32_t crc_table_hash = *reinterpret_cast<uint32_t *>(image_base + crc_data.Hash);
 
-#ifdef WIN_DRIVER
 	uint32_t image_size = 0;
+#ifdef WIN_DRIVER
 	if (loader_data->loader_status() == STATUS_SUCCESS) {
 		IMAGE_DOS_HEADER *dos_header = reinterpret_cast<IMAGE_DOS_HEADER *>(image_base);
 		if (dos_header->e_magic == IMAGE_DOS_SIGNATURE) {
@@ -198,48 +432,19 @@ bool WINAPI ExportedIsValidImageCRC()
 	}
 #endif
 
+	// helper threads are opt-in and never started under the loader lock
+	bool parallel = (crc_data.Options & CORE_OPTION_PARALLEL_CRC) && CanStartCRCWorkers();
+
 	// check memory CRC
-	{
-		if (crc_table_hash != CalcCRC(crc_table, crc_table_size))
-			res = false;
-		CRCValueCryptor crc_cryptor;
-		for (size_t i = 0; i < crc_table_size; i += sizeof(CRC_INFO)) {
-			CRC_INFO crc_info = *reinterpret_cast<CRC_INFO *>(crc_table + i);
-			crc_info.Address = crc_cryptor.Decrypt(crc_info.Address);
-			crc_info.Size = crc_cryptor.Decrypt(crc_info.Size);
-			crc_info.Hash = crc_cryptor.Decrypt(crc_info.Hash);
-#ifdef WIN_DRIVER
-			if (image_size && image_size < crc_info.Address + crc_info.Size)
-				continue;
-#endif
-		
-			if (crc_info.Hash != CalcCRC(image_base + crc_info.Address, crc_info.Size))
-				res = false;
-		}
-	}
+	if (!CheckCRCTable(image_base, crc_table, crc_table_size, crc_table_hash, image_size, parallel))
+		res = false;
 
 	// check header and loader CRC
 	crc_table = image_base + loader_data->loader_crc_info();
 	crc_table_size = static_cast<uint32_t>(loader_data->loader_crc_size());
 	crc_table_hash = static_cast<uint32_t>(loader_data->loader_crc_hash());
-	{
-		if (crc_table_hash != CalcCRC(crc_table, crc_table_size))
-			res = false;
-		CRCValueCryptor crc_cryptor;
-		for (size_t i = 0; i < crc_table_size; i += sizeof(CRC_INFO)) {
-			CRC_INFO crc_info = *reinterpret_cast<CRC_INFO *>(crc_table + i);
-			crc_info.Address = crc_cryptor.Decrypt(crc_info.Address);
-			crc_info.Size = crc_cryptor.Decrypt(crc_info.Size);
-			crc_info.Hash = crc_cryptor.Decrypt(crc_info.Hash);
-#ifdef WIN_DRIVER
-			if (image_size && image_size < crc_info.Address + crc_info.Size)
-				continue;
-#endif
-		
-			if (crc_info.Hash != CalcCRC(image_base + crc_info.Address, crc_info.Size))
-				res = false;
-		}
-	}
+	if (res && !CheckCRCTable(image_base, crc_table, crc_table_size, crc_table_hash, image_size, parallel))
+		res = false;
 
 #ifndef DEMO
 #ifdef VMP_GNU
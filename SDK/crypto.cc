@@ -2,6 +2,26 @@
 #include "crypto.h"
 #include <assert.h>
 
+// carry-less multiply CRC folding, AVX2 RC5 and SHA extensions; kernel code keeps to general registers
+#if (defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)) && !defined(WIN_DRIVER)
+#define CRC_CLMUL
+#define RC5_AVX2
+#define SHA1_NI
+#ifdef VMP_GNU
+#define __rdtsc ia32_rdtsc // immintrin.h declares its own __rdtsc, which clashes with the shim in crypto.h
+#include <immintrin.h>
+#undef __rdtsc
+#define CRC_TARGET_CLMUL __attribute__((target("sse2,pclmul")))
+#define RC5_TARGET_AVX2 __attribute__((target("avx2")))
+#define SHA1_TARGET_NI __attribute__((target("sha,ssse3")))
+#else
+#include <intrin.h>
+#define CRC_TARGET_CLMUL
+#define RC5_TARGET_AVX2
+#define SHA1_TARGET_NI
+#endif
+#endif
+
 uint32_t rand32()
 {
 	uint32_t v1 = rand();
@@ -64,16 +84,127 @@ void CipherRC5::Decrypt(const uint32_t *in, uint32_t *out) const
 	out[0] = A - S[0];
 }
 
+#ifdef RC5_AVX2
+/**
+ * Blocks are independent, so eight of them go through the rounds side by side: A words in one
+ * register, B words in another, with the per-lane rotates done by VPSLLVD/VPSRLVD.
+ * Both functions handle whole groups of 64 bytes and return how many bytes they did.
+ */
+RC5_TARGET_AVX2 static inline __m256i RC5RotlAVX2(__m256i x, __m256i n)
+{
+	n = _mm256_and_si256(n, _mm256_set1_epi32(31));
+	return _mm256_or_si256(_mm256_sllv_epi32(x, n), _mm256_srlv_epi32(x, _mm256_sub_epi32(_mm256_set1_epi32(32), n)));
+}
+
+RC5_TARGET_AVX2 static inline __m256i RC5RotrAVX2(__m256i x, __m256i n)
+{
+	n = _mm256_and_si256(n, _mm256_set1_epi32(31));
+	return _mm256_or_si256(_mm256_srlv_epi32(x, n), _mm256_sllv_epi32(x, _mm256_sub_epi32(_mm256_set1_epi32(32), n)));
+}
+
+// A0 B0 A1 B1 A2 B2 A3 B3 | A4 B4 ... -> A0 A1 A4 A5 A2 A3 A6 A7 and the same for B; the unpacks below undo it
+#define RC5_SPLIT_AVX2(v0, v1, A, B) \
+	A = _mm256_castps_si256(_mm256_shuffle_ps(_mm256_castsi256_ps(v0), _mm256_castsi256_ps(v1), _MM_SHUFFLE(2, 0, 2, 0))); \
+	B = _mm256_castps_si256(_mm256_shuffle_ps(_mm256_castsi256_ps(v0), _mm256_castsi256_ps(v1), _MM_SHUFFLE(3, 1, 3, 1)))
+
+RC5_TARGET_AVX2 static size_t RC5EncryptAVX2(const uint32_t *S, size_t rounds, const uint8_t *in, uint8_t *out, size_t count)
+{
+	size_t done;
+	for (done = 0; count - done >= 64; done += 64) {
+		__m256i A, B;
+		__m256i v0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + done));
+		__m256i v1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + done + 32));
+		RC5_SPLIT_AVX2(v0, v1, A, B);
+		A = _mm256_add_epi32(A, _mm256_set1_epi32(S[0]));
+		B = _mm256_add_epi32(B, _mm256_set1_epi32(S[1]));
+		for (size_t i = 1; i <= rounds; i++) {
+			A = _mm256_add_epi32(RC5RotlAVX2(_mm256_xor_si256(A, B), B), _mm256_set1_epi32(S[2 * i]));
+			B = _mm256_add_epi32(RC5RotlAVX2(_mm256_xor_si256(B, A), A), _mm256_set1_epi32(S[2 * i + 1]));
+		}
+		_mm256_storeu_si256(reinterpret_cast<__m256i *>(out + done), _mm256_unpacklo_epi32(A, B));
+		_mm256_storeu_si256(reinterpret_cast<__m256i *>(out + done + 32), _mm256_unpackhi_epi32(A, B));
+	}
+	return done;
+}
+
+RC5_TARGET_AVX2 static size_t RC5DecryptAVX2(const uint32_t *S, size_t rounds, const uint8_t *in, uint8_t *out, size_t count)
+{
+	size_t done;
+	for (done = 0; count - done >= 64; done += 64) {
+		__m256i A, B;
+		__m256i v0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + done));
+		__m256i v1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + done + 32));
+		RC5_SPLIT_AVX2(v0, v1, A, B);
+		for (size_t i = rounds; i > 0; i--) {
+			B = _mm256_xor_si256(RC5RotrAVX2(_mm256_sub_epi32(B, _mm256_set1_epi32(S[2 * i + 1])), A), A);
+			A = _mm256_xor_si256(RC5RotrAVX2(_mm256_sub_epi32(A, _mm256_set1_epi32(S[2 * i])), B), B);
+		}
+		A = _mm256_sub_epi32(A, _mm256_set1_epi32(S[0]));
+		B = _mm256_sub_epi32(B, _mm256_set1_epi32(S[1]));
+		_mm256_storeu_si256(reinterpret_cast<__m256i *>(out + done), _mm256_unpacklo_epi32(A, B));
+		_mm256_storeu_si256(reinterpret_cast<__m256i *>(out + done + 32), _mm256_unpackhi_epi32(A, B));
+	}
+	return done;
+}
+#endif
+
+enum {
+	RC5_UNKNOWN,
+	RC5_SCALAR,
+	RC5_AVX2_BLOCKS
+};
+
+// chosen on first use, like crc_method
+static int rc5_method = RC5_UNKNOWN;
+
+static int DetectRC5Method()
+{
+#ifdef RC5_AVX2
+	int regs[4];
+	__cpuid(regs, 0);
+	if (regs[0] >= 7) {
+		__cpuid(regs, 1);
+		// AVX and OSXSAVE, then the OS must save the YMM state as well
+		if ((regs[2] & (1 << 27)) && (regs[2] & (1 << 28))) {
+#ifdef VMP_GNU
+			uint32_t xcr0_lo, xcr0_hi;
+			__asm__ __volatile__("xgetbv" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0));
+#else
+			uint32_t xcr0_lo = static_cast<uint32_t>(_xgetbv(0));
+#endif
+			__cpuidex(regs, 7, 0);
+			if ((xcr0_lo & 6) == 6 && (regs[1] & (1 << 5))) // AVX2
+				return RC5_AVX2_BLOCKS;
+		}
+	}
+#endif
+	return RC5_SCALAR;
+}
+
 void CipherRC5::Encrypt(uint8_t *buff, size_t count) const
 {
-	for (size_t i = 0; i < count; i += 8) {
+	size_t i = 0;
+	if (rc5_method == RC5_UNKNOWN)
+		rc5_method = DetectRC5Method();
+#ifdef RC5_AVX2
+	if (rc5_method == RC5_AVX2_BLOCKS)
+		i = RC5EncryptAVX2(S, r, buff, buff, count);
+#endif
+	for (; i < count; i += 8) {
 		Encrypt(reinterpret_cast<uint32_t *>(buff + i), reinterpret_cast<uint32_t *>(buff + i));
 	}
 }
 
 void CipherRC5::Decrypt(const uint8_t *in, uint8_t *out, size_t count) const
 {
-	for (size_t i = 0; i < count; i += 8) {
+	size_t i = 0;
+	if (rc5_method == RC5_UNKNOWN)
+		rc5_method = DetectRC5Method();
+#ifdef RC5_AVX2
+	if (rc5_method == RC5_AVX2_BLOCKS)
+		i = RC5DecryptAVX2(S, r, in, out, count);
+#endif
+	for (; i < count; i += 8) {
 		Decrypt(reinterpret_cast<const uint32_t *>(in + i), reinterpret_cast<uint32_t *>(out + i));
 	}
 }
@@ -161,7 +292,7 @@ bool BigNumber::operator < (const BigNumber &b) const
 
 size_t BigNumber::size() const
 { 
-	return data(0) * BIGNUM_INT_BYTES;
+	return bignum_size(data_);
 }
 
 uint8_t BigNumber::operator [] (size_t index) const
@@ -287,16 +418,25 @@ void BigNumber::internal_mod(BignumInt *a, int alen,
 			ai1 = bignum_get_word(a + i + 1);
 
 		/* Find q = h:a[i] / m0 */
-		DIVMOD_WORD(q, r, h, bignum_get_word(a + i), m0);
-
-		/* Refine our estimate of q by looking at h:a[i]:a[i+1] / m0:m1 */
-		t = MUL_WORD(m1, q);
-		if (t > ((BignumDblInt) r << BIGNUM_INT_BITS) + ai1) {
-			q--;
-			t -= m1;
-			r = (r + m0) & BIGNUM_INT_MASK;     /* overflow? */
-			if (r >= (BignumDblInt) m0 &&
-					t > ((BignumDblInt) r << BIGNUM_INT_BITS) + ai1) q--;
+		if (h >= m0) {
+			/*
+			 * The quotient does not fit in a word, but a[i...] is still below m shifted
+			 * to this position, so the largest word value is an estimate the add-back
+			 * below can correct.
+			 */
+			q = BIGNUM_INT_MASK;
+		} else {
+			DIVMOD_WORD(q, r, h, bignum_get_word(a + i), m0);
+
+			/* Refine our estimate of q by looking at h:a[i]:a[i+1] / m0:m1 */
+			t = MUL_WORD(m1, q);
+			if (t > ((BignumDblInt) r << BIGNUM_INT_BITS) + ai1) {
+				q--;
+				t -= m1;
+				r = (r + m0) & BIGNUM_INT_MASK;     /* overflow? */
+				if (r >= (BignumDblInt) m0 &&
+						t > ((BignumDblInt) r << BIGNUM_INT_BITS) + ai1) q--;
+			}
 		}
 
 		/* Subtract q * m from a[i...] */
@@ -326,9 +466,186 @@ void BigNumber::internal_mod(BignumInt *a, int alen,
 	}
 }
 
+/* -m0^-1 modulo the word size, by Newton's iteration; m0 must be odd */
+static BignumInt mont_inverse(BignumInt m0)
+{
+	BignumInt x = m0; /* m0 * m0 == 1 mod 8 */
+	for (int i = 0; i < 5; i++)
+		x *= 2 - m0 * x;
+	return 0 - x;
+}
+
+/*
+ * res = x * y / R mod m, R = 2^(BIGNUM_INT_BITS * len), interleaving the product and the
+ * reduction word by word (CIOS). x, y, m and res are big endian like the rest of this code;
+ * the scratch t of len + 2 words is little endian. res may be x or y.
+ */
+void BigNumber::internal_mont_mul(BignumInt *x, BignumInt *y, BignumInt *m, BignumInt minv, BignumInt *t, BignumInt *res, int len) const
+{
+	int i, j;
+	BignumDblInt c;
+	BignumInt q;
+
+	for (j = 0; j < len + 2; j++)
+		bignum_set_word(t + j, 0);
+
+	for (i = len - 1; i >= 0; i--) {
+		/* t += x * y[i] */
+		BignumInt yi = bignum_get_word(y + i);
+		c = 0;
+		for (j = 0; j < len; j++) {
+			c += MUL_WORD(bignum_get_word(x + len - 1 - j), yi) + bignum_get_word(t + j);
+			bignum_set_word(t + j, (BignumInt) c);
+			c >>= BIGNUM_INT_BITS;
+		}
+		c += bignum_get_word(t + len);
+		bignum_set_word(t + len, (BignumInt) c);
+		bignum_set_word(t + len + 1, (BignumInt) (c >> BIGNUM_INT_BITS));
+
+		/* t = (t + q * m) / 2^BIGNUM_INT_BITS, q chosen to clear the low word */
+		q = bignum_get_word(t + 0) * minv;
+		c = MUL_WORD(q, bignum_get_word(m + len - 1)) + bignum_get_word(t + 0);
+		c >>= BIGNUM_INT_BITS;
+		for (j = 1; j < len; j++) {
+			c += MUL_WORD(q, bignum_get_word(m + len - 1 - j)) + bignum_get_word(t + j);
+			bignum_set_word(t + j - 1, (BignumInt) c);
+			c >>= BIGNUM_INT_BITS;
+		}
+		c += bignum_get_word(t + len);
+		bignum_set_word(t + len - 1, (BignumInt) c);
+		bignum_set_word(t + len, bignum_get_word(t + len + 1) + (BignumInt) (c >> BIGNUM_INT_BITS));
+	}
+
+	/* t < 2m, so one subtraction brings it below m */
+	bool sub = (bignum_get_word(t + len) != 0);
+	if (!sub) {
+		sub = true;
+		for (j = len - 1; j >= 0; j--) {
+			BignumInt tj = bignum_get_word(t + j);
+			BignumInt mj = bignum_get_word(m + len - 1 - j);
+			if (tj != mj) {
+				sub = (tj > mj);
+				break;
+			}
+		}
+	}
+	c = 0;
+	for (j = 0; j < len; j++) {
+		BignumInt tj = bignum_get_word(t + j);
+		if (sub) {
+			BignumDblInt d = (BignumDblInt) tj - bignum_get_word(m + len - 1 - j) - c;
+			tj = (BignumInt) d;
+			c = (d >> BIGNUM_INT_BITS) & 1;
+		}
+		bignum_set_word(res + len - 1 - j, tj);
+	}
+}
+
+/*
+ * Sliding-window exponentiation in Montgomery form: a[mlen...2*mlen] = n^e mod m.
+ * Returns false, leaving a alone, when m is even or e is zero; the caller then
+ * falls back to square-and-multiply with division.
+ */
+bool BigNumber::internal_modpow_mont(BignumInt *a, BignumInt *n, BignumInt *e, int elen, BignumInt *m, int mlen) const
+{
+	BignumInt *mem, *conv, *mn, *t, *acc, *table;
+	int i, j, top, mshift, window;
+	BignumInt minv;
+
+	if ((bignum_get_word(m + mlen - 1) & 1) == 0)
+		return false;
+
+	/* Find the top bit of e, counting from the least significant */
+#define EXP_BIT(pos) ((bignum_get_word(e + elen - 1 - (pos) / BIGNUM_INT_BITS) >> ((pos) % BIGNUM_INT_BITS)) & 1)
+	for (top = elen * BIGNUM_INT_BITS - 1; top >= 0; top--)
+		if (EXP_BIT(top))
+			break;
+	if (top < 0)
+		return false;
+
+	/* Window sizes as in OpenSSL's BN_window_bits_for_exponent_size */
+	window = (top > 670) ? 6 : (top > 238) ? 5 : (top > 78) ? 4 : (top > 22) ? 3 : 1;
+
+	mem = new BignumInt[(2 * mlen + 1) + mlen + (mlen + 2) + mlen + (mlen << (window - 1))];
+	conv = mem;
+	mn = conv + 2 * mlen + 1;
+	t = mn + mlen;
+	acc = t + mlen + 2;
+	table = acc + mlen;
+	minv = mont_inverse(bignum_get_word(m + mlen - 1));
+
+	/* Shift m left to make msb bit set, as internal_mod needs */
+	for (mshift = 0; mshift < BIGNUM_INT_BITS - 1; mshift++)
+		if ((bignum_get_word(m + 0) << mshift) & BIGNUM_TOP_BIT)
+			break;
+	for (i = 0; i < mlen; i++) {
+		BignumInt w = bignum_get_word(m + i) << mshift;
+		if (mshift && i < mlen - 1)
+			w |= bignum_get_word(m + i + 1) >> (BIGNUM_INT_BITS - mshift);
+		bignum_set_word(mn + i, w);
+	}
+
+	/* table[0] = n * R mod m: (n * R << mshift) mod (m << mshift), shifted back */
+	BignumInt carry = 0;
+	for (i = 2 * mlen; i >= 0; i--) {
+		BignumInt w = (i > 0 && i <= mlen) ? bignum_get_word(n + i - 1) : 0;
+		bignum_set_word(conv + i, (w << mshift) | carry);
+		carry = mshift ? w >> (BIGNUM_INT_BITS - mshift) : 0;
+	}
+	internal_mod(conv, 2 * mlen + 1, mn, mlen, NULL, 0);
+	for (i = 0; i < mlen; i++) {
+		BignumInt w = bignum_get_word(conv + mlen + 1 + i) >> mshift;
+		if (mshift && i > 0)
+			w |= bignum_get_word(conv + mlen + i) << (BIGNUM_INT_BITS - mshift);
+		bignum_set_word(table + i, w);
+	}
+
+	/* table[k] = n^(2k+1) */
+	if (window > 1) {
+		internal_mont_mul(table, table, m, minv, t, acc, mlen);
+		for (i = 1; i < (1 << (window - 1)); i++)
+			internal_mont_mul(table + (i - 1) * mlen, acc, m, minv, t, table + i * mlen, mlen);
+	}
+
+	/* Scan e from the top; each window is odd and at most window bits wide */
+	bool first = true;
+	for (i = top; i >= 0; ) {
+		if (!EXP_BIT(i)) {
+			internal_mont_mul(acc, acc, m, minv, t, acc, mlen);
+			i--;
+			continue;
+		}
+		int low = (i >= window) ? i - window + 1 : 0;
+		while (!EXP_BIT(low))
+			low++;
+		int value = 0;
+		for (j = i; j >= low; j--)
+			value = (value << 1) | static_cast<int>(EXP_BIT(j));
+		if (first) {
+			for (j = 0; j < mlen; j++)
+				bignum_set_word(acc + j, bignum_get_word(table + (value >> 1) * mlen + j));
+			first = false;
+		} else {
+			for (j = i; j >= low; j--)
+				internal_mont_mul(acc, acc, m, minv, t, acc, mlen);
+			internal_mont_mul(acc, table + (value >> 1) * mlen, m, minv, t, acc, mlen);
+		}
+		i = low - 1;
+	}
+#undef EXP_BIT
+
+	/* Leave Montgomery form: multiply by 1 */
+	for (i = 0; i < mlen; i++)
+		bignum_set_word(conv + i, (i == mlen - 1) ? 1 : 0);
+	internal_mont_mul(acc, conv, m, minv, t, a + mlen, mlen);
+
+	delete [] mem;
+	return true;
+}
+
 BigNumber BigNumber::modpow(const BigNumber &exp, const BigNumber &mod) const
 {
-	BignumInt *a, *b, *n, *m;
+	BignumInt *a, *b, *n, *m, *e;
 	int mshift;
 	int i,j,mlen;
 	Bignum result;
@@ -347,15 +664,11 @@ BigNumber BigNumber::modpow(const BigNumber &exp, const BigNumber &mod) const
 	for (j = 0; j < mlen; j++)
 		bignum_set_word(m + j, mod.data(mlen - j));
 
-	/* Shift m left to make msb bit set */
-	for (mshift = 0; mshift < BIGNUM_INT_BITS-1; mshift++)
-		if ((bignum_get_word(m + 0) << mshift) & BIGNUM_TOP_BIT)
-			break;
-	if (mshift) {
-		for (i = 0; i < mlen - 1; i++)
-			m[i] = (bignum_get_word(m + i) << mshift) | (bignum_get_word(m + i + 1) >> (BIGNUM_INT_BITS - mshift));
-		bignum_set_word(m + mlen - 1, bignum_get_word(m + mlen - 1) << mshift);
-	}
+	/* Allocate e of size elen, copy exp to e */
+	int elen = exp.data(0);
+	e = new BignumInt[elen ? elen : 1];
+	for (j = 0; j < elen; j++)
+		bignum_set_word(e + j, exp.data(elen - j));
 
 	/* Allocate n of size mlen, copy base to n */
 	int blen = data(0);
@@ -373,46 +686,57 @@ BigNumber BigNumber::modpow(const BigNumber &exp, const BigNumber &mod) const
 		bignum_set_word(a + i, 0);
 	bignum_set_word(a + 2 * mlen - 1, 1);
 
-	/* Skip leading zero bits of exp. */
-	i = 0;
-	j = BIGNUM_INT_BITS-1;
-	int elen = exp.data(0);
-	while (i < elen && (exp.data(elen - i) & (1 << j)) == 0) {
-		j--;
-		if (j < 0) {
-			i++;
-			j = BIGNUM_INT_BITS-1;
+	if (!internal_modpow_mont(a, n, e, elen, m, mlen)) {
+		/* Shift m left to make msb bit set */
+		for (mshift = 0; mshift < BIGNUM_INT_BITS-1; mshift++)
+			if ((bignum_get_word(m + 0) << mshift) & BIGNUM_TOP_BIT)
+				break;
+		if (mshift) {
+			for (i = 0; i < mlen - 1; i++)
+				bignum_set_word(m + i, (bignum_get_word(m + i) << mshift) | (bignum_get_word(m + i + 1) >> (BIGNUM_INT_BITS - mshift)));
+			bignum_set_word(m + mlen - 1, bignum_get_word(m + mlen - 1) << mshift);
 		}
-	}
 
-	/* Main computation */
-	while (i < elen) {
-		while (j >= 0) {
-			internal_mul(a + mlen, a + mlen, b, mlen);
-			internal_mod(b, mlen * 2, m, mlen, NULL, 0);
-			if ((exp.data(elen - i) & (1 << j)) != 0) {
-				internal_mul(b + mlen, n, a, mlen);
-				internal_mod(a, mlen * 2, m, mlen, NULL, 0);
-			} else {
-				BignumInt *t;
-				t = a;
-				a = b;
-				b = t;
-			}
+		/* Skip leading zero bits of exp. */
+		i = 0;
+		j = BIGNUM_INT_BITS-1;
+		while (i < elen && (bignum_get_word(e + i) & (1U << j)) == 0) {
 			j--;
+			if (j < 0) {
+				i++;
+				j = BIGNUM_INT_BITS-1;
+			}
+		}
+
+		/* Main computation */
+		while (i < elen) {
+			while (j >= 0) {
+				internal_mul(a + mlen, a + mlen, b, mlen);
+				internal_mod(b, mlen * 2, m, mlen, NULL, 0);
+				if ((bignum_get_word(e + i) & (1U << j)) != 0) {
+					internal_mul(b + mlen, n, a, mlen);
+					internal_mod(a, mlen * 2, m, mlen, NULL, 0);
+				} else {
+					BignumInt *t;
+					t = a;
+					a = b;
+					b = t;
+				}
+				j--;
+			}
+			i++;
+			j = BIGNUM_INT_BITS-1;
 		}
-		i++;
-		j = BIGNUM_INT_BITS-1;
-	}
 
-	/* Fixup result in case the modulus was shifted */
-	if (mshift) {
-		for (i = mlen - 1; i < 2 * mlen - 1; i++)
-			a[i] = (bignum_get_word(a + i) << mshift) | (bignum_get_word(a + i + 1) >> (BIGNUM_INT_BITS - mshift));
-		bignum_set_word(a + 2 * mlen - 1, bignum_get_word(a + 2 * mlen - 1) << mshift);
-		internal_mod(a, mlen * 2, m, mlen, NULL, 0);
-		for (i = 2 * mlen - 1; i >= mlen; i--)
-			bignum_set_word(a + i, (bignum_get_word(a + i) >> mshift) | (bignum_get_word(a + i - 1) << (BIGNUM_INT_BITS - mshift)));
+		/* Fixup result in case the modulus was shifted */
+		if (mshift) {
+			for (i = mlen - 1; i < 2 * mlen - 1; i++)
+				bignum_set_word(a + i, (bignum_get_word(a + i) << mshift) | (bignum_get_word(a + i + 1) >> (BIGNUM_INT_BITS - mshift)));
+			bignum_set_word(a + 2 * mlen - 1, bignum_get_word(a + 2 * mlen - 1) << mshift);
+			internal_mod(a, mlen * 2, m, mlen, NULL, 0);
+			for (i = 2 * mlen - 1; i >= mlen; i--)
+				bignum_set_word(a + i, (bignum_get_word(a + i) >> mshift) | (bignum_get_word(a + i - 1) << (BIGNUM_INT_BITS - mshift)));
+		}
 	}
 
 	/* Copy result to buffer */
@@ -428,6 +752,7 @@ BigNumber BigNumber::modpow(const BigNumber &exp, const BigNumber &mod) const
 	delete [] b;
 	delete [] m;
 	delete [] n;
+	delete [] e;
 
 	return BigNumber(result, 
 #ifdef RUNTIME
@@ -442,7 +767,7 @@ CryptoContainer *BigNumber::modpow(const CryptoContainer &source, size_t exp_off
 {
 	BignumInt *a = 0, *b = 0, *n = 0, *m = 0, *e = 0, *mem = 0, *next = 0;
 	int mshift;
-	int i, j, mlen, elen, blen;
+	int i, j, mlen, elen, blen, bytes;
 	Bignum result;
 	size_t k;
 	size_t arrays[5];
@@ -478,22 +803,15 @@ CryptoContainer *BigNumber::modpow(const CryptoContainer &source, size_t exp_off
 			m = next;
 			next = m + mlen;
 
+			/* the top word takes whatever is left over from whole words */
+			bytes = static_cast<int>((mod_size - 1) % BIGNUM_INT_BYTES) + 1;
 			for (j = 0; j < mlen; j++) {
 				BignumInt value = 0;
-				for (i = 0; i < BIGNUM_INT_BYTES; i++) {
+				for (i = 0; i < bytes; i++) {
 					value = (value << 8) | source.GetByte(mod_offset++);
 				}
 				bignum_set_word(m + j, value);
-			}
-
-			/* Shift m left to make msb bit set */
-			for (mshift = 0; mshift < BIGNUM_INT_BITS - 1; mshift++)
-				if ((bignum_get_word(m + 0) << mshift) & BIGNUM_TOP_BIT)
-					break;
-			if (mshift) {
-				for (i = 0; i < mlen - 1; i++)
-					m[i] = (bignum_get_word(m + i) << mshift) | (bignum_get_word(m + i + 1) >> (BIGNUM_INT_BITS - mshift));
-				bignum_set_word(m + mlen - 1, bignum_get_word(m + mlen - 1) << mshift);
+				bytes = BIGNUM_INT_BYTES;
 			}
 			break;
 
@@ -502,12 +820,14 @@ CryptoContainer *BigNumber::modpow(const CryptoContainer &source, size_t exp_off
 			e = next;
 			next = next + elen;
 
+			bytes = static_cast<int>((exp_size - 1) % BIGNUM_INT_BYTES) + 1;
 			for (j = 0; j < elen; j++) {
 				BignumInt value = 0;
-				for (i = 0; i < BIGNUM_INT_BYTES; i++) {
+				for (i = 0; i < bytes; i++) {
 					value = (value << 8) | source.GetByte(exp_offset++);
 				}
 				bignum_set_word(e + j, value);
+				bytes = BIGNUM_INT_BYTES;
 			}
 			break;
 
@@ -542,46 +862,58 @@ CryptoContainer *BigNumber::modpow(const CryptoContainer &source, size_t exp_off
 		}
 	}
 
-	/* Skip leading zero bits of exp. */
-	i = 0;
-	j = BIGNUM_INT_BITS - 1;
-	while (i < elen && (bignum_get_word(e + i) & (1 << j)) == 0) {
-		j--;
-		if (j < 0) {
-			i++;
-			j = BIGNUM_INT_BITS - 1;
+	if (!internal_modpow_mont(a, n, e, elen, m, mlen)) {
+		/* Shift m left to make msb bit set */
+		for (mshift = 0; mshift < BIGNUM_INT_BITS - 1; mshift++)
+			if ((bignum_get_word(m + 0) << mshift) & BIGNUM_TOP_BIT)
+				break;
+		if (mshift) {
+			for (i = 0; i < mlen - 1; i++)
+				bignum_set_word(m + i, (bignum_get_word(m + i) << mshift) | (bignum_get_word(m + i + 1) >> (BIGNUM_INT_BITS - mshift)));
+			bignum_set_word(m + mlen - 1, bignum_get_word(m + mlen - 1) << mshift);
 		}
-	}
 
-	/* Main computation */
-	while (i < elen) {
-		while (j >= 0) {
-			internal_mul(a + mlen, a + mlen, b, mlen);
-			internal_mod(b, mlen * 2, m, mlen, NULL, 0);
-			if ((bignum_get_word(e + i) & (1 << j)) != 0) {
-				internal_mul(b + mlen, n, a, mlen);
-				internal_mod(a, mlen * 2, m, mlen, NULL, 0);
+		/* Skip leading zero bits of exp. */
+		i = 0;
+		j = BIGNUM_INT_BITS - 1;
+		while (i < elen && (bignum_get_word(e + i) & (1U << j)) == 0) {
+			j--;
+			if (j < 0) {
+				i++;
+				j = BIGNUM_INT_BITS - 1;
 			}
-			else {
-				BignumInt *t;
-				t = a;
-				a = b;
-				b = t;
+		}
+
+		/* Main computation */
+		while (i < elen) {
+			while (j >= 0) {
+				internal_mul(a + mlen, a + mlen, b, mlen);
+				internal_mod(b, mlen * 2, m, mlen, NULL, 0);
+				if ((bignum_get_word(e + i) & (1U << j)) != 0) {
+					internal_mul(b + mlen, n, a, mlen);
+					internal_mod(a, mlen * 2, m, mlen, NULL, 0);
+				}
+				else {
+					BignumInt *t;
+					t = a;
+					a = b;
+					b = t;
+				}
+				j--;
 			}
-			j--;
+			i++;
+			j = BIGNUM_INT_BITS - 1;
 		}
-		i++;
-		j = BIGNUM_INT_BITS - 1;
-	}
 
-	/* Fixup result in case the modulus was shifted */
-	if (mshift) {
-		for (i = mlen - 1; i < 2 * mlen - 1; i++)
-			a[i] = (bignum_get_word(a + i) << mshift) | (bignum_get_word(a + i + 1) >> (BIGNUM_INT_BITS - mshift));
-		bignum_set_word(a + 2 * mlen - 1, bignum_get_word(a + 2 * mlen - 1) << mshift);
-		internal_mod(a, mlen * 2, m, mlen, NULL, 0);
-		for (i = 2 * mlen - 1; i >= mlen; i--)
-			bignum_set_word(a + i, (bignum_get_word(a + i) >> mshift) | (bignum_get_word(a + i - 1) << (BIGNUM_INT_BITS - mshift)));
+		/* Fixup result in case the modulus was shifted */
+		if (mshift) {
+			for (i = mlen - 1; i < 2 * mlen - 1; i++)
+				bignum_set_word(a + i, (bignum_get_word(a + i) << mshift) | (bignum_get_word(a + i + 1) >> (BIGNUM_INT_BITS - mshift)));
+			bignum_set_word(a + 2 * mlen - 1, bignum_get_word(a + 2 * mlen - 1) << mshift);
+			internal_mod(a, mlen * 2, m, mlen, NULL, 0);
+			for (i = 2 * mlen - 1; i >= mlen; i--)
+				bignum_set_word(a + i, (bignum_get_word(a + i) >> mshift) | (bignum_get_word(a + i - 1) << (BIGNUM_INT_BITS - mshift)));
+		}
 	}
 
 	/* Copy result to buffer */
@@ -592,7 +924,7 @@ CryptoContainer *BigNumber::modpow(const CryptoContainer &source, size_t exp_off
 		mlen--;
 	bignum_set_word(result, (BignumInt)mlen);
 
-	size_t size = bignum_get_word(result + 0) * BIGNUM_INT_BYTES;
+	size_t size = bignum_size(result);
 	RC5Key key;
 	key.Create();
 	CryptoContainer *res = new CryptoContainer(size, key);
@@ -607,6 +939,21 @@ CryptoContainer *BigNumber::modpow(const CryptoContainer &source, size_t exp_off
 	return res;
 }
 
+/*
+ * Length in bytes, rounded up to two: the granularity of the 16-bit words this code used
+ * to have, which callers such as the serial number layout check still rely on.
+ */
+size_t BigNumber::bignum_size(Bignum bn) const
+{
+	size_t len = bignum_get_word(bn + 0);
+	if (!len)
+		return 0;
+	size_t size = (len - 1) * BIGNUM_INT_BYTES + 1;
+	for (BignumInt top = bignum_get_word(bn + len) >> 8; top; top >>= 8)
+		size++;
+	return (size + 1) & ~static_cast<size_t>(1);
+}
+
 NOINLINE uint8_t BigNumber::bignum_byte(Bignum bn, size_t i) const
 {
 	if (i >= BIGNUM_INT_BYTES * (size_t)bignum_get_word(bn + 0))
@@ -920,6 +1267,188 @@ bool Base64Decode(const char *src, size_t src_len, uint8_t *dst, size_t &dst_len
  * SHA1
  */
 
+static void SHA1BlockScalar(uint32_t *hash, const uint8_t *block)
+{
+    size_t t;
+    uint32_t temp, W[80], A, B, C, D, E;
+
+	// the block may come straight from the caller's buffer, so it is not necessarily aligned
+	for (t = 0; t < 16; t++) {
+		uint32_t word;
+		memcpy(&word, &block[t * 4], sizeof(word));
+		W[t] = __builtin_bswap32(word);
+	}
+
+    for (t = 16; t < 80; t++) {
+       W[t] = _rotl32(W[t - 3] ^ W[t - 8] ^ W[t - 14] ^ W[t - 16], 1);
+    }
+
+    A = hash[0];
+    B = hash[1];
+    C = hash[2];
+    D = hash[3];
+    E = hash[4];
+
+    for (t = 0; t < 20; t++) {
+        temp = _rotl32(A, 5) + ((B & C) | ((~B) & D)) + E + W[t] + 0x5A827999;
+        E = D;
+        D = C;
+        C = _rotl32(B, 30);
+        B = A;
+        A = temp;
+    }
+
+    for(t = 20; t < 40; t++) {
+        temp = _rotl32(A, 5) + (B ^ C ^ D) + E + W[t] + 0x6ED9EBA1;
+        E = D;
+        D = C;
+        C = _rotl32(B, 30);
+        B = A;
+        A = temp;
+    }
+
+    for (t = 40; t < 60; t++) {
+        temp = _rotl32(A, 5) + ((B & C) | (B & D) | (C & D)) + E + W[t] + 0x8F1BBCDC;
+        E = D;
+        D = C;
+        C = _rotl32(B, 30);
+        B = A;
+        A = temp;
+    }
+
+    for(t = 60; t < 80; t++) {
+        temp = _rotl32(A, 5) + (B ^ C ^ D) + E + W[t] + 0xCA62C1D6;
+        E = D;
+        D = C;
+        C = _rotl32(B, 30);
+        B = A;
+        A = temp;
+    }
+
+    hash[0] += A;
+    hash[1] += B;
+    hash[2] += C;
+    hash[3] += D;
+    hash[4] += E;
+}
+
+#ifdef SHA1_NI
+/**
+ * SHA extensions: SHA1RNDS4 does four rounds, SHA1NEXTE adds E from four rounds back and
+ * SHA1MSG1/SHA1MSG2 extend the message schedule four words at a time.
+ */
+// rounds 4k...4k+3 for k >= 3; w holds the words for these rounds, w1-w3 the next three groups
+#define SHA1_NI_ROUNDS(e, e_next, w, w1, w2, w3, f) \
+	e = _mm_sha1nexte_epu32(e, w); \
+	e_next = abcd; \
+	w1 = _mm_sha1msg2_epu32(w1, w); \
+	abcd = _mm_sha1rnds4_epu32(abcd, e, f); \
+	w3 = _mm_sha1msg1_epu32(w3, w); \
+	w2 = _mm_xor_si128(w2, w)
+
+SHA1_TARGET_NI static void SHA1BlocksNI(uint32_t *hash, const uint8_t *data, size_t count)
+{
+	const __m128i mask = _mm_set_epi64x(0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL);
+	__m128i abcd = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(hash)), 0x1B);
+	__m128i e0 = _mm_set_epi32(static_cast<int>(hash[4]), 0, 0, 0);
+	__m128i e1, msg0, msg1, msg2, msg3;
+
+	for (; count; count--, data += 64) {
+		__m128i abcd_save = abcd;
+		__m128i e0_save = e0;
+
+		msg0 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data + 0x00)), mask);
+		e0 = _mm_add_epi32(e0, msg0);
+		e1 = abcd;
+		abcd = _mm_sha1rnds4_epu32(abcd, e0, 0);
+
+		msg1 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data + 0x10)), mask);
+		e1 = _mm_sha1nexte_epu32(e1, msg1);
+		e0 = abcd;
+		abcd = _mm_sha1rnds4_epu32(abcd, e1, 0);
+		msg0 = _mm_sha1msg1_epu32(msg0, msg1);
+
+		msg2 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data + 0x20)), mask);
+		e0 = _mm_sha1nexte_epu32(e0, msg2);
+		e1 = abcd;
+		abcd = _mm_sha1rnds4_epu32(abcd, e0, 0);
+		msg1 = _mm_sha1msg1_epu32(msg1, msg2);
+		msg0 = _mm_xor_si128(msg0, msg2);
+
+		msg3 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data + 0x30)), mask);
+		SHA1_NI_ROUNDS(e1, e0, msg3, msg0, msg1, msg2, 0);
+		SHA1_NI_ROUNDS(e0, e1, msg0, msg1, msg2, msg3, 0);
+		SHA1_NI_ROUNDS(e1, e0, msg1, msg2, msg3, msg0, 1);
+		SHA1_NI_ROUNDS(e0, e1, msg2, msg3, msg0, msg1, 1);
+		SHA1_NI_ROUNDS(e1, e0, msg3, msg0, msg1, msg2, 1);
+		SHA1_NI_ROUNDS(e0, e1, msg0, msg1, msg2, msg3, 1);
+		SHA1_NI_ROUNDS(e1, e0, msg1, msg2, msg3, msg0, 1);
+		SHA1_NI_ROUNDS(e0, e1, msg2, msg3, msg0, msg1, 2);
+		SHA1_NI_ROUNDS(e1, e0, msg3, msg0, msg1, msg2, 2);
+		SHA1_NI_ROUNDS(e0, e1, msg0, msg1, msg2, msg3, 2);
+		SHA1_NI_ROUNDS(e1, e0, msg1, msg2, msg3, msg0, 2);
+		SHA1_NI_ROUNDS(e0, e1, msg2, msg3, msg0, msg1, 2);
+		SHA1_NI_ROUNDS(e1, e0, msg3, msg0, msg1, msg2, 3);
+		SHA1_NI_ROUNDS(e0, e1, msg0, msg1, msg2, msg3, 3);
+		SHA1_NI_ROUNDS(e1, e0, msg1, msg2, msg3, msg0, 3);
+		SHA1_NI_ROUNDS(e0, e1, msg2, msg3, msg0, msg1, 3);
+
+		// rounds 76-79 need no further schedule
+		e1 = _mm_sha1nexte_epu32(e1, msg3);
+		e0 = abcd;
+		abcd = _mm_sha1rnds4_epu32(abcd, e1, 3);
+
+		e0 = _mm_sha1nexte_epu32(e0, e0_save);
+		abcd = _mm_add_epi32(abcd, abcd_save);
+	}
+
+	_mm_storeu_si128(reinterpret_cast<__m128i *>(hash), _mm_shuffle_epi32(abcd, 0x1B));
+	hash[4] = static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_srli_si128(e0, 12)));
+}
+#undef SHA1_NI_ROUNDS
+#endif
+
+enum {
+	SHA1_UNKNOWN,
+	SHA1_SCALAR,
+	SHA1_EXTENSIONS
+};
+
+// chosen on first use, like crc_method
+static int sha1_method = SHA1_UNKNOWN;
+
+static int DetectSHA1Method()
+{
+#ifdef SHA1_NI
+	int regs[4];
+	__cpuid(regs, 0);
+	if (regs[0] >= 7) {
+		__cpuid(regs, 1);
+		bool ssse3 = (regs[2] & (1 << 9)) != 0;
+		__cpuidex(regs, 7, 0);
+		if (ssse3 && (regs[1] & (1 << 29))) // SHA
+			return SHA1_EXTENSIONS;
+	}
+#endif
+	return SHA1_SCALAR;
+}
+
+static void SHA1ProcessBlocks(uint32_t *hash, const uint8_t *data, size_t count)
+{
+	if (sha1_method == SHA1_UNKNOWN)
+		sha1_method = DetectSHA1Method();
+#ifdef SHA1_NI
+	if (sha1_method == SHA1_EXTENSIONS) {
+		SHA1BlocksNI(hash, data, count);
+		return;
+	}
+#endif
+	for (; count; count--, data += 64) {
+		SHA1BlockScalar(hash, data);
+	}
+}
+
+
 SHA1::SHA1()
 {
     Reset();
@@ -944,6 +1473,17 @@ void SHA1::Input(const uint8_t *data, size_t size)
 		return;
 
 	for (size_t i = 0; i < size; i++) {
+		if (message_block_index_ == 0 && size - i >= 64) {
+			// whole blocks are hashed in place
+			size_t count = (size - i) / 64;
+			SHA1ProcessBlocks(hash_, data + i, count);
+			uint64_t length = ((static_cast<uint64_t>(length_high_) << 32) | length_low_) + static_cast<uint64_t>(count) * 64 * 8;
+			length_low_ = static_cast<uint32_t>(length);
+			length_high_ = static_cast<uint32_t>(length >> 32);
+			i += count * 64;
+			if (i == size)
+				break;
+		}
 		message_block_[message_block_index_++] = data[i];
 		length_low_ += 8;
 		if (!length_low_) {
@@ -974,65 +1514,7 @@ void SHA1::Input(const CryptoContainer &data, size_t offset, size_t size)
 
 void SHA1::ProcessMessageBlock()
 {
-    size_t t;
-    uint32_t temp, W[80], A, B, C, D, E;
-
-	for (t = 0; t < 16; t++) {
-		W[t] = __builtin_bswap32(*reinterpret_cast<uint32_t *>(&message_block_[t * 4]));
-	}
-
-    for (t = 16; t < 80; t++) {
-       W[t] = _rotl32(W[t - 3] ^ W[t - 8] ^ W[t - 14] ^ W[t - 16], 1);
-    }
-
-    A = hash_[0];
-    B = hash_[1];
-    C = hash_[2];
-    D = hash_[3];
-    E = hash_[4];
-
-    for (t = 0; t < 20; t++) {
-        temp = _rotl32(A, 5) + ((B & C) | ((~B) & D)) + E + W[t] + 0x5A827999;
-        E = D;
-        D = C;
-        C = _rotl32(B, 30);
-        B = A;
-        A = temp;
-    }
-
-    for(t = 20; t < 40; t++) {
-        temp = _rotl32(A, 5) + (B ^ C ^ D) + E + W[t] + 0x6ED9EBA1;
-        E = D;
-        D = C;
-        C = _rotl32(B, 30);
-        B = A;
-        A = temp;
-    }
-
-    for (t = 40; t < 60; t++) {
-        temp = _rotl32(A, 5) + ((B & C) | (B & D) | (C & D)) + E + W[t] + 0x8F1BBCDC;
-        E = D;
-        D = C;
-        C = _rotl32(B, 30);
-        B = A;
-        A = temp;
-    }
-
-    for(t = 60; t < 80; t++) {
-        temp = _rotl32(A, 5) + (B ^ C ^ D) + E + W[t] + 0xCA62C1D6;
-        E = D;
-        D = C;
-        C = _rotl32(B, 30);
-        B = A;
-        A = temp;
-    }
-
-    hash_[0] += A;
-    hash_[1] += B;
-    hash_[2] += C;
-    hash_[3] += D;
-    hash_[4] += E;
-
+	SHA1ProcessBlocks(hash_, message_block_, 1);
 	message_block_index_ = 0;
 }
 
@@ -1072,12 +1554,167 @@ const uint8_t * SHA1::Result()
  * CRC32
  */
 
+// value[k][n] is the CRC register after byte n and k zero bytes (value[0] is crc32_table),
+// so one lookup per byte folds eight bytes at a time
+struct CRCSliceTable {
+	uint32_t value[8][256];
+};
+
+static constexpr CRCSliceTable MakeCRCSliceTable()
+{
+	CRCSliceTable res = {};
+	for (uint32_t n = 0; n < 256; n++) {
+		uint32_t crc = n;
+		for (size_t i = 0; i < 8; i++)
+			crc = (crc & 1) ? 0xEDB88320 ^ (crc >> 1) : crc >> 1;
+		res.value[0][n] = crc;
+	}
+	for (size_t k = 1; k < 8; k++) {
+		for (uint32_t n = 0; n < 256; n++)
+			res.value[k][n] = (res.value[k - 1][n] >> 8) ^ res.value[0][res.value[k - 1][n] & 0xFF];
+	}
+	return res;
+}
+
+static constexpr CRCSliceTable crc32_slice_table = MakeCRCSliceTable();
+
+static uint32_t CRCSlice8(uint32_t crc, const uint8_t *p, size_t len)
+{
+	const uint32_t (*t)[256] = crc32_slice_table.value;
+	for (; len >= 8; p += 8, len -= 8) {
+		uint32_t lo, hi;
+		memcpy(&lo, p, sizeof(lo));
+		memcpy(&hi, p + 4, sizeof(hi));
+		lo ^= crc;
+		crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^ t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24] ^
+			t[3][hi & 0xFF] ^ t[2][(hi >> 8) & 0xFF] ^ t[1][(hi >> 16) & 0xFF] ^ t[0][hi >> 24];
+	}
+	while (len--) {
+		crc = t[0][(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+	}
+	return crc;
+}
+
+#ifdef CRC_CLMUL
+/**
+ * Folds 64 bytes per iteration with PCLMULQDQ ("Fast CRC Computation for Generic Polynomials Using
+ * PCLMULQDQ Instruction", Intel, 2009), then Barrett-reduces to 32 bits. len >= 64 and len % 16 == 0.
+ * The constants are x^n mod P(x) for the bit-reflected polynomial 0xEDB88320.
+ */
+CRC_TARGET_CLMUL static uint32_t CRCFoldCLMUL(uint32_t crc, const uint8_t *p, size_t len)
+{
+	const __m128i k1k2 = _mm_set_epi64x(0x01c6e41596, 0x0154442bd4);
+	const __m128i k3k4 = _mm_set_epi64x(0x00ccaa009e, 0x01751997d0);
+	const __m128i k5k0 = _mm_set_epi64x(0, 0x0163cd6124);
+	const __m128i poly = _mm_set_epi64x(0x01f7011641, 0x01db710641);
+	const __m128i mask32 = _mm_setr_epi32(-1, 0, -1, 0);
+
+	__m128i x1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 0x00));
+	__m128i x2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 0x10));
+	__m128i x3 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 0x20));
+	__m128i x4 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 0x30));
+	x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(static_cast<int>(crc)));
+	p += 64;
+	len -= 64;
+
+	// four independent lanes keep the multiplier busy
+	for (; len >= 64; p += 64, len -= 64) {
+		__m128i x5 = _mm_clmulepi64_si128(x1, k1k2, 0x00);
+		__m128i x6 = _mm_clmulepi64_si128(x2, k1k2, 0x00);
+		__m128i x7 = _mm_clmulepi64_si128(x3, k1k2, 0x00);
+		__m128i x8 = _mm_clmulepi64_si128(x4, k1k2, 0x00);
+		x1 = _mm_clmulepi64_si128(x1, k1k2, 0x11);
+		x2 = _mm_clmulepi64_si128(x2, k1k2, 0x11);
+		x3 = _mm_clmulepi64_si128(x3, k1k2, 0x11);
+		x4 = _mm_clmulepi64_si128(x4, k1k2, 0x11);
+		x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 0x00)));
+		x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 0x10)));
+		x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 0x20)));
+		x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 0x30)));
+	}
+
+	// fold the lanes into one, then the remaining 16-byte blocks
+	x1 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x1, k3k4, 0x11), _mm_clmulepi64_si128(x1, k3k4, 0x00)), x2);
+	x1 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x1, k3k4, 0x11), _mm_clmulepi64_si128(x1, k3k4, 0x00)), x3);
+	x1 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x1, k3k4, 0x11), _mm_clmulepi64_si128(x1, k3k4, 0x00)), x4);
+	for (; len >= 16; p += 16, len -= 16) {
+		x2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+		x1 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x1, k3k4, 0x11), _mm_clmulepi64_si128(x1, k3k4, 0x00)), x2);
+	}
+
+	// 128 -> 64 bits
+	x2 = _mm_clmulepi64_si128(x1, k3k4, 0x10);
+	x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+	x2 = _mm_srli_si128(x1, 4);
+	x1 = _mm_xor_si128(_mm_clmulepi64_si128(_mm_and_si128(x1, mask32), k5k0, 0x00), x2);
+
+	// Barrett reduction to 32 bits
+	x2 = _mm_clmulepi64_si128(_mm_and_si128(x1, mask32), poly, 0x10);
+	x2 = _mm_clmulepi64_si128(_mm_and_si128(x2, mask32), poly, 0x00);
+	x1 = _mm_xor_si128(x1, x2);
+	return static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_srli_si128(x1, 4)));
+}
+#endif
+
+enum {
+	CRC_UNKNOWN,
+	CRC_SLICE8,
+	CRC_CLMUL_FOLD
+};
+
+// chosen on first use; a plain value rather than a function pointer so it needs no relocation
+static int crc_method = CRC_UNKNOWN;
+
+static int DetectCRCMethod()
+{
+#ifdef CRC_CLMUL
+	int regs[4];
+	__cpuid(regs, 1);
+	if ((regs[2] & (1 << 1)) && (regs[3] & (1 << 26))) // PCLMULQDQ, SSE2
+		return CRC_CLMUL_FOLD;
+#endif
+	return CRC_SLICE8;
+}
+
 uint32_t CalcCRC(const void* key, size_t len)
 {
 	uint32_t crc = 0;
 	const uint8_t *p = static_cast<const uint8_t *>(key);
-	while (len--) {
-		crc = crc32_table[(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+	if (crc_method == CRC_UNKNOWN)
+		crc_method = DetectCRCMethod();
+#ifdef CRC_CLMUL
+	if (crc_method == CRC_CLMUL_FOLD && len >= 64) {
+		size_t size = len & ~static_cast<size_t>(15);
+		crc = CRCFoldCLMUL(crc, p, size);
+		p += size;
+		len -= size;
+	}
+#endif
+	return ~CRCSlice8(crc, p, len);
+}
+
+// a * b modulo the CRC polynomial, both bit-reflected (bit 31 is x^0)
+static uint32_t CRCMultiply(uint32_t a, uint32_t b)
+{
+	uint32_t res = 0;
+	for (uint32_t m = 1u << 31; m; m >>= 1) {
+		if (a & m)
+			res ^= b;
+		b = (b & 1) ? 0xEDB88320 ^ (b >> 1) : b >> 1;
+	}
+	return res;
+}
+
+uint32_t CombineCRC(uint32_t crc1, uint32_t crc2, size_t len2)
+{
+	// the CRC register is linear in the data, so appending len2 bytes multiplies the register
+	// for A by x^(8 * len2); the register starts at 0 and CalcCRC returns it inverted
+	uint32_t shift = 1u << 31; // x^0
+	uint32_t square = 1u << 23; // x^8
+	for (uint64_t n = len2; n; n >>= 1) {
+		if (n & 1)
+			shift = CRCMultiply(shift, square);
+		square = CRCMultiply(square, square);
 	}
-	return ~crc;
+	return CRCMultiply(shift, ~crc1) ^ crc2;
 }
\ No newline at end of file
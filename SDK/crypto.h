@@ -84,6 +84,13 @@ inline void __cpuid(int regs[4], uint32_t value)
         : "a"(value));
 }
 
+inline void __cpuidex(int regs[4], uint32_t value, uint32_t subleaf)
+{
+    __asm__ __volatile__("cpuid"
+        : "=a"(regs[0]), "=b"(regs[1]), "=c"(regs[2]), "=d"(regs[3])
+        : "a"(value), "c"(subleaf));
+}
+
 inline void __movsb(void* d, const void* s, size_t n)
 {
     asm volatile("rep movsb"
@@ -190,8 +197,8 @@ private:
 
 class CryptoContainer;
 
-typedef unsigned short BignumInt;
-typedef unsigned long BignumDblInt;
+typedef uint32_t BignumInt;
+typedef uint64_t BignumDblInt;
 typedef BignumInt* Bignum;
 
 class BigNumber {
@@ -218,12 +225,15 @@ private:
     void internal_mul(BignumInt* a, BignumInt* b, BignumInt* c, int len) const;
     void internal_add_shifted(BignumInt* number, unsigned n, int shift) const;
     void internal_mod(BignumInt* a, int alen, BignumInt* m, int mlen, BignumInt* quot, int qshift) const;
+    void internal_mont_mul(BignumInt* x, BignumInt* y, BignumInt* m, BignumInt minv, BignumInt* t, BignumInt* res, int len) const;
+    bool internal_modpow_mont(BignumInt* a, BignumInt* n, BignumInt* e, int elen, BignumInt* m, int mlen) const;
+    size_t bignum_size(Bignum bn) const;
     uint8_t bignum_byte(Bignum bn, size_t i) const;
     int bignum_cmp(const BigNumber& b) const;
     enum {
-        BIGNUM_INT_MASK = 0xFFFFU,
-        BIGNUM_TOP_BIT = 0x8000U,
-        BIGNUM_INT_BITS = 16,
+        BIGNUM_INT_MASK = 0xFFFFFFFFU,
+        BIGNUM_TOP_BIT = 0x80000000U,
+        BIGNUM_INT_BITS = 32,
         BIGNUM_INT_BYTES = (BIGNUM_INT_BITS / 8)
     };
 
@@ -342,6 +352,7 @@ static uint32_t crc32_table[] = {
 };
 
 uint32_t CalcCRC(const void* key, size_t len);
+uint32_t CombineCRC(uint32_t crc1, uint32_t crc2, size_t len2); // CalcCRC of A+B from CalcCRC of A and of B (len2 bytes)
 
 class CRCValueCryptor {
 public:
@@ -1888,7 +1888,7 @@ uint32_t WINAPI SetupImage()
             crc_info.Size = crc_cryptor.Decrypt(crc_info.Size);
             crc_info.Hash = crc_cryptor.Decrypt(crc_info.Hash);
 
-            if (crc_info.Hash != CalcCRC(image_base + crc_info.Address, crc_info.Size))
+            if (is_valid_crc && crc_info.Hash != CalcCRC(image_base + crc_info.Address, crc_info.Size))
                 is_valid_crc = false;
         }
 
@@ -1970,7 +1970,7 @@ uint32_t WINAPI SetupImage()
                                 crc_info.Size = crc_cryptor.Decrypt(crc_info.Size);
                                 crc_info.Hash = crc_cryptor.Decrypt(crc_info.Hash);
 
-                                if (crc_info.Hash != CalcCRC(file_view + arch_offset + crc_info.Address, crc_info.Size))
+                                if (is_valid_crc && crc_info.Hash != CalcCRC(file_view + arch_offset + crc_info.Address, crc_info.Size))
                                     is_valid_crc = false;
                             }
                         }
@@ -2041,7 +2041,7 @@ uint32_t WINAPI SetupImage()
                                 crc_info.Size = crc_cryptor.Decrypt(crc_info.Size);
                                 crc_info.Hash = crc_cryptor.Decrypt(crc_info.Hash);
 
-                                if (crc_info.Hash != CalcCRC(static_cast<uint8_t*>(file_view) + crc_info.Address, crc_info.Size))
+                                if (is_valid_crc && crc_info.Hash != CalcCRC(static_cast<uint8_t*>(file_view) + crc_info.Address, crc_info.Size))
                                     is_valid_crc = false;
                             }
                         }
@@ -2120,7 +2120,7 @@ uint32_t WINAPI SetupImage()
                                 crc_info.Size = crc_cryptor.Decrypt(crc_info.Size);
                                 crc_info.Hash = crc_cryptor.Decrypt(crc_info.Hash);
 
-                                if (crc_info.Hash != CalcCRC(static_cast<uint8_t*>(file_view) + crc_info.Address, crc_info.Size))
+                                if (is_valid_crc && crc_info.Hash != CalcCRC(static_cast<uint8_t*>(file_view) + crc_info.Address, crc_info.Size))
                                     is_valid_crc = false;
                             }
                         }
@@ -2255,6 +2255,8 @@ if (sc_virtual_protect) {
     if (data.tls_index_info())
         tls_index = *reinterpret_cast<uint32_t*>(image_base + data.tls_index_info());
 #endif
+        // one probability table serves every region (LzmaDecode resets it on each call) and each
+        // region is decoded straight into the image, which is also its dictionary
         PACKER_INFO* packer_info = reinterpret_cast<PACKER_INFO*>(image_base + data.packer_info());
         CLzmaDecoderState state;
         if (LzmaDecodeProperties(&state.Properties, image_base + packer_info->Src, packer_info->Dst) != LZMA_RESULT_OK) {
@@ -2698,7 +2700,7 @@ if (sc_virtual_protect) {
             if (crc_info.Address + crc_info.Size > crc_image_size)
                 crc_image_size = crc_info.Address + crc_info.Size;
 
-            if (crc_info.Hash != CalcCRC(image_base + crc_info.Address, crc_info.Size))
+            if (is_valid_crc && crc_info.Hash != CalcCRC(image_base + crc_info.Address, crc_info.Size))
                 is_valid_crc = false;
         }
         if (!is_valid_crc) {
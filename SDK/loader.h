@@ -555,7 +555,8 @@ enum {
 typedef struct _PEB32 {
 	BYTE Reserved1[2];
 	BYTE BeingDebugged;
-	BYTE Reserved2[0xa1];
+	BYTE Reserved2[0x9d];
+	ULONG LoaderLock;
 	ULONG OSMajorVersion;
 	ULONG OSMinorVersion;
 	USHORT OSBuildNumber;
@@ -564,7 +565,8 @@ typedef struct _PEB32 {
 typedef struct _PEB64 {
 	BYTE Reserved1[2];
 	BYTE BeingDebugged;
-	BYTE Reserved2[0x115];
+	BYTE Reserved2[0x10d];
+	ULONGLONG LoaderLock;
 	ULONG OSMajorVersion;
 	ULONG OSMinorVersion;
 	USHORT OSBuildNumber;
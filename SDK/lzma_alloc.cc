@@ -0,0 +1,171 @@
+#include "objects.h"
+#include "common.h"
+#include "lzma_alloc.h"
+#include "third-party/lzma/Alloc.h"
+
+using namespace vmp;
+
+// every block starts with its mapped size (0 for heap blocks); the caller gets the memory after
+// the header, which keeps the cache-line alignment of the pages
+#define LZMA_POOL_HEADER_SIZE 64
+
+static void *AllocPages(size_t &size, bool large_pages)
+{
+#ifdef VMP_GNU
+	size = (size + 0xFFF) & ~static_cast<size_t>(0xFFF);
+	void *res = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, -1, 0);
+	if (res == MAP_FAILED)
+		return NULL;
+#ifdef MADV_HUGEPAGE
+	if (large_pages)
+		madvise(res, size, MADV_HUGEPAGE);
+#else
+	(void)large_pages;
+#endif
+	return res;
+#elif defined(WIN_DRIVER)
+	(void)large_pages;
+	return MyAlloc(size);
+#else
+	if (large_pages) {
+		SIZE_T page_size = GetLargePageMinimum();
+		if (page_size) {
+			SIZE_T large_size = (size + page_size - 1) & ~(page_size - 1);
+			void *res = VirtualAlloc(NULL, large_size, MEM_COMMIT | MEM_RESERVE | MEM_LARGE_PAGES, PAGE_READWRITE);
+			if (res) {
+				size = large_size;
+				return res;
+			}
+		}
+	}
+	size = (size + 0xFFF) & ~static_cast<size_t>(0xFFF);
+	return VirtualAlloc(NULL, size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+#endif
+}
+
+static void FreePages(void *address, size_t size)
+{
+#ifdef VMP_GNU
+	munmap(address, size);
+#elif defined(WIN_DRIVER)
+	(void)size;
+	MyFree(address);
+#else
+	(void)size;
+	VirtualFree(address, 0, MEM_RELEASE);
+#endif
+}
+
+static size_t GetBlockSize(void *block)
+{
+	return *reinterpret_cast<size_t *>(block);
+}
+
+static void ReleaseBlock(void *block)
+{
+	size_t size = GetBlockSize(block);
+	if (size)
+		FreePages(block, size);
+	else
+		MyFree(block);
+}
+
+/**
+ * LzmaAllocPool
+ */
+
+LzmaAllocPool::LzmaAllocPool(bool large_pages, size_t max_blocks)
+	: large_pages_(large_pages), max_blocks_((max_blocks < LZMA_POOL_MAX_BLOCKS) ? max_blocks : LZMA_POOL_MAX_BLOCKS), count_(0)
+{
+	alloc_.vt.Alloc = &LzmaAllocPool::Alloc;
+	alloc_.vt.Free = &LzmaAllocPool::Free;
+	alloc_.pool = this;
+	CriticalSection::Init(critical_section_);
+}
+
+LzmaAllocPool::~LzmaAllocPool()
+{
+	Purge();
+	CriticalSection::Free(critical_section_);
+}
+
+void *LzmaAllocPool::Alloc(void *p, size_t size)
+{
+	return static_cast<Adapter *>(p)->pool->AllocBlock(size);
+}
+
+void LzmaAllocPool::Free(void *p, void *address)
+{
+	static_cast<Adapter *>(p)->pool->FreeBlock(address);
+}
+
+void *LzmaAllocPool::AllocBlock(size_t size)
+{
+	if (!size || size > static_cast<size_t>(-1) - LZMA_POOL_HEADER_SIZE - 0xFFF)
+		return NULL;
+	size += LZMA_POOL_HEADER_SIZE;
+
+	void *block = NULL;
+	if (size < LZMA_POOL_MIN_SIZE) {
+		block = MyAlloc(size);
+		if (!block)
+			return NULL;
+		*reinterpret_cast<size_t *>(block) = 0;
+		return static_cast<uint8_t *>(block) + LZMA_POOL_HEADER_SIZE;
+	}
+
+	{
+		// the smallest cached block that fits without wasting more than half of it
+		CriticalSection cs(critical_section_);
+		size_t best = NOT_ID;
+		for (size_t i = 0; i < count_; i++) {
+			size_t block_size = GetBlockSize(blocks_[i]);
+			if (block_size >= size && block_size - size <= size / 2 && (best == NOT_ID || block_size < GetBlockSize(blocks_[best])))
+				best = i;
+		}
+		if (best != NOT_ID) {
+			block = blocks_[best];
+			blocks_[best] = blocks_[--count_];
+		}
+	}
+
+	if (!block) {
+		block = AllocPages(size, large_pages_);
+		if (!block)
+			return NULL;
+		*reinterpret_cast<size_t *>(block) = size;
+	}
+	return static_cast<uint8_t *>(block) + LZMA_POOL_HEADER_SIZE;
+}
+
+void LzmaAllocPool::FreeBlock(void *address)
+{
+	if (!address)
+		return;
+	void *block = static_cast<uint8_t *>(address) - LZMA_POOL_HEADER_SIZE;
+	if (GetBlockSize(block)) {
+		CriticalSection cs(critical_section_);
+		if (count_ < max_blocks_) {
+			blocks_[count_++] = block;
+			return;
+		}
+	}
+	ReleaseBlock(block);
+}
+
+void LzmaAllocPool::Purge()
+{
+	void *blocks[LZMA_POOL_MAX_BLOCKS];
+	size_t count;
+	{
+		CriticalSection cs(critical_section_);
+		count = count_;
+		for (size_t i = 0; i < count; i++) {
+			blocks[i] = blocks_[i];
+		}
+		count_ = 0;
+	}
+	for (size_t i = 0; i < count; i++) {
+		ReleaseBlock(blocks[i]);
+	}
+}
@@ -0,0 +1,50 @@
+#ifndef LZMA_ALLOC_H
+#define LZMA_ALLOC_H
+
+#include "third-party/lzma/7zTypes.h"
+
+#define LZMA_POOL_MIN_SIZE 0x10000
+#define LZMA_POOL_MAX_BLOCKS 32
+
+/**
+ * ISzAlloc for the LZMA coders that keeps their big blocks (the encoder itself, the match
+ * finder hash and tree, windows and dictionaries) after they are freed and hands them out
+ * again for a request of a close size. Repeated calls then reuse memory that is already
+ * mapped instead of paying page faults and zeroing on every call. Blocks below
+ * LZMA_POOL_MIN_SIZE go straight to the heap.
+ *
+ * The pool is locked, so one pool can serve the worker threads of LzmaBlockEncoder. With
+ * large_pages the blocks are backed by large pages where the system allows it
+ * (MEM_LARGE_PAGES needs the "Lock pages in memory" privilege; elsewhere transparent huge
+ * pages are requested).
+ */
+class LzmaAllocPool {
+public:
+	LzmaAllocPool(bool large_pages = false, size_t max_blocks = LZMA_POOL_MAX_BLOCKS);
+	~LzmaAllocPool();
+	ISzAlloc *alloc() { return &alloc_.vt; }
+	// releases the cached blocks; blocks still in use return to the pool when freed
+	void Purge();
+private:
+	struct Adapter {
+		ISzAlloc vt;
+		LzmaAllocPool *pool;
+	};
+	static void *Alloc(void *p, size_t size);
+	static void Free(void *p, void *address);
+	void *AllocBlock(size_t size);
+	void FreeBlock(void *address);
+
+	Adapter alloc_;
+	bool large_pages_;
+	size_t max_blocks_;
+	void *blocks_[LZMA_POOL_MAX_BLOCKS];
+	size_t count_;
+	CRITICAL_SECTION critical_section_;
+
+	// no copy ctr or assignment op
+	LzmaAllocPool(const LzmaAllocPool &);
+	LzmaAllocPool &operator=(const LzmaAllocPool &);
+};
+
+#endif
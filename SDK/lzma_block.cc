@@ -0,0 +1,349 @@
+#include "common.h"
+#include "lzma_block.h"
+#include "third-party/lzma/Alloc.h"
+#include "third-party/lzma/LzmaDecode.h"
+
+static uint32_t GetUInt32LE(const uint8_t *p)
+{
+	return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+static void SetUInt32LE(uint8_t *p, uint32_t value)
+{
+	p[0] = static_cast<uint8_t>(value);
+	p[1] = static_cast<uint8_t>(value >> 8);
+	p[2] = static_cast<uint8_t>(value >> 16);
+	p[3] = static_cast<uint8_t>(value >> 24);
+}
+
+/**
+ * block job
+ *
+ * The calling thread and the workers claim blocks one at a time from a shared counter. Each thread
+ * keeps its own encoder or probability table for all the blocks it codes; the first error stops
+ * every thread.
+ */
+
+struct LzmaBlock {
+	const uint8_t *src;
+	size_t src_size;
+	uint8_t *dst;
+	size_t dst_size; // capacity of dst; after encoding the packed size
+};
+
+struct LzmaBlockJob {
+	LzmaBlock *blocks;
+	size_t block_count;
+	bool encode;
+	CLzmaEncProps enc_props;
+	ISzAlloc *alloc;
+	ISzAlloc *alloc_big;
+	CLzmaProperties dec_props;
+	volatile long next_block;
+	volatile long error;
+};
+
+static SRes EncodeLzmaBlock(const LzmaBlockJob *job, CLzmaEncHandle enc, LzmaBlock &block)
+{
+	SizeT dst_size = block.dst_size;
+	SRes res = LzmaEnc_MemEncode(enc, block.dst, &dst_size, block.src, block.src_size, 0, NULL, job->alloc, job->alloc_big);
+	if (res == SZ_ERROR_OUTPUT_EOF || (res == SZ_OK && dst_size >= block.src_size)) {
+		// incompressible: stored as is
+		block.dst = NULL;
+		block.dst_size = block.src_size;
+		return SZ_OK;
+	}
+	block.dst_size = dst_size;
+	return res;
+}
+
+static SRes DecodeLzmaBlock(const CLzmaProperties &props, CProb *probs, LzmaBlock &block)
+{
+	if (block.src_size == block.dst_size) {
+		memcpy(block.dst, block.src, block.dst_size);
+		return SZ_OK;
+	}
+
+	CLzmaDecoderState state;
+	state.Properties = props;
+	state.Probs = probs;
+	SizeT src_processed_size, dst_processed_size;
+	if (LzmaDecode(&state, block.src, block.src_size, &src_processed_size, block.dst, block.dst_size, &dst_processed_size) != LZMA_RESULT_OK
+		|| dst_processed_size != block.dst_size)
+		return SZ_ERROR_DATA;
+	return SZ_OK;
+}
+
+static void SetLzmaBlockError(LzmaBlockJob *job, SRes res)
+{
+#ifdef VMP_GNU
+	__sync_val_compare_and_swap(&job->error, 0, res);
+#else
+	InterlockedCompareExchange(&job->error, res, 0);
+#endif
+}
+
+static void RunLzmaBlocks(LzmaBlockJob *job)
+{
+	CLzmaEncHandle enc = NULL;
+	CProb *probs = NULL;
+	SRes res = SZ_OK;
+	if (job->encode) {
+		enc = LzmaEnc_Create(job->alloc);
+		res = enc ? LzmaEnc_SetProps(enc, &job->enc_props) : SZ_ERROR_MEM;
+	} else {
+		probs = static_cast<CProb *>(MyAlloc(LzmaGetNumProbs(&job->dec_props) * sizeof(CProb)));
+		if (!probs)
+			res = SZ_ERROR_MEM;
+	}
+	if (res != SZ_OK)
+		SetLzmaBlockError(job, res);
+
+	while (!job->error) {
+#ifdef VMP_GNU
+		size_t i = static_cast<size_t>(__sync_fetch_and_add(&job->next_block, 1));
+#else
+		size_t i = static_cast<size_t>(InterlockedIncrement(&job->next_block) - 1);
+#endif
+		if (i >= job->block_count)
+			break;
+		res = job->encode ? EncodeLzmaBlock(job, enc, job->blocks[i]) : DecodeLzmaBlock(job->dec_props, probs, job->blocks[i]);
+		if (res != SZ_OK)
+			SetLzmaBlockError(job, res);
+	}
+
+	if (enc)
+		LzmaEnc_Destroy(enc, job->alloc, job->alloc_big);
+	MyFree(probs);
+}
+
+#ifdef VMP_GNU
+static void *LzmaBlockWorkerProc(void *param)
+{
+	RunLzmaBlocks(reinterpret_cast<LzmaBlockJob *>(param));
+	return NULL;
+}
+#elif !defined(WIN_DRIVER)
+static DWORD WINAPI LzmaBlockWorkerProc(LPVOID param)
+{
+	RunLzmaBlocks(reinterpret_cast<LzmaBlockJob *>(param));
+	return 0;
+}
+#endif
+
+static size_t LzmaBlockWorkerCount(size_t thread_count, size_t block_count)
+{
+	if (!thread_count) {
+#ifdef VMP_GNU
+		long n = sysconf(_SC_NPROCESSORS_ONLN);
+		thread_count = (n > 0) ? static_cast<size_t>(n) : 1;
+#elif defined(WIN_DRIVER)
+		thread_count = 1;
+#else
+		SYSTEM_INFO system_info;
+		GetSystemInfo(&system_info);
+		thread_count = system_info.dwNumberOfProcessors;
+#endif
+	}
+	if (thread_count > block_count)
+		thread_count = block_count;
+	if (thread_count > LZMA_BLOCK_MAX_THREADS)
+		thread_count = LZMA_BLOCK_MAX_THREADS;
+	return (thread_count > 1) ? thread_count - 1 : 0;
+}
+
+static SRes RunLzmaBlockJob(LzmaBlockJob *job, size_t worker_count)
+{
+	job->next_block = 0;
+	job->error = SZ_OK;
+#ifdef VMP_GNU
+	pthread_t workers[LZMA_BLOCK_MAX_THREADS];
+	size_t started = 0;
+	for (; started < worker_count; started++) {
+		if (pthread_create(&workers[started], NULL, LzmaBlockWorkerProc, job) != 0)
+			break;
+	}
+	RunLzmaBlocks(job);
+	for (size_t i = 0; i < started; i++) {
+		pthread_join(workers[i], NULL);
+	}
+#elif defined(WIN_DRIVER)
+	(void)worker_count;
+	RunLzmaBlocks(job);
+#else
+	HANDLE workers[LZMA_BLOCK_MAX_THREADS];
+	DWORD started = 0;
+	for (; started < worker_count; started++) {
+		workers[started] = CreateThread(NULL, 0, LzmaBlockWorkerProc, job, 0, NULL);
+		if (!workers[started])
+			break;
+	}
+	RunLzmaBlocks(job);
+	if (started) {
+		WaitForMultipleObjects(started, workers, TRUE, INFINITE);
+		for (DWORD i = 0; i < started; i++) {
+			CloseHandle(workers[i]);
+		}
+	}
+#endif
+	return static_cast<SRes>(job->error);
+}
+
+/**
+ * LzmaBlockEncoder
+ */
+
+LzmaBlockEncoder::LzmaBlockEncoder(size_t block_size, size_t thread_count)
+	: block_size_(block_size ? block_size : LZMA_BLOCK_SIZE), thread_count_(thread_count), alloc_(NULL)
+{
+	LzmaEncProps_Init(&props_);
+}
+
+SRes LzmaBlockEncoder::Encode(const uint8_t *data, size_t size, LzmaOutStream &out)
+{
+	if (block_size_ > 0xFFFFFFFF)
+		return SZ_ERROR_PARAM;
+	size_t block_count = (size + block_size_ - 1) / block_size_;
+	if (block_count > 0xFFFFFFFF)
+		return SZ_ERROR_PARAM;
+
+	// parallelism comes from the blocks, so every encoder runs on its own thread only
+	LzmaBlockJob job;
+	job.encode = true;
+	job.enc_props = props_;
+	job.enc_props.reduceSize = block_size_;
+	job.enc_props.writeEndMark = 0;
+	job.enc_props.numThreads = 1;
+	LzmaEncProps_Normalize(&job.enc_props);
+	job.alloc = alloc_ ? alloc_ : &g_Alloc;
+	job.alloc_big = alloc_ ? alloc_ : &g_BigAlloc;
+
+	uint8_t header[LZMA_BLOCK_HEADER_SIZE];
+	memset(header, 0, sizeof(header));
+	SetUInt32LE(header, LZMA_BLOCK_MAGIC);
+	{
+		CLzmaEncHandle enc = LzmaEnc_Create(job.alloc);
+		if (!enc)
+			return SZ_ERROR_MEM;
+		SizeT props_size = LZMA_PROPS_SIZE;
+		SRes res = LzmaEnc_SetProps(enc, &job.enc_props);
+		if (res == SZ_OK)
+			res = LzmaEnc_WriteProperties(enc, header + 4, &props_size);
+		LzmaEnc_Destroy(enc, job.alloc, job.alloc_big);
+		if (res != SZ_OK)
+			return res;
+	}
+	SetUInt32LE(header + 12, static_cast<uint32_t>(block_size_));
+	SetUInt32LE(header + 16, static_cast<uint32_t>(block_count));
+	SetUInt32LE(header + 20, static_cast<uint32_t>(static_cast<UInt64>(size)));
+	SetUInt32LE(header + 24, static_cast<uint32_t>(static_cast<UInt64>(size) >> 32));
+	if (!out.Write(header, sizeof(header)))
+		return SZ_ERROR_WRITE;
+	if (!block_count)
+		return SZ_OK;
+
+	// each block is packed into its own slice of a buffer as large as the input
+	uint8_t *packed = static_cast<uint8_t *>(BigAlloc(size));
+	job.blocks = new LzmaBlock[block_count];
+	job.block_count = block_count;
+	if (!packed) {
+		delete [] job.blocks;
+		return SZ_ERROR_MEM;
+	}
+	for (size_t i = 0; i < block_count; i++) {
+		LzmaBlock &block = job.blocks[i];
+		block.src = data + i * block_size_;
+		block.src_size = (size - i * block_size_ > block_size_) ? block_size_ : size - i * block_size_;
+		block.dst = packed + i * block_size_;
+		block.dst_size = block.src_size;
+	}
+
+	SRes res = RunLzmaBlockJob(&job, LzmaBlockWorkerCount(thread_count_, block_count));
+	if (res == SZ_OK) {
+		uint8_t *index = new uint8_t[block_count * 4];
+		for (size_t i = 0; i < block_count; i++) {
+			SetUInt32LE(index + i * 4, static_cast<uint32_t>(job.blocks[i].dst_size));
+		}
+		if (!out.Write(index, block_count * 4))
+			res = SZ_ERROR_WRITE;
+		delete [] index;
+	}
+	for (size_t i = 0; res == SZ_OK && i < block_count; i++) {
+		const LzmaBlock &block = job.blocks[i];
+		if (!out.Write(block.dst ? block.dst : block.src, block.dst_size))
+			res = SZ_ERROR_WRITE;
+	}
+
+	delete [] job.blocks;
+	BigFree(packed);
+	return res;
+}
+
+/**
+ * LzmaBlockDecoder
+ */
+
+LzmaBlockDecoder::LzmaBlockDecoder(size_t thread_count)
+	: thread_count_(thread_count)
+{
+
+}
+
+SRes LzmaBlockDecoder::GetUnpackSize(const uint8_t *data, size_t size, UInt64 &unpack_size)
+{
+	if (size < LZMA_BLOCK_HEADER_SIZE)
+		return SZ_ERROR_INPUT_EOF;
+	if (GetUInt32LE(data) != LZMA_BLOCK_MAGIC)
+		return SZ_ERROR_UNSUPPORTED;
+	unpack_size = GetUInt32LE(data + 20) | (static_cast<UInt64>(GetUInt32LE(data + 24)) << 32);
+	return SZ_OK;
+}
+
+SRes LzmaBlockDecoder::Decode(const uint8_t *data, size_t size, uint8_t *dest, size_t dest_size)
+{
+	UInt64 unpack_size;
+	SRes res = GetUnpackSize(data, size, unpack_size);
+	if (res != SZ_OK)
+		return res;
+	if (unpack_size > dest_size)
+		return SZ_ERROR_OUTPUT_EOF;
+
+	LzmaBlockJob job;
+	job.encode = false;
+	if (LzmaDecodeProperties(&job.dec_props, data + 4, LZMA_PROPERTIES_SIZE) != LZMA_RESULT_OK)
+		return SZ_ERROR_UNSUPPORTED;
+	size_t block_size = GetUInt32LE(data + 12);
+	size_t block_count = GetUInt32LE(data + 16);
+	if (!block_size || block_count != (unpack_size + block_size - 1) / block_size)
+		return SZ_ERROR_DATA;
+	if (!block_count)
+		return SZ_OK;
+	if ((size - LZMA_BLOCK_HEADER_SIZE) / 4 < block_count)
+		return SZ_ERROR_INPUT_EOF;
+
+	job.blocks = new LzmaBlock[block_count];
+	job.block_count = block_count;
+	const uint8_t *index = data + LZMA_BLOCK_HEADER_SIZE;
+	const uint8_t *src = index + block_count * 4;
+	size_t src_size = size - (src - data);
+	for (size_t i = 0; i < block_count; i++) {
+		LzmaBlock &block = job.blocks[i];
+		block.src_size = GetUInt32LE(index + i * 4);
+		block.dst = dest + i * block_size;
+		block.dst_size = (unpack_size - i * block_size > block_size) ? block_size : static_cast<size_t>(unpack_size - i * block_size);
+		if (block.src_size > block.dst_size)
+			res = SZ_ERROR_DATA;
+		else if (block.src_size > src_size)
+			res = SZ_ERROR_INPUT_EOF;
+		if (res != SZ_OK)
+			break;
+		block.src = src;
+		src += block.src_size;
+		src_size -= block.src_size;
+	}
+
+	if (res == SZ_OK)
+		res = RunLzmaBlockJob(&job, LzmaBlockWorkerCount(thread_count_, block_count));
+	delete [] job.blocks;
+	return res;
+}
@@ -0,0 +1,51 @@
+#ifndef LZMA_BLOCK_H
+#define LZMA_BLOCK_H
+
+#include "lzma_stream.h"
+
+#define LZMA_BLOCK_MAGIC 0x31425A4CU // "LZB1"
+#define LZMA_BLOCK_SIZE 0x100000
+#define LZMA_BLOCK_MAX_THREADS 16
+#define LZMA_BLOCK_HEADER_SIZE 28
+
+/**
+ * Block container: the data is cut into blocks of block_size bytes (the last one may be
+ * shorter) that are compressed independently, so they can be packed and unpacked on
+ * several threads. All numbers are little-endian.
+ *
+ *   uint32_t magic             LZMA_BLOCK_MAGIC
+ *   uint8_t  props[5]          LZMA properties shared by all blocks
+ *   uint8_t  reserved[3]
+ *   uint32_t block_size
+ *   uint32_t block_count
+ *   uint64_t unpack_size
+ *   uint32_t packed_size[block_count]
+ *   blocks                     raw LZMA without end markers; a block whose packed size
+ *                              equals its unpacked size is stored uncompressed
+ */
+
+class LzmaBlockEncoder {
+public:
+	// thread_count 0 uses one thread per CPU
+	LzmaBlockEncoder(size_t block_size = LZMA_BLOCK_SIZE, size_t thread_count = 0);
+	CLzmaEncProps &props() { return props_; }
+	// allocator shared by the worker threads, e.g. LzmaAllocPool::alloc(); NULL uses the heap
+	void set_alloc(ISzAlloc *alloc) { alloc_ = alloc; }
+	SRes Encode(const uint8_t *data, size_t size, LzmaOutStream &out);
+private:
+	CLzmaEncProps props_;
+	size_t block_size_;
+	size_t thread_count_;
+	ISzAlloc *alloc_;
+};
+
+class LzmaBlockDecoder {
+public:
+	LzmaBlockDecoder(size_t thread_count = 0);
+	static SRes GetUnpackSize(const uint8_t *data, size_t size, UInt64 &unpack_size);
+	SRes Decode(const uint8_t *data, size_t size, uint8_t *dest, size_t dest_size);
+private:
+	size_t thread_count_;
+};
+
+#endif
@@ -0,0 +1,150 @@
+#include "common.h"
+#include "lzma_dict.h"
+#include "third-party/lzma/Alloc.h"
+#include "third-party/lzma/LzmaDecode.h"
+
+/**
+ * LzmaDictEncoder
+ */
+
+LzmaDictEncoder::LzmaDictEncoder(const uint8_t *dict, size_t dict_size)
+	: enc_(LzmaEnc_Create(&g_Alloc)), buffer_(NULL), dict_size_(dict_size), capacity_(0)
+{
+	// the window covers the dictionary and a message; the match finder runs on the calling thread
+	LzmaEncProps_Init(&props_);
+	props_.dictSize = static_cast<UInt32>(dict_size + LZMA_DICT_MESSAGE_SIZE);
+	props_.numThreads = 1;
+	memset(&applied_props_, 0, sizeof(applied_props_));
+	if (Reserve(LZMA_DICT_MESSAGE_SIZE) == SZ_OK && dict_size)
+		memcpy(buffer_, dict, dict_size);
+}
+
+LzmaDictEncoder::~LzmaDictEncoder()
+{
+	if (enc_)
+		LzmaEnc_Destroy(enc_, &g_Alloc, &g_BigAlloc);
+	MyFree(buffer_);
+}
+
+SRes LzmaDictEncoder::Reserve(size_t size)
+{
+	if (buffer_ && dict_size_ + size <= capacity_)
+		return SZ_OK;
+	if (size > 0xFFFFFFFF - dict_size_)
+		return SZ_ERROR_PARAM;
+
+	size_t capacity = dict_size_ + size;
+	uint8_t *buffer = static_cast<uint8_t *>(MyAlloc(capacity));
+	if (!buffer)
+		return SZ_ERROR_MEM;
+	if (buffer_) {
+		memcpy(buffer, buffer_, dict_size_);
+		MyFree(buffer_);
+	}
+	buffer_ = buffer;
+	capacity_ = capacity;
+	return SZ_OK;
+}
+
+// setting the properties drops the encoder's saved dictionary state, so only do it when they change
+SRes LzmaDictEncoder::ApplyProps()
+{
+	if (memcmp(&applied_props_, &props_, sizeof(props_)) == 0)
+		return SZ_OK;
+	SRes res = LzmaEnc_SetProps(enc_, &props_);
+	if (res == SZ_OK)
+		memcpy(&applied_props_, &props_, sizeof(props_));
+	return res;
+}
+
+SRes LzmaDictEncoder::WriteProperties(uint8_t *props)
+{
+	if (!enc_ || !buffer_)
+		return SZ_ERROR_MEM;
+	SRes res = ApplyProps();
+	if (res != SZ_OK)
+		return res;
+	SizeT props_size = LZMA_PROPS_SIZE;
+	return LzmaEnc_WriteProperties(enc_, props, &props_size);
+}
+
+SRes LzmaDictEncoder::Encode(const uint8_t *data, size_t size, uint8_t *dest, size_t &dest_size)
+{
+	if (!enc_ || !buffer_)
+		return SZ_ERROR_MEM;
+	SRes res = Reserve(size);
+	if (res == SZ_OK)
+		res = ApplyProps();
+	if (res != SZ_OK)
+		return res;
+
+	memcpy(buffer_ + dict_size_, data, size);
+	SizeT packed_size = dest_size;
+	res = LzmaEnc_MemEncodeWithDict(enc_, dest, &packed_size, buffer_ + dict_size_, size, dict_size_, 0, NULL, &g_Alloc, &g_BigAlloc);
+	dest_size = packed_size;
+	return res;
+}
+
+/**
+ * LzmaDictDecoder
+ */
+
+LzmaDictDecoder::LzmaDictDecoder(const uint8_t *dict, size_t dict_size, const uint8_t *props)
+	: probs_(NULL), buffer_(NULL), dict_size_(dict_size), capacity_(0)
+{
+	memcpy(props_, props, sizeof(props_));
+	if (Reserve(LZMA_DICT_MESSAGE_SIZE) == SZ_OK && dict_size)
+		memcpy(buffer_, dict, dict_size);
+}
+
+LzmaDictDecoder::~LzmaDictDecoder()
+{
+	MyFree(probs_);
+	MyFree(buffer_);
+}
+
+SRes LzmaDictDecoder::Reserve(size_t size)
+{
+	if (buffer_ && dict_size_ + size <= capacity_)
+		return SZ_OK;
+	if (size > static_cast<size_t>(-1) - dict_size_)
+		return SZ_ERROR_PARAM;
+
+	size_t capacity = dict_size_ + size;
+	uint8_t *buffer = static_cast<uint8_t *>(MyAlloc(capacity));
+	if (!buffer)
+		return SZ_ERROR_MEM;
+	if (buffer_) {
+		memcpy(buffer, buffer_, dict_size_);
+		MyFree(buffer_);
+	}
+	buffer_ = buffer;
+	capacity_ = capacity;
+	return SZ_OK;
+}
+
+SRes LzmaDictDecoder::Decode(const uint8_t *src, size_t src_size, uint8_t *dest, size_t dest_size)
+{
+	if (!buffer_)
+		return SZ_ERROR_MEM;
+	CLzmaDecoderState state;
+	if (LzmaDecodeProperties(&state.Properties, props_, LZMA_PROPERTIES_SIZE) != LZMA_RESULT_OK)
+		return SZ_ERROR_UNSUPPORTED;
+	if (!probs_) {
+		probs_ = MyAlloc(LzmaGetNumProbs(&state.Properties) * sizeof(CProb));
+		if (!probs_)
+			return SZ_ERROR_MEM;
+	}
+	SRes res = Reserve(dest_size);
+	if (res != SZ_OK)
+		return res;
+
+	// the message is decoded right after the dictionary, then copied out
+	state.Probs = static_cast<CProb *>(probs_);
+	SizeT src_processed_size, dst_processed_size;
+	if (LzmaDecodeWithDictionary(&state, dict_size_, src, src_size, &src_processed_size, buffer_ + dict_size_, dest_size, &dst_processed_size) != LZMA_RESULT_OK
+		|| dst_processed_size != dest_size)
+		return SZ_ERROR_DATA;
+	memcpy(dest, buffer_ + dict_size_, dest_size);
+	return SZ_OK;
+}
@@ -0,0 +1,62 @@
+#ifndef LZMA_DICT_H
+#define LZMA_DICT_H
+
+#include "third-party/lzma/LzmaEncode.h"
+
+#define LZMA_DICT_MESSAGE_SIZE 0x10000
+
+/**
+ * Small messages compressed against a preset dictionary that both peers hold, e.g. a
+ * sample of typical messages. Matches may refer to the dictionary, so even a message
+ * of a few hundred bytes compresses well. The output is a raw LZMA stream without
+ * header or end marker: the properties from WriteProperties() and the unpacked size
+ * of every message are passed to the peer by the caller.
+ *
+ * An encoder or decoder keeps its allocations between messages, so it should be
+ * created once per connection (or per thread) and reused.
+ */
+class LzmaDictEncoder {
+public:
+	LzmaDictEncoder(const uint8_t *dict, size_t dict_size);
+	~LzmaDictEncoder();
+	// changes take effect on the next call
+	CLzmaEncProps &props() { return props_; }
+	SRes WriteProperties(uint8_t *props);
+	// dest_size is the capacity of dest on input and the packed size on output
+	SRes Encode(const uint8_t *data, size_t size, uint8_t *dest, size_t &dest_size);
+private:
+	SRes Reserve(size_t size);
+	SRes ApplyProps();
+	CLzmaEncHandle enc_;
+	CLzmaEncProps props_;
+	CLzmaEncProps applied_props_;
+	uint8_t *buffer_; // the dictionary followed by the message
+	size_t dict_size_;
+	size_t capacity_;
+
+	// no copy ctr or assignment op
+	LzmaDictEncoder(const LzmaDictEncoder &);
+	LzmaDictEncoder &operator=(const LzmaDictEncoder &);
+};
+
+class LzmaDictDecoder {
+public:
+	// props are the LZMA_PROPS_SIZE bytes written by LzmaDictEncoder::WriteProperties
+	LzmaDictDecoder(const uint8_t *dict, size_t dict_size, const uint8_t *props);
+	~LzmaDictDecoder();
+	// dest_size is the exact unpacked size of the message
+	SRes Decode(const uint8_t *src, size_t src_size, uint8_t *dest, size_t dest_size);
+private:
+	SRes Reserve(size_t size);
+	uint8_t props_[LZMA_PROPS_SIZE];
+	void *probs_;
+	uint8_t *buffer_; // the dictionary followed by the message
+	size_t dict_size_;
+	size_t capacity_;
+
+	// no copy ctr or assignment op
+	LzmaDictDecoder(const LzmaDictDecoder &);
+	LzmaDictDecoder &operator=(const LzmaDictDecoder &);
+};
+
+#endif
@@ -0,0 +1,189 @@
+#include "common.h"
+#include "lzma_stream.h"
+#include "third-party/lzma/Alloc.h"
+#include "third-party/lzma/LzmaDecodeStream.h"
+
+/**
+ * adapters from the C++ streams to the LZMA SDK interfaces; the SDK calls them with
+ * the interface pointer, which is the first member
+ */
+
+struct LzmaInAdapter {
+	ISeqInStream vt;
+	LzmaInStream *stream;
+	size_t chunk_size;
+
+	static SRes Read(void *p, void *buffer, size_t *size)
+	{
+		LzmaInAdapter *self = static_cast<LzmaInAdapter *>(p);
+		if (*size > self->chunk_size)
+			*size = self->chunk_size;
+		return self->stream->Read(buffer, *size) ? SZ_OK : SZ_ERROR_READ;
+	}
+};
+
+struct LzmaOutAdapter {
+	ISeqOutStream vt;
+	LzmaOutStream *stream;
+
+	static size_t Write(void *p, const void *buffer, size_t size)
+	{
+		LzmaOutAdapter *self = static_cast<LzmaOutAdapter *>(p);
+		return self->stream->Write(buffer, size) ? size : 0;
+	}
+};
+
+struct LzmaProgressAdapter {
+	ICompressProgress vt;
+	LzmaProgress *progress;
+
+	static SRes Progress(void *p, UInt64 in_size, UInt64 out_size)
+	{
+		LzmaProgressAdapter *self = static_cast<LzmaProgressAdapter *>(p);
+		return self->progress->Progress(in_size, out_size) ? SZ_OK : SZ_ERROR_PROGRESS;
+	}
+};
+
+// input callback of the 4.40 decoder: refills its buffer from the stream one chunk at a time
+struct LzmaDecoderInAdapter {
+	ILzmaStreamInCallback vt;
+	LzmaInStream *stream;
+	Byte *buffer;
+	size_t chunk_size;
+	UInt64 in_size;
+	SRes error;
+
+	static int Read(void *p, const unsigned char **buffer, SizeT *size)
+	{
+		LzmaDecoderInAdapter *self = static_cast<LzmaDecoderInAdapter *>(p);
+		size_t read_size = self->chunk_size;
+		if (!self->stream->Read(self->buffer, read_size)) {
+			self->error = SZ_ERROR_READ;
+			return LZMA_RESULT_DATA_ERROR;
+		}
+		if (!read_size)
+			self->error = SZ_ERROR_INPUT_EOF; // the decoder fails on an empty read
+		self->in_size += read_size;
+		*buffer = self->buffer;
+		*size = read_size;
+		return LZMA_RESULT_OK;
+	}
+};
+
+/**
+ * LzmaStreamEncoder
+ */
+
+LzmaStreamEncoder::LzmaStreamEncoder(size_t chunk_size)
+	: chunk_size_(chunk_size ? chunk_size : LZMA_STREAM_CHUNK_SIZE), alloc_(NULL)
+{
+	LzmaEncProps_Init(&props_);
+}
+
+SRes LzmaStreamEncoder::Encode(LzmaInStream &in, LzmaOutStream &out, LzmaProgress *progress)
+{
+	ISzAlloc *alloc = alloc_ ? alloc_ : &g_Alloc;
+	ISzAlloc *alloc_big = alloc_ ? alloc_ : &g_BigAlloc;
+	CLzmaEncHandle enc = LzmaEnc_Create(alloc);
+	if (!enc)
+		return SZ_ERROR_MEM;
+
+	CLzmaEncProps props = props_;
+	props.writeEndMark = 1;
+	SRes res = LzmaEnc_SetProps(enc, &props);
+	if (res == SZ_OK) {
+		Byte header[LZMA_STREAM_HEADER_SIZE];
+		SizeT props_size = LZMA_PROPS_SIZE;
+		res = LzmaEnc_WriteProperties(enc, header, &props_size);
+		// size is unknown: the decoder stops at the end marker
+		memset(header + LZMA_PROPS_SIZE, 0xFF, LZMA_STREAM_HEADER_SIZE - LZMA_PROPS_SIZE);
+		if (res == SZ_OK && !out.Write(header, sizeof(header)))
+			res = SZ_ERROR_WRITE;
+	}
+	if (res == SZ_OK) {
+		LzmaInAdapter in_adapter = { { &LzmaInAdapter::Read }, &in, chunk_size_ };
+		LzmaOutAdapter out_adapter = { { &LzmaOutAdapter::Write }, &out };
+		LzmaProgressAdapter progress_adapter = { { &LzmaProgressAdapter::Progress }, progress };
+		res = LzmaEnc_Encode(enc, &out_adapter.vt, &in_adapter.vt, progress ? &progress_adapter.vt : NULL, alloc, alloc_big);
+	}
+
+	LzmaEnc_Destroy(enc, alloc, alloc_big);
+	return res;
+}
+
+/**
+ * LzmaStreamDecoder
+ */
+
+LzmaStreamDecoder::LzmaStreamDecoder(size_t chunk_size)
+	: chunk_size_(chunk_size ? chunk_size : LZMA_STREAM_CHUNK_SIZE)
+{
+
+}
+
+SRes LzmaStreamDecoder::Decode(LzmaInStream &in, LzmaOutStream &out, LzmaProgress *progress)
+{
+	Byte header[LZMA_STREAM_HEADER_SIZE];
+	size_t i, header_size;
+	for (header_size = 0; header_size < sizeof(header); header_size += i) {
+		i = sizeof(header) - header_size;
+		if (!in.Read(header + header_size, i))
+			return SZ_ERROR_READ;
+		if (!i)
+			return SZ_ERROR_INPUT_EOF;
+	}
+
+	CLzmaStreamDecoderState state;
+	if (LzmaStreamDecodeProperties(&state.Properties, header, LZMA_PROPERTIES_SIZE) != LZMA_RESULT_OK)
+		return SZ_ERROR_UNSUPPORTED;
+	UInt64 unpack_size = 0;
+	for (i = LZMA_STREAM_HEADER_SIZE; i > LZMA_PROPS_SIZE; i--) {
+		unpack_size = (unpack_size << 8) | header[i - 1];
+	}
+	bool size_known = (unpack_size != static_cast<UInt64>(-1));
+
+	state.Probs = static_cast<CProb *>(MyAlloc(LzmaGetNumProbs(&state.Properties) * sizeof(CProb)));
+	state.Dictionary = static_cast<unsigned char *>(BigAlloc(state.Properties.DictionarySize));
+	Byte *in_buffer = static_cast<Byte *>(MyAlloc(chunk_size_));
+	Byte *out_buffer = static_cast<Byte *>(MyAlloc(chunk_size_));
+	SRes res = SZ_OK;
+	if (!state.Probs || !state.Dictionary || !in_buffer || !out_buffer)
+		res = SZ_ERROR_MEM;
+
+	if (res == SZ_OK) {
+		LzmaDecoderInAdapter in_adapter = { { &LzmaDecoderInAdapter::Read }, &in, in_buffer, chunk_size_, header_size, SZ_OK };
+		UInt64 out_size = 0;
+		LzmaDecoderInit(&state);
+		while (!size_known || out_size < unpack_size) {
+			SizeT size = chunk_size_;
+			if (size_known && unpack_size - out_size < size)
+				size = static_cast<SizeT>(unpack_size - out_size);
+			SizeT processed;
+			if (LzmaStreamDecode(&state, &in_adapter.vt, out_buffer, size, &processed) != LZMA_RESULT_OK) {
+				res = (in_adapter.error != SZ_OK) ? in_adapter.error : SZ_ERROR_DATA;
+				break;
+			}
+			if (!processed) {
+				// end marker; with a known size it came too early
+				if (size_known)
+					res = SZ_ERROR_DATA;
+				break;
+			}
+			out_size += processed;
+			if (!out.Write(out_buffer, processed)) {
+				res = SZ_ERROR_WRITE;
+				break;
+			}
+			if (progress && !progress->Progress(in_adapter.in_size, out_size)) {
+				res = SZ_ERROR_PROGRESS;
+				break;
+			}
+		}
+	}
+
+	MyFree(out_buffer);
+	MyFree(in_buffer);
+	BigFree(state.Dictionary);
+	MyFree(state.Probs);
+	return res;
+}
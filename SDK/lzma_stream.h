@@ -0,0 +1,63 @@
+#ifndef LZMA_STREAM_H
+#define LZMA_STREAM_H
+
+#include "third-party/lzma/LzmaEncode.h"
+
+#define LZMA_STREAM_CHUNK_SIZE 0x10000
+#define LZMA_STREAM_HEADER_SIZE (LZMA_PROPS_SIZE + 8)
+
+/**
+ * Data source for the stream coders: Read() gets the buffer capacity in size and
+ * returns the number of bytes read in it, 0 at the end of data. false means an error.
+ */
+class LzmaInStream {
+public:
+	virtual ~LzmaInStream() {}
+	virtual bool Read(void *buffer, size_t &size) = 0;
+};
+
+class LzmaOutStream {
+public:
+	virtual ~LzmaOutStream() {}
+	virtual bool Write(const void *buffer, size_t size) = 0;
+};
+
+// called after every chunk; returning false cancels the operation with SZ_ERROR_PROGRESS
+class LzmaProgress {
+public:
+	virtual ~LzmaProgress() {}
+	virtual bool Progress(UInt64 in_size, UInt64 out_size) = 0;
+};
+
+/**
+ * Compresses a stream of unknown length into the LZMA-Alone format: a 5-byte properties
+ * header, the size field set to "unknown" and data ending with an end marker.
+ * Input is read in pieces of at most chunk_size bytes; memory use is set by the
+ * dictionary size in props(), not by the length of the data.
+ */
+class LzmaStreamEncoder {
+public:
+	LzmaStreamEncoder(size_t chunk_size = LZMA_STREAM_CHUNK_SIZE);
+	CLzmaEncProps &props() { return props_; }
+	// allocator for the encoder state, e.g. LzmaAllocPool::alloc(); NULL uses the heap
+	void set_alloc(ISzAlloc *alloc) { alloc_ = alloc; }
+	SRes Encode(LzmaInStream &in, LzmaOutStream &out, LzmaProgress *progress = NULL);
+private:
+	CLzmaEncProps props_;
+	size_t chunk_size_;
+	ISzAlloc *alloc_;
+};
+
+/**
+ * Decompresses LZMA-Alone data, with a known size or an end marker, holding only the
+ * dictionary and two chunk_size buffers in memory.
+ */
+class LzmaStreamDecoder {
+public:
+	LzmaStreamDecoder(size_t chunk_size = LZMA_STREAM_CHUNK_SIZE);
+	SRes Decode(LzmaInStream &in, LzmaOutStream &out, LzmaProgress *progress = NULL);
+private:
+	size_t chunk_size_;
+};
+
+#endif
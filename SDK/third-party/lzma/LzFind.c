@@ -499,6 +499,24 @@ static void SkipMatchesSpec(UInt32 lenLimit, UInt32 curMatch, UInt32 pos, const
 
 static void MatchFinder_MovePos(CMatchFinder *p) { MOVE_POS; }
 
+/* son follows hash in one block, so the entries for the first num positions are one range */
+size_t MatchFinder_GetTablesSize(CMatchFinder *p, UInt32 num)
+{
+  return (size_t)p->hashSizeSum + (size_t)num * (p->btMode ? 2 : 1);
+}
+
+void MatchFinder_SaveTables(CMatchFinder *p, CLzRef *tables, UInt32 num)
+{
+  memcpy(tables, p->hash, MatchFinder_GetTablesSize(p, num) * sizeof(CLzRef));
+}
+
+void MatchFinder_RestoreTables(CMatchFinder *p, const CLzRef *tables, UInt32 num)
+{
+  memcpy(p->hash, tables, MatchFinder_GetTablesSize(p, num) * sizeof(CLzRef));
+  for (; num != 0; num--)
+    MatchFinder_MovePos(p);
+}
+
 #define GET_MATCHES_HEADER2(minLen, ret_op) \
   UInt32 lenLimit; UInt32 hv; const Byte *cur; UInt32 curMatch; \
   lenLimit = p->lenLimit; { if (lenLimit < minLen) { MatchFinder_MovePos(p); ret_op; }} \
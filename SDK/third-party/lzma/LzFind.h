@@ -106,6 +106,13 @@ void MatchFinder_CreateVTable(CMatchFinder *p, IMatchFinder *vTable);
 void MatchFinder_Init_2(CMatchFinder *p, int readData);
 void MatchFinder_Init(CMatchFinder *p);
 
+/* Preset dictionary: the hash and son entries of the first num positions after MatchFinder_Init.
+   Restoring them repeats the skip of those bytes without hashing them again.
+   num must be less than cyclicBufferSize. */
+size_t MatchFinder_GetTablesSize(CMatchFinder *p, UInt32 num);
+void MatchFinder_SaveTables(CMatchFinder *p, CLzRef *tables, UInt32 num);
+void MatchFinder_RestoreTables(CMatchFinder *p, const CLzRef *tables, UInt32 num);
+
 UInt32 Bt3Zip_MatchFinder_GetMatches(CMatchFinder *p, UInt32 *distances);
 UInt32 Hc3Zip_MatchFinder_GetMatches(CMatchFinder *p, UInt32 *distances);
 
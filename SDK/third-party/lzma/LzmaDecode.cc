@@ -152,6 +152,21 @@ int LzmaDecodeProperties(CLzmaProperties *propsRes, const unsigned char *propsDa
 
 #define kLzmaStreamWasFinishedId (-1)
 
+#if !defined(_LZMA_OUT_READ) && !defined(_LZMA_IN_CB)
+
+int LzmaDecode(CLzmaDecoderState *vs,
+    const unsigned char *inStream, SizeT inSize, SizeT *inSizeProcessed,
+    unsigned char *outStream, SizeT outSize, SizeT *outSizeProcessed)
+{
+  return LzmaDecodeWithDictionary(vs, 0, inStream, inSize, inSizeProcessed, outStream, outSize, outSizeProcessed);
+}
+
+int LzmaDecodeWithDictionary(CLzmaDecoderState *vs, SizeT presetSize,
+    const unsigned char *inStream, SizeT inSize, SizeT *inSizeProcessed,
+    unsigned char *outStream, SizeT outSize, SizeT *outSizeProcessed)
+
+#else
+
 int LzmaDecode(CLzmaDecoderState *vs,
     #ifdef _LZMA_IN_CB
     ILzmaInCallback *InCallback,
@@ -159,6 +174,8 @@ int LzmaDecode(CLzmaDecoderState *vs,
     const unsigned char *inStream, SizeT inSize, SizeT *inSizeProcessed,
     #endif
     unsigned char *outStream, SizeT outSize, SizeT *outSizeProcessed)
+
+#endif
 {
   CProb *p = vs->Probs;
   SizeT nowPos = 0;
@@ -250,7 +267,9 @@ int LzmaDecode(CLzmaDecoderState *vs,
   UInt32 Range;
   UInt32 Code;
 
-  #ifndef _LZMA_IN_CB
+  #ifdef _LZMA_IN_CB
+  SizeT presetSize = 0;
+  #else
   *inSizeProcessed = 0;
   #endif
   *outSizeProcessed = 0;
@@ -305,7 +324,7 @@ int LzmaDecode(CLzmaDecoderState *vs,
           pos += dictionarySize;
         matchByte = dictionary[pos];
         #else
-        matchByte = outStream[nowPos - rep0];
+        matchByte = *(outStream + nowPos - rep0);
         #endif
         do
         {
@@ -369,7 +388,7 @@ int LzmaDecode(CLzmaDecoderState *vs,
             #ifdef _LZMA_OUT_READ
             if (distanceLimit == 0)
             #else
-            if (nowPos == 0)
+            if (nowPos + presetSize == 0)
             #endif
               return LZMA_RESULT_DATA_ERROR;
 
@@ -383,7 +402,7 @@ int LzmaDecode(CLzmaDecoderState *vs,
             if (++dictionaryPos == dictionarySize)
               dictionaryPos = 0;
             #else
-            previousByte = outStream[nowPos - rep0];
+            previousByte = *(outStream + nowPos - rep0);
             #endif
             outStream[nowPos++] = previousByte;
             #ifdef _LZMA_OUT_READ
@@ -528,7 +547,7 @@ int LzmaDecode(CLzmaDecoderState *vs,
       #ifdef _LZMA_OUT_READ
       if (rep0 > distanceLimit)
       #else
-      if (rep0 > nowPos)
+      if (rep0 > nowPos + presetSize)
       #endif
         return LZMA_RESULT_DATA_ERROR;
 
@@ -550,7 +569,7 @@ int LzmaDecode(CLzmaDecoderState *vs,
         if (++dictionaryPos == dictionarySize)
           dictionaryPos = 0;
         #else
-        previousByte = outStream[nowPos - rep0];
+        previousByte = *(outStream + nowPos - rep0);
         #endif
         len--;
         outStream[nowPos++] = previousByte;
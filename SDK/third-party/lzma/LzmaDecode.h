@@ -110,4 +110,11 @@ int LzmaDecode(CLzmaDecoderState *vs,
     #endif
     unsigned char *outStream, SizeT outSize, SizeT *outSizeProcessed);
 
+#if !defined(_LZMA_OUT_READ) && !defined(_LZMA_IN_CB)
+/* outStream is preceded by presetSize bytes of a preset dictionary that matches may refer to */
+int LzmaDecodeWithDictionary(CLzmaDecoderState *vs, SizeT presetSize,
+    const unsigned char *inStream, SizeT inSize, SizeT *inSizeProcessed,
+    unsigned char *outStream, SizeT outSize, SizeT *outSizeProcessed);
+#endif
+
 #endif
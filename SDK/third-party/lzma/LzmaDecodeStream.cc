@@ -0,0 +1,7 @@
+/*
+  LzmaDecodeStream.cc
+  LzmaDecode.cc built in its streaming configuration, see LzmaDecodeStream.h
+*/
+
+#include "LzmaDecodeStream.h"
+#include "LzmaDecode.cc"
@@ -0,0 +1,33 @@
+/*
+  LzmaDecodeStream.h
+  LzmaDecode.h configured with _LZMA_IN_CB and _LZMA_OUT_READ
+
+  The loader links the one-shot configuration of the decoder, in which the
+  whole output buffer is the dictionary. This header renames the decoder's
+  types and functions so the streaming configuration, built by
+  LzmaDecodeStream.cc, can be linked next to it. Do not include it together
+  with LzmaDecode.h in one translation unit.
+*/
+
+#ifndef __LZMADECODESTREAM_H
+#define __LZMADECODESTREAM_H
+
+#ifdef __LZMADECODE_H
+#error LzmaDecode.h has already been included in its one-shot configuration
+#endif
+
+#define _LZMA_IN_CB
+#define _LZMA_OUT_READ
+
+#define _ILzmaInCallback _ILzmaStreamInCallback
+#define ILzmaInCallback ILzmaStreamInCallback
+#define _CLzmaProperties _CLzmaStreamProperties
+#define CLzmaProperties CLzmaStreamProperties
+#define _CLzmaDecoderState _CLzmaStreamDecoderState
+#define CLzmaDecoderState CLzmaStreamDecoderState
+#define LzmaDecodeProperties LzmaStreamDecodeProperties
+#define LzmaDecode LzmaStreamDecode
+
+#include "LzmaDecode.h"
+
+#endif
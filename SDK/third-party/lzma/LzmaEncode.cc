@@ -408,6 +408,12 @@ typedef struct
 
     CSaveState saveState;
 
+    /* match finder tables after a preset dictionary, see LzmaEnc_MemEncodeWithDict */
+    CLzRef* dictTables;
+    size_t dictTablesSize;
+    UInt32 dictPrimed;
+    SizeT dictLen;
+
 #ifndef _7ZIP_ST
     Byte pad2[128];
 #endif
@@ -504,6 +510,7 @@ SRes LzmaEnc_SetProps(CLzmaEncHandle pp, const CLzmaEncProps* props2)
     p->matchFinderBase.cutValue = props.mc;
 
     p->writeEndMark = props.writeEndMark;
+    p->dictPrimed = 0;
 
 #ifndef _7ZIP_ST
     /*
@@ -1637,6 +1644,8 @@ void LzmaEnc_Construct(CLzmaEnc* p)
 {
     RangeEnc_Construct(&p->rc);
     MatchFinder_Construct(&p->matchFinderBase);
+    p->dictTables = NULL;
+    p->dictTablesSize = 0;
 
 #ifndef _7ZIP_ST
     MatchFinderMt_Construct(&p->matchFinderMt);
@@ -1682,6 +1691,8 @@ void LzmaEnc_Destruct(CLzmaEnc* p, ISzAlloc* alloc, ISzAlloc* allocBig)
 #endif
 
     MatchFinder_Free(&p->matchFinderBase, allocBig);
+    allocBig->Free(allocBig, p->dictTables);
+    p->dictTables = NULL;
     LzmaEnc_FreeLits(p, alloc);
     RangeEnc_Free(&p->rc, alloc);
 }
@@ -2181,6 +2192,84 @@ SRes LzmaEnc_MemEncode(CLzmaEncHandle pp, Byte* dest, SizeT* destLen, const Byte
     return res;
 }
 
+/*
+  Hashing the dictionary costs far more than coding a small message after it. The tables are
+  saved the first time, up to the last numFastBytes positions, whose tree entries depend on
+  the bytes that follow the dictionary; later calls with the same dictLen restore them and
+  only skip that tail.
+*/
+static SRes LzmaEnc_SkipDict(CLzmaEnc* p, SizeT dictLen, ISzAlloc* allocBig)
+{
+    CMatchFinder* mf = &p->matchFinderBase;
+    UInt32 primed = (dictLen > mf->matchMaxLen) ? (UInt32)dictLen - mf->matchMaxLen : 0;
+#ifndef _7ZIP_ST
+    if (p->mtMode)
+        primed = 0;
+#endif
+    if (primed >= mf->cyclicBufferSize)
+        primed = 0;
+
+    if (primed) {
+        if (p->dictPrimed == primed && p->dictLen == dictLen) {
+            MatchFinder_RestoreTables(mf, p->dictTables, primed);
+        } else {
+            size_t size = MatchFinder_GetTablesSize(mf, primed);
+            if (p->dictTablesSize != size) {
+                allocBig->Free(allocBig, p->dictTables);
+                p->dictTablesSize = 0;
+                p->dictTables = (CLzRef*)allocBig->Alloc(allocBig, size * sizeof(CLzRef));
+                if (!p->dictTables)
+                    return SZ_ERROR_MEM;
+                p->dictTablesSize = size;
+            }
+            p->matchFinder.Skip(p->matchFinderObj, primed);
+            MatchFinder_SaveTables(mf, p->dictTables, primed);
+            p->dictPrimed = primed;
+            p->dictLen = dictLen;
+        }
+    }
+    if (dictLen > primed)
+        p->matchFinder.Skip(p->matchFinderObj, (UInt32)(dictLen - primed));
+    return SZ_OK;
+}
+
+SRes LzmaEnc_MemEncodeWithDict(CLzmaEncHandle pp, Byte* dest, SizeT* destLen, const Byte* src, SizeT srcLen,
+    SizeT dictLen, int writeEndMark, ICompressProgress* progress, ISzAlloc* alloc, ISzAlloc* allocBig)
+{
+    SRes res;
+    CLzmaEnc* p = (CLzmaEnc*)pp;
+
+    CSeqOutStreamBuf outStream;
+
+    outStream.funcTable.Write = MyWrite;
+    outStream.data = dest;
+    outStream.rem = *destLen;
+    outStream.overflow = False;
+
+    p->writeEndMark = writeEndMark;
+    p->rc.outStream = &outStream.funcTable;
+
+    res = LzmaEnc_MemPrepare(pp, src - dictLen, dictLen + srcLen, 0, alloc, allocBig);
+
+    if (res == SZ_OK && dictLen != 0) {
+        /* the dictionary only goes into the match finder, the coder starts at src */
+        p->matchFinder.Init(p->matchFinderObj);
+        p->needInit = 0;
+        res = LzmaEnc_SkipDict(p, dictLen, allocBig);
+    }
+
+    if (res == SZ_OK) {
+        res = LzmaEnc_Encode2(p, progress);
+        if (res == SZ_OK && p->nowPos64 != srcLen)
+            res = SZ_ERROR_FAIL;
+    }
+
+    *destLen -= outStream.rem;
+    if (outStream.overflow)
+        return SZ_ERROR_OUTPUT_EOF;
+    return res;
+}
+
 SRes LzmaEncode(Byte* dest, SizeT* destLen, const Byte* src, SizeT srcLen,
     const CLzmaEncProps* props, Byte* propsEncoded, SizeT* propsSize, int writeEndMark,
     ICompressProgress* progress, ISzAlloc* alloc, ISzAlloc* allocBig)
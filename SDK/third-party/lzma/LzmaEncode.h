@@ -58,6 +58,15 @@ SRes LzmaEnc_Encode(CLzmaEncHandle p, ISeqOutStream *outStream, ISeqInStream *in
 SRes LzmaEnc_MemEncode(CLzmaEncHandle p, Byte *dest, SizeT *destLen, const Byte *src, SizeT srcLen,
     int writeEndMark, ICompressProgress *progress, ISzAlloc *alloc, ISzAlloc *allocBig);
 
+/* LzmaEnc_MemEncodeWithDict
+  src is preceded by dictLen bytes of a preset dictionary: matches may refer to it,
+  but only src is encoded. The decoder must see the same bytes before its output.
+  dictLen + srcLen must fit in 32 bits. The match finder state after the dictionary is
+  kept for the next call with the same dictLen, so the dictionary bytes must not change
+  until LzmaEnc_SetProps is called again. */
+SRes LzmaEnc_MemEncodeWithDict(CLzmaEncHandle p, Byte *dest, SizeT *destLen, const Byte *src, SizeT srcLen,
+    SizeT dictLen, int writeEndMark, ICompressProgress *progress, ISzAlloc *alloc, ISzAlloc *allocBig);
+
 /* ---------- One Call Interface ---------- */
 
 /* LzmaEncode
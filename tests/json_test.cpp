@@ -0,0 +1,270 @@
+// Tests for cJSON and CJsonObject
+#include "CJsonObject.hpp"
+#include "JsonBind.hpp"
+#include <clocale>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+struct BindItem
+{
+    int32 iId;
+    std::string strName;
+};
+
+NEB_JSON_BIND_BEGIN(BindItem)
+    NEB_JSON_FIELD_AS(iId, "id")
+    NEB_JSON_FIELD_AS(strName, "name")
+NEB_JSON_BIND_END()
+
+namespace
+{
+
+int g_iFailures = 0;
+
+#define CHECK(expr) \
+    do { \
+        if (!(expr)) { \
+            std::printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #expr); \
+            ++g_iFailures; \
+        } \
+    } while (0)
+
+std::string GetString(const neb::CJsonObject& oJson, const std::string& strKey)
+{
+    std::string strValue;
+    return(oJson.Get(strKey, strValue) ? strValue : std::string("<missing>"));
+}
+
+// members "k0".."k(n-1)" followed by "Name" and "name"; 40 members put the object behind the hash index
+std::string CaseKeysJson(int iPadding)
+{
+    std::string strJson = "{";
+    for (int i = 0; i < iPadding; ++i)
+    {
+        strJson += "\"k" + std::to_string(i) + "\":" + std::to_string(i) + ",";
+    }
+    return(strJson + "\"Name\":\"upper\",\"name\":\"lower\"}");
+}
+
+void TestCaseSensitiveKeys(int iPadding)
+{
+    neb::CJsonObject oJson;
+    oJson.SetCaseSensitive(true);
+    CHECK(oJson.Parse(CaseKeysJson(iPadding)));
+    CHECK(GetString(oJson, "Name") == "upper");
+    CHECK(GetString(oJson, "name") == "lower");
+
+    CHECK(oJson.Replace("name", std::string("replaced")));
+    CHECK(GetString(oJson, "Name") == "upper");
+    CHECK(GetString(oJson, "name") == "replaced");
+
+    CHECK(oJson.ReplaceWithNull("name"));
+    CHECK(GetString(oJson, "Name") == "upper");
+    CHECK(oJson.IsNull("name"));
+
+    CHECK(oJson.Replace("Name", 7));
+    int32 iValue = 0;
+    CHECK(oJson.Get("Name", iValue) && iValue == 7);
+    CHECK(oJson.IsNull("name"));
+
+    CHECK(oJson.Delete("name"));
+    CHECK(oJson.Get("Name", iValue) && iValue == 7);
+    CHECK(!oJson.IsNull("name") && GetString(oJson, "name") == "<missing>");
+
+    CHECK(oJson.Delete("Name"));
+    CHECK(GetString(oJson, "Name") == "<missing>");
+    CHECK(oJson.Get("k0", iValue) || iPadding == 0);
+}
+
+void TestCaseInsensitiveKeys(int iPadding)
+{
+    neb::CJsonObject oJson;
+    CHECK(oJson.Parse(CaseKeysJson(iPadding)));
+    // the first member that matches ignoring case wins, for lookups and mutations alike
+    CHECK(GetString(oJson, "NAME") == "upper");
+    CHECK(oJson.Replace("NAME", std::string("replaced")));
+    CHECK(GetString(oJson, "Name") == "replaced");
+    CHECK(oJson.Delete("nAmE"));
+    CHECK(GetString(oJson, "NAME") == "lower");
+}
+
+void TestCJsonCaseSensitive()
+{
+    cJSON* pJson = cJSON_Parse("{\"Id\":1,\"id\":2}");
+    CHECK(pJson != NULL);
+    cJSON_ReplaceItemInObjectCaseSensitive(pJson, "id", cJSON_CreateInt(3, 1));
+    CHECK(cJSON_GetObjectItemCaseSensitive(pJson, "Id")->valueint == 1);
+    CHECK(cJSON_GetObjectItemCaseSensitive(pJson, "id")->valueint == 3);
+    cJSON* pDetached = cJSON_DetachItemFromObjectCaseSensitive(pJson, "id");
+    CHECK(pDetached != NULL && pDetached->valueint == 3);
+    cJSON_Delete(pDetached);
+    CHECK(cJSON_GetObjectItemCaseSensitive(pJson, "id") == NULL);
+    cJSON_DeleteItemFromObjectCaseSensitive(pJson, "Id");
+    CHECK(pJson->child == NULL);
+    cJSON_Delete(pJson);
+}
+
+// members detached from or replaced in a large object stay reachable through its hash index, or through a scan
+void CheckMutatedMembers(cJSON* pJson)
+{
+    cJSON* pDetached = cJSON_DetachItemFromObject(pJson, "k3");
+    CHECK(pDetached != NULL && pDetached->valueint == 3);
+    cJSON_Delete(pDetached);
+    CHECK(cJSON_GetObjectItem(pJson, "k3") == NULL);
+    cJSON_DeleteItemFromObject(pJson, "K4");
+    CHECK(cJSON_GetObjectItem(pJson, "k4") == NULL);
+
+    cJSON_ReplaceItemInObject(pJson, "K5", cJSON_CreateInt(50, 1));
+    CHECK(cJSON_GetObjectItem(pJson, "k5")->valueint == 50);
+    cJSON_ReplaceItemInObjectCaseSensitive(pJson, "name", cJSON_CreateString("replaced"));
+    CHECK(!strcmp(cJSON_GetObjectItemCaseSensitive(pJson, "Name")->valuestring, "upper"));
+    CHECK(!strcmp(cJSON_GetObjectItemCaseSensitive(pJson, "name")->valuestring, "replaced"));
+    cJSON_ReplaceItemInArray(pJson, 0, cJSON_CreateInt(1, 1));
+    CHECK(cJSON_GetObjectItem(pJson, "k0") == NULL);
+    CHECK(cJSON_GetObjectItem(pJson, "k39")->valueint == 39);
+
+    // the replacements came from the heap, so they are not released with an arena
+    cJSON_Delete(cJSON_DetachItemFromArray(pJson, 0));
+    cJSON_DeleteItemFromObject(pJson, "k5");
+    cJSON_DeleteItemFromObjectCaseSensitive(pJson, "name");
+    CHECK(cJSON_GetArraySize(pJson) == 37);
+}
+
+void TestArenaObjectMutation()
+{
+    cJSON_Arena* pArena = cJSON_CreateArena(0);
+    cJSON* pJson = cJSON_ParseWithArena(CaseKeysJson(40).c_str(), pArena);
+    CHECK(pJson != NULL && pJson->index != NULL);
+    CheckMutatedMembers(pJson);
+    cJSON_ResetArena(pArena);
+
+    cJSON* pHeap = cJSON_Parse(CaseKeysJson(40).c_str());
+    cJSON_PrintBuffer oBuffer = {};
+    CHECK(cJSON_PrintMsgPack(pHeap, &oBuffer));
+    cJSON_Delete(pHeap);
+    pJson = cJSON_ParseMsgPackInSitu(oBuffer.buffer, oBuffer.length, NULL, pArena);
+    CHECK(pJson != NULL && pJson->index != NULL);
+    CheckMutatedMembers(pJson);
+    cJSON_FreePrintBuffer(&oBuffer);
+    cJSON_DeleteArena(pArena);
+}
+
+// objects built member by member are indexed as they grow, and lookups leave the index alone
+void TestAddedObjectIndex()
+{
+    cJSON* pJson = cJSON_CreateObject();
+    for (int i = 0; i < 40; ++i)
+    {
+        cJSON_AddItemToObject(pJson, ("k" + std::to_string(i)).c_str(), cJSON_CreateInt(i, 1));
+    }
+    cJSON_AddItemToObject(pJson, "Name", cJSON_CreateString("upper"));
+    cJSON_AddItemToObject(pJson, "name", cJSON_CreateString("lower"));
+    CHECK(pJson->index != NULL);
+    const cJSON_Index* pIndex = pJson->index;
+    CHECK(cJSON_GetObjectItem(pJson, "k17")->valueint == 17);
+    CHECK(cJSON_GetObjectItem(pJson, "missing") == NULL);
+    CHECK(pJson->index == pIndex);
+    CheckMutatedMembers(pJson);
+    CHECK(pJson->index != NULL);
+    cJSON_Delete(pJson);
+}
+
+cJSON ParseNumber(const char* szNumber)
+{
+    cJSON oItem = {};
+    const char* szEnd = cJSON_ParseNumber(&oItem, szNumber);
+    CHECK(szEnd != NULL && *szEnd == '\0');
+    return(oItem);
+}
+
+void TestNumberLimits()
+{
+    cJSON oItem = ParseNumber("-9223372036854775808");
+    CHECK(oItem.type == cJSON_Int && (int64)oItem.valueint == (-9223372036854775807LL - 1));
+    oItem = ParseNumber("18446744073709551615");
+    CHECK(oItem.type == cJSON_Int && oItem.valueint == 18446744073709551615ULL);
+
+    // beyond the 64-bit range on either side the number is kept as a double instead of wrapping
+    oItem = ParseNumber("-9223372036854775809");
+    CHECK(oItem.type == cJSON_Double && oItem.valuedouble == -9223372036854775809.0);
+    oItem = ParseNumber("-10000000000000000000");
+    CHECK(oItem.type == cJSON_Double && oItem.valuedouble == -1e19);
+    oItem = ParseNumber("18446744073709551616");
+    CHECK(oItem.type == cJSON_Double && oItem.valuedouble == 18446744073709551616.0);
+    oItem = ParseNumber("-123456789012345678901234567890");
+    CHECK(oItem.type == cJSON_Double && oItem.valuedouble == -1.2345678901234568e29);
+}
+
+void TestNumberRoundTrip()
+{
+    const char* aszNumbers[] = { "0", "-0", "1", "-1", "0.1", "-2.5", "1e+300", "5e-324", "1.7976931348623157e+308",
+        "0.30000000000000004", "123456.789", "-1.2345678901234567e-100", "9007199254740993", "3.141592653589793" };
+    for (size_t i = 0; i < sizeof(aszNumbers) / sizeof(aszNumbers[0]); ++i)
+    {
+        cJSON oItem = ParseNumber(aszNumbers[i]);
+        char szOut[32] = {};
+        size_t uiLength = cJSON_FormatDouble(oItem.valuedouble, szOut);
+        cJSON oAgain = ParseNumber(std::string(szOut, uiLength).c_str());
+        CHECK(oAgain.valuedouble == oItem.valuedouble);
+    }
+}
+
+// strtod reads the locale's decimal point; numbers must parse the same under a locale that uses ','
+void TestNumberLocale()
+{
+    const char* aszLocales[] = { "de_DE.UTF-8", "de_DE.utf8", "de_DE", "fr_FR.UTF-8", "German_Germany.1252" };
+    const char* szLocale = NULL;
+    for (size_t i = 0; i < sizeof(aszLocales) / sizeof(aszLocales[0]) && szLocale == NULL; ++i)
+    {
+        szLocale = setlocale(LC_NUMERIC, aszLocales[i]);
+    }
+    if (szLocale == NULL)
+    {
+        std::printf("json_test: no locale with a decimal comma installed, locale test skipped\n");
+        return;
+    }
+    CHECK(ParseNumber("0.1234567890123456789").valuedouble == 0.1234567890123456789);
+    CHECK(ParseNumber("-98765432109876543210.5").valuedouble == -98765432109876543210.5);
+    setlocale(LC_NUMERIC, "C");
+}
+
+// binding matches keys the way CJsonObject does: ignoring case unless asked otherwise
+void TestBindKeyCase()
+{
+    std::string strErrMsg;
+    BindItem oItem = { 0, "" };
+    CHECK(neb::FromJson("{\"ID\":5,\"Name\":\"a\"}", oItem, strErrMsg));
+    CHECK(oItem.iId == 5 && oItem.strName == "a");
+
+    BindItem oExact = { 0, "" };
+    CHECK(neb::FromJson("{\"ID\":5,\"name\":\"b\"}", oExact, strErrMsg, true));
+    CHECK(oExact.iId == 0 && oExact.strName == "b");
+
+    std::string strJson;
+    CHECK(neb::ToJson(oItem, strJson) && strJson == "{\"id\":5,\"name\":\"a\"}");
+}
+
+}
+
+int main()
+{
+    TestCaseSensitiveKeys(0);
+    TestCaseSensitiveKeys(40);
+    TestCaseInsensitiveKeys(0);
+    TestCaseInsensitiveKeys(40);
+    TestCJsonCaseSensitive();
+    TestArenaObjectMutation();
+    TestAddedObjectIndex();
+    TestNumberLimits();
+    TestNumberRoundTrip();
+    TestNumberLocale();
+    TestBindKeyCase();
+    if (g_iFailures)
+    {
+        std::printf("json_test: %d failure(s)\n", g_iFailures);
+        return(1);
+    }
+    std::printf("json_test: ok\n");
+    return(0);
+}
@@ -0,0 +1,20 @@
+// MSVC CRT functions used by the SDK sources, so they also build with g++
+#pragma once
+#ifndef _MSC_VER
+#include <cerrno>
+#include <cstring>
+
+inline int memcpy_s(void* pDest, size_t uiDestSize, const void* pSrc, size_t uiCount)
+{
+    if (uiCount > uiDestSize)
+    {
+        if (pDest != NULL && uiDestSize > 0)
+        {
+            memset(pDest, 0, uiDestSize);
+        }
+        return(ERANGE);
+    }
+    memcpy(pDest, pSrc, uiCount);
+    return(0);
+}
+#endif
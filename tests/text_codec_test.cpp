@@ -0,0 +1,202 @@
+// TextתԣȷԼWindows
+#include "TextCodec.h"
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+    int g_failures = 0;
+
+#define CHECK(expr) \
+    do { \
+        if (!(expr)) { \
+            std::printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #expr); \
+            ++g_failures; \
+        } \
+    } while (0)
+
+    std::string gb2312_to_utf8(const std::string& text) {
+        std::string result(text.size() * 3, '\0');
+        result.resize(Text::text_gb2312_to_utf8(text.data(), text.size(), &result[0], result.size()));
+        return result;
+    }
+
+    std::string utf8_to_gb2312(const std::string& text) {
+        std::string result(text.size(), '\0');
+        result.resize(Text::text_utf8_to_gb2312(text.data(), text.size(), &result[0], result.size()));
+        return result;
+    }
+
+    std::wstring utf8_to_unicode(const std::string& text) {
+        std::wstring result(text.size(), L'\0');
+        result.resize(Text::text_utf8_to_unicode(text.data(), text.size(), &result[0], result.size()));
+        return result;
+    }
+
+    std::string unicode_to_utf8(const std::wstring& text) {
+        std::string result(text.size() * 4, '\0');
+        result.resize(Text::text_unicode_to_utf8(text.data(), text.size(), &result[0], result.size()));
+        return result;
+    }
+
+    std::wstring gb2312_to_unicode(const std::string& text) {
+        std::wstring result(text.size(), L'\0');
+        result.resize(Text::text_gb2312_to_unicode(text.data(), text.size(), &result[0], result.size()));
+        return result;
+    }
+
+    std::string unicode_to_gb2312(const std::wstring& text) {
+        std::string result(text.size() * 2, '\0');
+        result.resize(Text::text_unicode_to_gb2312(text.data(), text.size(), &result[0], result.size()));
+        return result;
+    }
+
+    void append_utf16(std::wstring& text, unsigned code) {
+        if (code >= 0x10000 && sizeof(wchar_t) == 2) {
+            code -= 0x10000;
+            text += static_cast<wchar_t>(0xD800 | (code >> 10));
+            text += static_cast<wchar_t>(0xDC00 | (code & 0x3FF));
+        } else {
+            text += static_cast<wchar_t>(code);
+        }
+    }
+
+    void test_known_answers() {
+        // ""
+        const std::string gbk = "\xD6\xD0\xCE\xC4";
+        const std::string utf8 = "\xE4\xB8\xAD\xE6\x96\x87";
+        CHECK(gb2312_to_utf8(gbk) == utf8);
+        CHECK(utf8_to_gb2312(utf8) == gbk);
+        CHECK(gb2312_to_unicode(gbk) == L"\x4E2D\x6587");
+        CHECK(unicode_to_gb2312(L"\x4E2D\x6587") == gbk);
+        // ȫǿոŷԪżGBKչַ
+        CHECK(gb2312_to_unicode("\xA1\xA1") == L"\x3000");
+        CHECK(gb2312_to_unicode("\x80") == L"\x20AC");
+        CHECK(unicode_to_gb2312(L"\x20AC") == "\x80");
+        CHECK(gb2312_to_unicode("\x81\x40") == L"\x4E02");
+        CHECK(unicode_to_gb2312(L"\x4E02") == "\x81\x40");
+        CHECK(gb2312_to_utf8("abc\xD6\xD0xyz") == "abc\xE4\xB8\xADxyz");
+    }
+
+    // ˫ֽڱٱӦõԭ
+    void test_gbk_round_trip() {
+        size_t mapped = 0;
+        for (unsigned lead = 0x81; lead <= 0xFE; ++lead) {
+            for (unsigned trail = 0x40; trail <= 0xFE; ++trail) {
+                const char in[2] = { static_cast<char>(lead), static_cast<char>(trail) };
+                wchar_t code = 0;
+                if (Text::text_gb2312_to_unicode(in, 2, &code, 1) != 1 || code == 0xFFFD) {
+                    continue;
+                }
+                ++mapped;
+                char out[2] = {};
+                CHECK(Text::text_unicode_to_gb2312(&code, 1, out, 2) == 2 && out[0] == in[0] && out[1] == in[1]);
+                std::string utf8 = gb2312_to_utf8(std::string(in, 2));
+                CHECK(utf8_to_gb2312(utf8) == std::string(in, 2));
+            }
+        }
+        CHECK(mapped == 21791);
+    }
+
+    // ȫUnicodeֵUTF-8
+    void test_utf8_round_trip() {
+        std::wstring text;
+        for (unsigned code = 1; code <= 0x10FFFF; ++code) {
+            if (code < 0xD800 || code > 0xDFFF) {
+                append_utf16(text, code);
+            }
+        }
+        std::string utf8 = unicode_to_utf8(text);
+        CHECK(utf8.size() == 0x7F + 0x780 * 2 + (0x10000 - 0x800 - 0x800) * 3 + 0x100000 * 4);
+        CHECK(utf8_to_unicode(utf8) == text);
+    }
+
+    void test_invalid_input() {
+        CHECK(utf8_to_unicode("\xC0\x80") == L"\xFFFD");            // 
+        CHECK(utf8_to_unicode("a\xE4\xB8") == L"a\xFFFD");          // ض
+        CHECK(utf8_to_unicode("\xED\xA0\x80") == L"\xFFFD");        // 
+        CHECK(utf8_to_unicode("\xF4\x90\x80\x80") == L"\xFFFD");    // U+10FFFF
+        CHECK(utf8_to_unicode("\x80z") == L"\xFFFDz");              // ĺֽ
+        CHECK(gb2312_to_unicode("\xFF") == L"\xFFFD");
+        CHECK(gb2312_to_unicode("\xD6") == L"\xFFFD");              // ȱβֽ
+        CHECK(gb2312_to_unicode("\xAA\xA1") == L"\xFFFD\xFFFD");          // ûԶ
+        CHECK(unicode_to_gb2312(L"\xAC00") == "?");                 // ģGBK޶Ӧ
+        if (sizeof(wchar_t) == 2) {
+            CHECK(unicode_to_utf8(std::wstring(1, static_cast<wchar_t>(0xD800))) == "\xEF\xBF\xBD");
+        }
+    }
+
+    // ASCIIַڸλãSIMDֿ߽
+    void test_ascii_runs() {
+        for (size_t size = 0; size < 100; ++size) {
+            std::string ascii(size, 'a');
+            CHECK(Text::text_ascii_length(ascii.data(), ascii.size()) == size);
+            CHECK(gb2312_to_utf8(ascii) == ascii);
+            for (size_t pos = 0; pos < size; ++pos) {
+                std::string text = ascii;
+                text[pos] = '\x80';
+                CHECK(Text::text_ascii_length(text.data(), text.size()) == pos);
+                std::string expected = ascii.substr(0, pos) + "\xE2\x82\xAC" + ascii.substr(pos + 1);
+                CHECK(gb2312_to_utf8(text) == expected);
+                std::wstring wide(size, L'a');
+                wide[pos] = 0x4E2D;
+                CHECK(Text::text_ascii_length(wide.data(), wide.size()) == pos);
+            }
+        }
+    }
+
+    void test_buffer_size() {
+        const std::string utf8 = "ab\xE4\xB8\xAD";
+        CHECK(Text::text_utf8_to_gb2312(utf8.data(), utf8.size(), nullptr, 0) == 4);
+        CHECK(Text::text_gb2312_to_utf8("\xD6\xD0", 2, nullptr, 0) == 3);
+        char out[4];
+        CHECK(Text::text_utf8_to_gb2312(utf8.data(), utf8.size(), out, 3) == std::string::npos);
+        CHECK(Text::text_utf8_to_gb2312(utf8.data(), utf8.size(), out, 4) == 4);
+        CHECK(Text::text_gb2312_to_utf8("abcdef", 6, out, 4) == std::string::npos);
+    }
+
+    template<typename Function>
+    void measure(const char* name, size_t bytes, Function function) {
+        const int rounds = 20;
+        auto start = std::chrono::steady_clock::now();
+        size_t total = 0;
+        for (int round = 0; round < rounds; ++round) {
+            total += function();
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::printf("%-24s %8.1f MB/s (%zu)\n", name, bytes * rounds / seconds / 1e6, total);
+    }
+
+    void test_throughput() {
+        std::string ascii;
+        while (ascii.size() < (4 << 20)) {
+            ascii += "2026-10-19 10:00:00 [info] request handled in 12 ms, status=200\n";
+        }
+        std::string gbk;
+        while (gbk.size() < (4 << 20)) {
+            gbk += "\xD6\xD0\xCE\xC4 log line \xB2\xE2\xCA\xD4 12345\n";
+        }
+        std::string utf8 = gb2312_to_utf8(gbk);
+        std::string out(utf8.size() * 2, '\0');
+        measure("ascii gb2312->utf8", ascii.size(), [&] { return Text::text_gb2312_to_utf8(ascii.data(), ascii.size(), &out[0], out.size()); });
+        measure("mixed gb2312->utf8", gbk.size(), [&] { return Text::text_gb2312_to_utf8(gbk.data(), gbk.size(), &out[0], out.size()); });
+        measure("mixed utf8->gb2312", utf8.size(), [&] { return Text::text_utf8_to_gb2312(utf8.data(), utf8.size(), &out[0], out.size()); });
+    }
+}
+
+int main() {
+    test_known_answers();
+    test_gbk_round_trip();
+    test_utf8_round_trip();
+    test_invalid_input();
+    test_ascii_runs();
+    test_buffer_size();
+    test_throughput();
+    if (g_failures) {
+        std::printf("text_codec_test: %d failure(s)\n", g_failures);
+        return 1;
+    }
+    std::printf("text_codec_test: ok\n");
+    return 0;
+}